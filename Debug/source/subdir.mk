@@ -6,29 +6,80 @@
 C_SRCS += \
 ../source/DS3231.c \
 ../source/PES_Final_Project.c \
+../source/aging_trim.c \
+../source/bcd.c \
+../source/benchmark.c \
+../source/calendar.c \
+../source/clock_service.c \
+../source/cycle_counter.c \
+../source/ds3231_shadow.c \
 ../source/i2c.c \
+../source/i2c_board.c \
+../source/i2c_hal.c \
+../source/i2c_scheduler.c \
+../source/i2c_trace.c \
 ../source/mtb.c \
 ../source/oled_driver.c \
 ../source/project_tasks.c \
-../source/semihost_hardfault.c 
+../source/rtc_alarm.c \
+../source/rtc_calibration.c \
+../source/rtc_clkin.c \
+../source/rtc_sqw.c \
+../source/semihost_hardfault.c \
+../source/tz.c \
+../source/tz_zones.c 
 
 C_DEPS += \
 ./source/DS3231.d \
 ./source/PES_Final_Project.d \
+./source/aging_trim.d \
+./source/bcd.d \
+./source/benchmark.d \
+./source/calendar.d \
+./source/clock_service.d \
+./source/cycle_counter.d \
+./source/ds3231_shadow.d \
 ./source/i2c.d \
+./source/i2c_board.d \
+./source/i2c_hal.d \
+./source/i2c_scheduler.d \
+./source/i2c_trace.d \
 ./source/mtb.d \
 ./source/oled_driver.d \
 ./source/project_tasks.d \
-./source/semihost_hardfault.d 
+./source/rtc_alarm.d \
+./source/rtc_calibration.d \
+./source/rtc_clkin.d \
+./source/rtc_sqw.d \
+./source/semihost_hardfault.d \
+./source/tz.d \
+./source/tz_zones.d 
 
 OBJS += \
 ./source/DS3231.o \
 ./source/PES_Final_Project.o \
+./source/aging_trim.o \
+./source/bcd.o \
+./source/benchmark.o \
+./source/calendar.o \
+./source/clock_service.o \
+./source/cycle_counter.o \
+./source/ds3231_shadow.o \
 ./source/i2c.o \
+./source/i2c_board.o \
+./source/i2c_hal.o \
+./source/i2c_scheduler.o \
+./source/i2c_trace.o \
 ./source/mtb.o \
 ./source/oled_driver.o \
 ./source/project_tasks.o \
-./source/semihost_hardfault.o 
+./source/rtc_alarm.o \
+./source/rtc_calibration.o \
+./source/rtc_clkin.o \
+./source/rtc_sqw.o \
+./source/semihost_hardfault.o \
+./source/tz.o \
+./source/tz_zones.o 
 
 
 # Each subdirectory must supply rules for building sources it contributes
@@ -43,7 +94,7 @@ source/%.o: ../source/%.c source/subdir.mk
 clean: clean-source
 
 clean-source:
-	-$(RM) ./source/DS3231.d ./source/DS3231.o ./source/PES_Final_Project.d ./source/PES_Final_Project.o ./source/i2c.d ./source/i2c.o ./source/mtb.d ./source/mtb.o ./source/oled_driver.d ./source/oled_driver.o ./source/project_tasks.d ./source/project_tasks.o ./source/semihost_hardfault.d ./source/semihost_hardfault.o
+	-$(RM) ./source/DS3231.d ./source/DS3231.o ./source/PES_Final_Project.d ./source/PES_Final_Project.o ./source/aging_trim.d ./source/aging_trim.o ./source/bcd.d ./source/bcd.o ./source/benchmark.d ./source/benchmark.o ./source/calendar.d ./source/calendar.o ./source/clock_service.d ./source/clock_service.o ./source/cycle_counter.d ./source/cycle_counter.o ./source/ds3231_shadow.d ./source/ds3231_shadow.o ./source/i2c.d ./source/i2c.o ./source/i2c_board.d ./source/i2c_board.o ./source/i2c_hal.d ./source/i2c_hal.o ./source/i2c_scheduler.d ./source/i2c_scheduler.o ./source/i2c_trace.d ./source/i2c_trace.o ./source/mtb.d ./source/mtb.o ./source/oled_driver.d ./source/oled_driver.o ./source/project_tasks.d ./source/project_tasks.o ./source/rtc_alarm.d ./source/rtc_alarm.o ./source/rtc_calibration.d ./source/rtc_calibration.o ./source/rtc_clkin.d ./source/rtc_clkin.o ./source/rtc_sqw.d ./source/rtc_sqw.o ./source/semihost_hardfault.d ./source/semihost_hardfault.o ./source/tz.d ./source/tz.o ./source/tz_zones.d ./source/tz_zones.o
 
 .PHONY: clean-source
 
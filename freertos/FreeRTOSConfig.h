@@ -112,13 +112,21 @@
 
 /* Hook function related definitions. */
 #define configUSE_IDLE_HOOK                     0
-#define configUSE_TICK_HOOK                     0
+#define configUSE_TICK_HOOK                     1
 #define configCHECK_FOR_STACK_OVERFLOW          0
 #define configUSE_MALLOC_FAILED_HOOK            0
 #define configUSE_DAEMON_TASK_STARTUP_HOOK      0
 
 /* Run time and task stats gathering related definitions. */
-#define configGENERATE_RUN_TIME_STATS           0
+#ifndef CPU_PROFILE_ENABLE
+#define CPU_PROFILE_ENABLE                      0
+#endif
+#define configGENERATE_RUN_TIME_STATS           CPU_PROFILE_ENABLE
+#if CPU_PROFILE_ENABLE
+extern uint32_t cycle_counter_now(void);
+#define portCONFIGURE_TIMER_FOR_RUN_TIME_STATS()
+#define portGET_RUN_TIME_COUNTER_VALUE()        cycle_counter_now()
+#endif
 #define configUSE_TRACE_FACILITY                1
 #define configUSE_STATS_FORMATTING_FUNCTIONS    0
 
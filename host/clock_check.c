@@ -0,0 +1,245 @@
+/*******************************************************************************
+ * Copyright (C) 2023 by PRANJAL GUPTA
+ *
+ * Redistribution, modification or use of this software in source or binary
+ * forms is permitted as long as the files maintain this copyright. Users are
+ * permitted to modify this and use it to learn about the field of embedded
+ * software. PRANJAL GUPTA and the University of Colorado are not liable for
+ * any misuse of this material.
+ * ****************************************************************************/
+
+/**
+ * @file    clock_check.c
+ * @brief   This file contains the host checks of the clock service and the cycle counter on a simulated
+ *          SysTick and KL25Z RTC. The Makefile builds it three times, clock_check extrapolates from the core
+ *          cycles, clock_check_clkin is built with CLOCK_SOURCE_RTC_CLKIN=1 and reads the RTC and
+ *          clock_check_wrap starts the tick count 100 s before its 32 bit wrap. All have to give the same
+ *          seconds at every square wave edge and milli second time stamps which agree with the time and
+ *          never go back.
+ *
+ * @author  Pranjal Gupta
+ * @date    12/30/2023
+ *
+ */
+#include "stdio.h"
+#include "clock_service.h"
+#include "clock_host.h"
+#include "calendar.h"
+#include "cycle_counter.h"
+#include "rtc_clkin.h"
+
+static void snapshot_at(uint32_t seconds, ds3231_snapshot_t *snapshot);
+static int check_now_ms(void);
+static int check_counter(void);
+static int check_edges(uint32_t first_second, uint32_t count, uint32_t read_delay_us);
+static int check_edge_sync(void);
+static int check_read_sync(void);
+
+#define US_PER_S 1000000UL
+#define MS_PER_S 1000U
+#define US_PER_MS 1000U
+#define EDGE_CHECK_S 185                    // three resyncs, across a midnight
+#define READ_DELAY_US 2000                  // from the square wave edge to the snapshot read
+#define READ_PHASE_US 400000                // snapshot read off the edge, into its second
+#define RTC_RESOLUTION_US 31                // one period of the 32768 Hz prescaler
+#define MS_CHECK_S 120                      // across the tick wrap of clock_check_wrap
+#define MS_STEP_US 250
+#define MS_RESYNC_AT_S 60
+#define MS_LATE_EDGE_US 3000                // the resync edge is stamped late, the clock steps back
+#define COUNTER_CHECK_S 200
+#define COUNTER_STEP_US 10000
+#define CYCLES_PER_US 48                    // configCPU_CLOCK_HZ of the host build
+
+/*
+ * Description: fills a snapshot with the time and date of a second
+ * Parameters:
+ * 		uint32_t seconds since 2000-01-01
+ * 		ds3231_snapshot_t * the snapshot
+ * Returns:
+ *   		None
+ */
+
+static void snapshot_at(uint32_t seconds, ds3231_snapshot_t *snapshot) {
+	clock_service_to_datetime(seconds, &snapshot->time, &snapshot->date);
+}
+
+/*
+ * Description: syncs the clock from a read and reads the milli second time stamp every 250 us for two
+ *              minutes, it has to be the time of clock_service_now in milli seconds, also at the second
+ *              boundaries, and never go back. Halfway the clock is synced on an edge 3 ms behind the phase
+ *              of the read, which steps the extrapolated time back without a drift sample.
+ * Parameters:
+ * 		None
+ * Returns:
+ *   		int 0 if every time stamp agreed with the time and none went back
+ */
+
+static int check_now_ms(void) {
+
+	ds3231_date_t date = { .year = 2023, .month = 6, .date = 30 };
+	ds3231_time_t time = { .hour = 23, .min = 59, .sec = 30 };
+	ds3231_snapshot_t snapshot;
+	clock_timestamp_t now = { 0, 0 };
+	uint32_t first = clock_service_from_datetime(&time, &date);
+	uint64_t now_ms, last_ms = 0, expected_ms, edge_cycles;
+
+	clock_host_reset();
+	clock_service_invalidate();
+	snapshot_at(first, &snapshot);
+	clock_service_sync(&snapshot, cycle_counter_now64(), false);
+
+	for (uint32_t i = 0; i < MS_CHECK_S * (US_PER_S / MS_STEP_US); i++) {
+		if (i == MS_RESYNC_AT_S * (US_PER_S / MS_STEP_US)) {
+			clock_host_run_us(MS_LATE_EDGE_US);
+			edge_cycles = cycle_counter_now64();
+			snapshot_at(first + MS_RESYNC_AT_S, &snapshot);
+			clock_service_sync(&snapshot, edge_cycles, true);
+		}
+
+		now_ms = clock_service_now_ms();
+		clock_service_now(&now);
+		expected_ms = (uint64_t) now.seconds * MS_PER_S + now.microseconds / US_PER_MS;
+		if (now_ms < last_ms || now_ms + 1 < expected_ms || now_ms > expected_ms + 1) {
+			printf("milli second check failed: %llu ms after %llu ms at %lu.%06lu\n",
+					(unsigned long long) now_ms, (unsigned long long) last_ms, (unsigned long) now.seconds,
+					(unsigned long) now.microseconds);
+			return 1;
+		}
+		last_ms = now_ms;
+		clock_host_run_us(MS_STEP_US);
+	}
+	return 0;
+}
+
+/*
+ * Description: runs the cycle counter in 10 ms steps and checks the 64 bit count advances by the cycles of
+ *              every step, across the 32 bit wrap of the tick count in clock_check_wrap
+ * Parameters:
+ * 		None
+ * Returns:
+ *   		int 0 if the count never jumped
+ */
+
+static int check_counter(void) {
+
+	uint64_t before, after;
+
+	for (uint32_t i = 0; i < COUNTER_CHECK_S * (US_PER_S / COUNTER_STEP_US); i++) {
+		before = cycle_counter_now64();
+		clock_host_run_us(COUNTER_STEP_US);
+		after = cycle_counter_now64();
+		if (after - before != COUNTER_STEP_US * CYCLES_PER_US
+				|| (uint32_t) (cycle_counter_now() - (uint32_t) before) != COUNTER_STEP_US * CYCLES_PER_US) {
+			printf("cycle counter check failed: %llu to %llu in %u us\n", (unsigned long long) before,
+					(unsigned long long) after, COUNTER_STEP_US);
+			return 1;
+		}
+	}
+	return 0;
+}
+
+/*
+ * Description: runs the display loop of the board over a number of square wave edges, the snapshot is read
+ *              a little after the edge when a sync is due. At every edge the second of the edge has to be
+ *              the RTC second. Once the clock was synced on an edge the time after the read has to be that
+ *              of the RTC too, before that the phase of a read off the edge is kept.
+ * Parameters:
+ * 		uint32_t the RTC second starting at the next edge
+ * 		uint32_t number of edges
+ * 		uint32_t micro seconds from an edge to the snapshot read
+ * Returns:
+ *   		int 0 if every edge gave the RTC time
+ */
+
+static int check_edges(uint32_t first_second, uint32_t count, uint32_t read_delay_us) {
+
+	ds3231_snapshot_t snapshot;
+	clock_timestamp_t now = { 0, 0 };
+	uint64_t edge_cycles;
+	uint32_t expected, seconds = 0;
+	bool phase_known = false;
+
+	for (uint32_t i = 0; i < count; i++) {
+		expected = first_second + i;
+		edge_cycles = cycle_counter_now64();
+		clock_host_run_us(read_delay_us);
+		if (clock_service_sync_due()) {
+			snapshot_at(expected, &snapshot);
+			clock_service_sync(&snapshot, edge_cycles, true);
+			phase_known = true;
+		}
+
+		if (!clock_service_second_at_edge(edge_cycles, &seconds) || seconds != expected
+				|| !clock_service_now(&now) || (phase_known && (now.seconds != expected
+				|| now.microseconds + RTC_RESOLUTION_US < read_delay_us
+				|| now.microseconds > read_delay_us + RTC_RESOLUTION_US))) {
+			printf("clock check failed: edge of %lu gave %lu, now %lu.%06lu\n", (unsigned long) expected,
+					(unsigned long) seconds, (unsigned long) now.seconds, (unsigned long) now.microseconds);
+			return 1;
+		}
+		clock_host_run_us(US_PER_S - read_delay_us);
+	}
+	return 0;
+}
+
+/*
+ * Description: syncs the clock at a square wave edge before midnight and follows it over three resyncs
+ * Parameters:
+ * 		None
+ * Returns:
+ *   		int 0 if the clock was not set before the sync and kept the RTC time after it
+ */
+
+static int check_edge_sync(void) {
+
+	ds3231_date_t date = { .year = 2023, .month = 12, .date = 31 };
+	ds3231_time_t time = { .hour = 23, .min = 58, .sec = 30 };
+	uint32_t seconds;
+
+	clock_host_reset();
+	clock_service_invalidate();
+	clock_host_run_us(1250000);             // the scheduler runs for a while before the first edge
+	if (clock_service_second_at_edge(cycle_counter_now64(), &seconds)) {
+		printf("clock check failed: second given before the first sync\n");
+		return 1;
+	}
+	return check_edges(clock_service_from_datetime(&time, &date), EDGE_CHECK_S, READ_DELAY_US);
+}
+
+/*
+ * Description: sets the clock from a snapshot read off the edge after the RTC time was changed, the next
+ *              edges have to give the following seconds
+ * Parameters:
+ * 		None
+ * Returns:
+ *   		int 0 if the edges after the read gave the RTC time
+ */
+
+static int check_read_sync(void) {
+
+	ds3231_date_t date = { .year = 2024, .month = 2, .date = 29 };
+	ds3231_time_t time = { .hour = 12, .min = 0, .sec = 0 };
+	ds3231_snapshot_t snapshot;
+	uint32_t seconds = clock_service_from_datetime(&time, &date);
+
+	clock_service_invalidate();             // the RTC was set
+	clock_host_run_us(READ_PHASE_US);
+	snapshot_at(seconds, &snapshot);
+	clock_service_sync(&snapshot, cycle_counter_now64(), false);
+	clock_host_run_us(US_PER_S - READ_PHASE_US);
+	return check_edges(seconds + 1, EDGE_CHECK_S, READ_DELAY_US);
+}
+
+int main(void) {
+
+	int failures = 0;
+
+	failures += check_now_ms();
+	failures += check_counter();
+	failures += check_edge_sync();
+	failures += check_read_sync();
+
+	printf("clock checks (%s, first tick %llu) %s\n", CLOCK_SOURCE_RTC_CLKIN ? "rtc clkin" : "cycle counter",
+			(unsigned long long) CYCLE_COUNTER_FIRST_TICK, failures ? "FAILED" : "passed");
+	return failures ? 1 : 0;
+}
@@ -0,0 +1,128 @@
+/*******************************************************************************
+ * Copyright (C) 2023 by PRANJAL GUPTA
+ *
+ * Redistribution, modification or use of this software in source or binary
+ * forms is permitted as long as the files maintain this copyright. Users are
+ * permitted to modify this and use it to learn about the field of embedded
+ * software. PRANJAL GUPTA and the University of Colorado are not liable for
+ * any misuse of this material.
+ * ****************************************************************************/
+
+/**
+ * @file    clock_host.c
+ * @brief   This file contains the host versions of the SysTick timer under the cycle counter and of the KL25Z
+ *          RTC clocked from the 32K output of the DS3231. Both count simulated time, SysTick at
+ *          configCPU_CLOCK_HZ with the tick hook called at every reload, and the RTC prescaler at 32768 Hz,
+ *          so both are read back with the resolution of the board.
+ *
+ * @author  Pranjal Gupta
+ * @date    12/30/2023
+ *
+ */
+#include "clock_host.h"
+#include "cycle_counter.h"
+#include "rtc_clkin.h"
+#include "FreeRTOS.h"
+#include "MKL25Z4.h"
+
+#define CYCLES_PER_US (configCPU_CLOCK_HZ / 1000000U)
+#define CYCLES_PER_TICK (configCPU_CLOCK_HZ / configTICK_RATE_HZ)
+#define US_PER_S 1000000UL
+#define PRESCALER_HZ 32768
+#define PRESCALER_BITS 15
+#define US_PER_PRESCALER_Q9 15625        // 10^6 / 32768 = 15625 / 512
+#define PRESCALER_Q 9
+
+void vApplicationTickHook(void);
+
+SysTick_Type host_systick = { .LOAD = CYCLES_PER_TICK - 1, .VAL = CYCLES_PER_TICK - 1 };
+SCB_Type host_scb = { .ICSR = 0 };       // the tick interrupt runs at once, it is never pending
+
+static uint64_t host_cycles = 0;         // simulated time, the cycle counter itself starts anywhere
+static bool rtc_loaded = false;
+static uint32_t rtc_seconds;             // TSR at the load
+static uint32_t rtc_prescaler;           // TPR at the load
+static uint64_t rtc_loaded_at;           // core cycles at the load
+
+/*
+ * Description: stops the RTC, the cycle counter keeps running
+ * Parameters:
+ * 		None
+ * Returns:
+ *   		None
+ */
+
+void clock_host_reset(void) {
+	rtc_loaded = false;
+}
+
+/*
+ * Description: lets simulated time pass
+ * Parameters:
+ * 		uint64_t micro seconds
+ * Returns:
+ *   		None
+ */
+
+void clock_host_run_us(uint64_t us) {
+
+	uint64_t cycles = us * CYCLES_PER_US + (host_systick.LOAD - host_systick.VAL);
+
+	host_cycles += us * CYCLES_PER_US;
+	while (cycles >= CYCLES_PER_TICK) {
+		vApplicationTickHook();
+		cycles -= CYCLES_PER_TICK;
+	}
+	host_systick.VAL = host_systick.LOAD - (uint32_t) cycles;
+}
+
+/*
+ * Description: host version of the RTC set up, the RTC is stopped until it is loaded
+ * Parameters:
+ * 		None
+ * Returns:
+ *   		None
+ */
+
+void rtc_clkin_init(void) {
+	rtc_loaded = false;
+}
+
+/*
+ * Description: host version of the RTC load, the prescaler keeps the fraction of the second like TPR
+ * Parameters:
+ * 		uint32_t seconds since 2000-01-01
+ * 		uint32_t micro seconds into that second
+ * Returns:
+ *   		None
+ */
+
+void rtc_clkin_load(uint32_t seconds, uint32_t microseconds) {
+
+	rtc_seconds = seconds + microseconds / US_PER_S;
+	rtc_prescaler = ((microseconds % US_PER_S) << PRESCALER_Q) / US_PER_PRESCALER_Q9;
+	rtc_loaded_at = host_cycles;
+	rtc_loaded = true;
+}
+
+/*
+ * Description: host version of the RTC read, the prescaler counts 32768 Hz from the load
+ * Parameters:
+ * 		uint32_t * seconds since 2000-01-01
+ * 		uint32_t * micro seconds into that second
+ * Returns:
+ *   		bool false when the RTC was not loaded
+ */
+
+bool rtc_clkin_read(uint32_t *seconds, uint32_t *microseconds) {
+
+	uint64_t ticks;
+
+	if (!rtc_loaded)
+		return false;
+
+	ticks = rtc_prescaler + (host_cycles - rtc_loaded_at) * PRESCALER_HZ / configCPU_CLOCK_HZ;
+	*seconds = rtc_seconds + (uint32_t) (ticks >> PRESCALER_BITS);
+	*microseconds = (uint32_t) (((ticks & (PRESCALER_HZ - 1)) * US_PER_PRESCALER_Q9) >> PRESCALER_Q);
+	return true;
+}
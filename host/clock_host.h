@@ -0,0 +1,29 @@
+/*******************************************************************************
+ * Copyright (C) 2023 by PRANJAL GUPTA
+ *
+ * Redistribution, modification or use of this software in source or binary
+ * forms is permitted as long as the files maintain this copyright. Users are
+ * permitted to modify this and use it to learn about the field of embedded
+ * software. PRANJAL GUPTA and the University of Colorado are not liable for
+ * any misuse of this material.
+ * ****************************************************************************/
+
+/**
+ * @file    clock_host.h
+ * @brief   This file has the function prototypes of the simulated core cycle counter and KL25Z RTC used by
+ *          the host build of the clock service.
+ *
+ * @author  Pranjal Gupta
+ * @date    12/30/2023
+ *
+ */
+
+#ifndef CLOCK_HOST_H_
+#define CLOCK_HOST_H_
+
+#include "stdint.h"
+
+void clock_host_reset(void);
+void clock_host_run_us(uint64_t us);
+
+#endif /* CLOCK_HOST_H_ */
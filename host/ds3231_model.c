@@ -0,0 +1,378 @@
+/*******************************************************************************
+ * Copyright (C) 2023 by PRANJAL GUPTA
+ *
+ * Redistribution, modification or use of this software in source or binary
+ * forms is permitted as long as the files maintain this copyright. Users are
+ * permitted to modify this and use it to learn about the field of embedded
+ * software. PRANJAL GUPTA and the University of Colorado are not liable for
+ * any misuse of this material.
+ * ****************************************************************************/
+
+/**
+ * @file    ds3231_model.c
+ * @brief   This file contains a host model of the DS3231 as seen from the i2c bus: 19 registers behind an
+ *          address pointer which is set by the first byte of a write and incremented after every byte,
+ *          wrapping from 0x12 to 0x00. The time registers are advanced in BCD by ds3231_model_tick_second,
+ *          24 hour mode only. ds3231_model_run_us runs the oscillator for a span of true time with a
+ *          frequency error, the crystal error less the aging offset which was loaded at the last conversion.
+ *
+ * @author  Pranjal Gupta
+ * @date    12/18/2023
+ *
+ */
+#include "ds3231_model.h"
+#include "string.h"
+
+static uint8_t bcd_increment(uint8_t bcd);
+static uint8_t days_in_month(uint8_t month, uint8_t year);
+static bool alarm1_matches(void);
+static void advance_time(void);
+static void convert_temperature(void);
+
+#define REG_SECONDS 0x00
+#define REG_MINUTES 0x01
+#define REG_HOURS 0x02
+#define REG_DAY 0x03
+#define REG_DATE 0x04
+#define REG_MONTH 0x05
+#define REG_YEAR 0x06
+#define REG_ALARM1 0x07
+#define REG_CONTROL 0x0E
+#define REG_STATUS 0x0F
+#define REG_AGING 0x10
+#define REG_TEMP_MSB 0x11
+#define CONTROL_POR_VALUE 0x1C          // INTCN set, alarms off, 1 Hz rate selected
+#define STATUS_POR_VALUE 0x88           // OSF and EN32kHz set at power up
+#define TEMP_POR_VALUE 0x19             // 25 C
+#define STATUS_WRITABLE_MASK 0x08       // EN32kHz
+#define STATUS_CLEAR_ONLY_MASK 0x83     // OSF, A2F and A1F
+#define STATUS_BSY 0x04
+#define STATUS_A1F 0x01
+#define CONTROL_INTCN 0x04
+#define CONTROL_A1IE 0x01
+#define CONTROL_CONV 0x20
+#define CONVERSION_PERIOD_S 64
+#define TEMP_FRACTION_SHIFT 6
+#define ALARM_MASK_BIT 0x80
+#define ALARM_DY_DT_BIT 0x40
+#define CENTURY_BIT 0x80
+#define MONTH_MASK 0x1F
+#define AGING_PPB_PER_STEP 100
+#define NS_PER_US 1000
+#define NS_PER_S 1000000000LL
+#define US_PER_PPB_NS 1000000          // us * ppb / 10^6 gives ns
+
+static uint8_t registers[DS3231_MODEL_REGISTERS];
+static uint8_t pointer = 0;
+static int16_t die_temperature = (int16_t) TEMP_POR_VALUE * 4;   // in 0.25 degree C
+static uint32_t seconds_to_conversion = CONVERSION_PERIOD_S;
+static int32_t crystal_error_ppb = 0;
+static int8_t loaded_aging = 0;                 // aging offset used by the oscillator
+static int64_t oscillator_ns = 0;               // time since the last second of the oscillator
+
+/*
+ * Description: puts the model in its power up state, 00:00:00 on Monday 01/01/00 with OSF set
+ * Parameters:
+ * 		None
+ * Returns:
+ *   		None
+ */
+
+void ds3231_model_reset(void) {
+
+	memset(registers, 0, sizeof(registers));
+	registers[REG_DAY] = 0x01;
+	registers[REG_DATE] = 0x01;
+	registers[REG_MONTH] = 0x01;
+	registers[REG_CONTROL] = CONTROL_POR_VALUE;
+	registers[REG_STATUS] = STATUS_POR_VALUE;
+	registers[REG_TEMP_MSB] = TEMP_POR_VALUE;
+	pointer = 0;
+	die_temperature = (int16_t) TEMP_POR_VALUE * 4;
+	seconds_to_conversion = CONVERSION_PERIOD_S;
+	crystal_error_ppb = 0;
+	loaded_aging = 0;
+	oscillator_ns = 0;
+}
+
+/*
+ * Description: sets the temperature the model measures at its next conversion
+ * Parameters:
+ * 		int16_t temperature in 0.25 degree C
+ * Returns:
+ *   		None
+ */
+
+void ds3231_model_set_temperature(int16_t quarter_celsius) {
+	die_temperature = quarter_celsius;
+}
+
+/*
+ * Description: stores the die temperature in the temperature registers and ends a conversion started
+ *              with CONV, the aging offset register is loaded into the oscillator like on the chip
+ * Parameters:
+ * 		None
+ * Returns:
+ *   		None
+ */
+
+static void convert_temperature(void) {
+
+	registers[REG_TEMP_MSB] = (uint8_t) (die_temperature >> 2);
+	registers[REG_TEMP_MSB + 1] = (uint8_t) ((die_temperature & 0x03) << TEMP_FRACTION_SHIFT);
+	registers[REG_CONTROL] &= ~CONTROL_CONV;
+	registers[REG_STATUS] &= ~STATUS_BSY;
+	loaded_aging = (int8_t) registers[REG_AGING];
+}
+
+/*
+ * Description: a write transaction, the first byte sets the address pointer and the others are stored.
+ *              The OSF and alarm flags of the status register are only cleared by writing 0, BSY and the
+ *              temperature registers are read only. Setting CONV starts a conversion, it sets BSY until the
+ *              next second.
+ * Parameters:
+ * 		const uint8_t * the bytes after the address byte
+ * 		int number of bytes
+ * Returns:
+ *   		None
+ */
+
+void ds3231_model_write(const uint8_t *data, int length) {
+
+	if (length == 0)
+		return;
+
+	pointer = data[0] % DS3231_MODEL_REGISTERS;
+	for (int i = 1; i < length; i++) {
+		if (pointer == REG_STATUS)
+			registers[pointer] = (data[i] & STATUS_WRITABLE_MASK)
+					| (registers[pointer] & data[i] & STATUS_CLEAR_ONLY_MASK)
+					| (registers[pointer] & STATUS_BSY);
+		else if (pointer != REG_TEMP_MSB && pointer != REG_TEMP_MSB + 1)
+			registers[pointer] = data[i];
+		if (pointer == REG_CONTROL && (data[i] & CONTROL_CONV))
+			registers[REG_STATUS] |= STATUS_BSY;
+		pointer = (pointer + 1) % DS3231_MODEL_REGISTERS;
+	}
+}
+
+/*
+ * Description: a read transaction, the bytes are read from the address pointer onwards
+ * Parameters:
+ * 		uint8_t * filled with the bytes read
+ * 		int number of bytes
+ * Returns:
+ *   		None
+ */
+
+void ds3231_model_read(uint8_t *data, int length) {
+
+	for (int i = 0; i < length; i++) {
+		data[i] = registers[pointer];
+		pointer = (pointer + 1) % DS3231_MODEL_REGISTERS;
+	}
+}
+
+/*
+ * Description: increments a BCD number
+ * Parameters:
+ * 		uint8_t a BCD number below 99
+ * Returns:
+ *   		uint8_t the number plus one in BCD
+ */
+
+static uint8_t bcd_increment(uint8_t bcd) {
+
+	bcd++;
+	if ((bcd & 0x0F) == 0x0A)
+		bcd += 0x06;
+	return bcd;
+}
+
+/*
+ * Description: number of days of a month, the years 00 to 99 divisible by 4 are leap years
+ * Parameters:
+ * 		uint8_t month in BCD
+ * 		uint8_t year in BCD
+ * Returns:
+ *   		uint8_t the last date of the month in BCD
+ */
+
+static uint8_t days_in_month(uint8_t month, uint8_t year) {
+
+	uint8_t binary_year = (uint8_t) ((year >> 4) * 10 + (year & 0x0F));
+
+	switch (month) {
+	case 0x02:
+		return (binary_year % 4 == 0) ? 0x29 : 0x28;
+	case 0x04:
+	case 0x06:
+	case 0x09:
+	case 0x11:
+		return 0x30;
+	default:
+		return 0x31;
+	}
+}
+
+/*
+ * Description: advances the time keeping registers by one second like the oscillator of the chip, sets
+ *              A1F when the new time matches alarm 1 and runs the temperature conversion every 64 s or when
+ *              one was started with CONV
+ * Parameters:
+ * 		None
+ * Returns:
+ *   		None
+ */
+
+void ds3231_model_tick_second(void) {
+
+	advance_time();
+	if (alarm1_matches())
+		registers[REG_STATUS] |= STATUS_A1F;
+
+	if (--seconds_to_conversion == 0 || (registers[REG_CONTROL] & CONTROL_CONV)) {
+		convert_temperature();
+		seconds_to_conversion = CONVERSION_PERIOD_S;
+	}
+}
+
+/*
+ * Description: sets the frequency error of the crystal, with an aging offset of 0
+ * Parameters:
+ * 		int32_t the error in ppb, positive when the oscillator runs fast
+ * Returns:
+ *   		None
+ */
+
+void ds3231_model_set_drift(int32_t error_ppb) {
+	crystal_error_ppb = error_ppb;
+}
+
+/*
+ * Description: runs the oscillator for a span of true time and ticks the seconds it completes, the aging
+ *              offset slows it down by AGING_PPB_PER_STEP per step
+ * Parameters:
+ * 		uint64_t true time in us
+ * Returns:
+ *   		None
+ */
+
+void ds3231_model_run_us(uint64_t us) {
+
+	int64_t error_ppb = crystal_error_ppb - (int64_t) loaded_aging * AGING_PPB_PER_STEP;
+
+	oscillator_ns += (int64_t) us * NS_PER_US + (int64_t) us * error_ppb / US_PER_PPB_NS;
+	while (oscillator_ns >= NS_PER_S) {
+		oscillator_ns -= NS_PER_S;
+		ds3231_model_tick_second();
+	}
+}
+
+/*
+ * Description: returns how far the oscillator is into the current second, what the target measures from
+ *              the last square wave edge
+ * Parameters:
+ * 		None
+ * Returns:
+ *   		uint32_t us since the last second
+ */
+
+uint32_t ds3231_model_phase_us(void) {
+	return (uint32_t) (oscillator_ns / NS_PER_US);
+}
+
+/*
+ * Description: compares the time keeping registers with alarm 1, a field with its mask bit set is left out
+ *              and DY/DT selects the day of the week or the date of the month
+ * Parameters:
+ * 		None
+ * Returns:
+ *   		bool true when every compared field is equal
+ */
+
+static bool alarm1_matches(void) {
+
+	const uint8_t *alarm = &registers[REG_ALARM1];
+	uint8_t day;
+
+	for (int i = 0; i < 3; i++) {
+		if (!(alarm[i] & ALARM_MASK_BIT) && (alarm[i] & ~ALARM_MASK_BIT) != registers[REG_SECONDS + i])
+			return false;
+	}
+	if (alarm[3] & ALARM_MASK_BIT)
+		return true;
+
+	day = (alarm[3] & ALARM_DY_DT_BIT) ? registers[REG_DAY] : registers[REG_DATE];
+	return (alarm[3] & ~(ALARM_MASK_BIT | ALARM_DY_DT_BIT)) == day;
+}
+
+/*
+ * Description: the level of the INT/SQW pin in interrupt mode, the pin is low while an enabled alarm flag
+ *              is set
+ * Parameters:
+ * 		None
+ * Returns:
+ *   		bool true when the pin is pulled low
+ */
+
+bool ds3231_model_int_asserted(void) {
+
+	return (registers[REG_CONTROL] & CONTROL_INTCN) && (registers[REG_CONTROL] & CONTROL_A1IE)
+			&& (registers[REG_STATUS] & STATUS_A1F);
+}
+
+/*
+ * Description: advances the time keeping registers by one second
+ * Parameters:
+ * 		None
+ * Returns:
+ *   		None
+ */
+
+static void advance_time(void) {
+
+	uint8_t month = registers[REG_MONTH] & MONTH_MASK;
+
+	if ((registers[REG_SECONDS] = bcd_increment(registers[REG_SECONDS])) < 0x60)
+		return;
+	registers[REG_SECONDS] = 0;
+	if ((registers[REG_MINUTES] = bcd_increment(registers[REG_MINUTES])) < 0x60)
+		return;
+	registers[REG_MINUTES] = 0;
+	if ((registers[REG_HOURS] = bcd_increment(registers[REG_HOURS])) < 0x24)
+		return;
+	registers[REG_HOURS] = 0;
+
+	registers[REG_DAY] = (registers[REG_DAY] % 7) + 1;
+	if (registers[REG_DATE] < days_in_month(month, registers[REG_YEAR])) {
+		registers[REG_DATE] = bcd_increment(registers[REG_DATE]);
+		return;
+	}
+	registers[REG_DATE] = 0x01;
+
+	if (month < 0x12) {
+		registers[REG_MONTH] = (registers[REG_MONTH] & CENTURY_BIT) | bcd_increment(month);
+		return;
+	}
+	registers[REG_MONTH] = (registers[REG_MONTH] & CENTURY_BIT) | 0x01;
+
+	if (registers[REG_YEAR] < 0x99) {
+		registers[REG_YEAR] = bcd_increment(registers[REG_YEAR]);
+		return;
+	}
+	registers[REG_YEAR] = 0;
+	registers[REG_MONTH] ^= CENTURY_BIT;            // century toggles when the year wraps
+}
+
+/*
+ * Description: gives direct access to the register file, used to check or preset the model
+ * Parameters:
+ * 		None
+ * Returns:
+ *   		uint8_t * the DS3231_MODEL_REGISTERS registers
+ */
+
+uint8_t *ds3231_model_registers(void) {
+	return registers;
+}
@@ -0,0 +1,39 @@
+/*******************************************************************************
+ * Copyright (C) 2023 by PRANJAL GUPTA
+ *
+ * Redistribution, modification or use of this software in source or binary
+ * forms is permitted as long as the files maintain this copyright. Users are
+ * permitted to modify this and use it to learn about the field of embedded
+ * software. PRANJAL GUPTA and the University of Colorado are not liable for
+ * any misuse of this material.
+ * ****************************************************************************/
+
+/**
+ * @file    ds3231_model.h
+ * @brief   This file has the function prototypes of the host model of the DS3231 register file.
+ *
+ * @author  Pranjal Gupta
+ * @date    12/18/2023
+ *
+ */
+
+#ifndef DS3231_MODEL_H_
+#define DS3231_MODEL_H_
+
+#include "stdint.h"
+#include "stdbool.h"
+
+#define DS3231_MODEL_REGISTERS 0x13        // 0x00 seconds to 0x12 temperature LSB
+
+void ds3231_model_reset(void);
+void ds3231_model_write(const uint8_t *data, int length);
+void ds3231_model_read(uint8_t *data, int length);
+void ds3231_model_tick_second(void);
+uint8_t *ds3231_model_registers(void);
+bool ds3231_model_int_asserted(void);
+void ds3231_model_set_temperature(int16_t quarter_celsius);
+void ds3231_model_set_drift(int32_t error_ppb);
+void ds3231_model_run_us(uint64_t us);
+uint32_t ds3231_model_phase_us(void);
+
+#endif /* DS3231_MODEL_H_ */
@@ -0,0 +1,1073 @@
+/*******************************************************************************
+ * Copyright (C) 2023 by PRANJAL GUPTA
+ *
+ * Redistribution, modification or use of this software in source or binary
+ * forms is permitted as long as the files maintain this copyright. Users are
+ * permitted to modify this and use it to learn about the field of embedded
+ * software. PRANJAL GUPTA and the University of Colorado are not liable for
+ * any misuse of this material.
+ * ****************************************************************************/
+
+/**
+ * @file    host_bench.c
+ * @brief   This file runs the DS3231 and SSD1306 drivers of the target on the host bus models. It checks
+ *          the display and clock paths against the models and prints, per path, the transactions and
+ *          bytes on the bus, the bus time at 100 and 400 kHz and the host cpu time of the driver code.
+ *          Run with -r to print the display contents at the end.
+ *
+ * @author  Pranjal Gupta
+ * @date    12/18/2023
+ *
+ */
+#include "stdio.h"
+#include "string.h"
+#include "time.h"
+#include "i2c_hal.h"
+#include "i2c_hal_host.h"
+#include "ds3231_model.h"
+#include "ssd1306_model.h"
+#include "DS3231.h"
+#include "ds3231_shadow.h"
+#include "oled_driver.h"
+#include "calendar.h"
+#include "aging_trim.h"
+#include "bcd.h"
+#include "tz.h"
+#include "stdlib.h"
+
+static double now_ns(void);
+static void report(const char *path, uint8_t device_addr, uint32_t iterations, double cpu_ns);
+static void display_frame(ds3231_time_t *time);
+static int check_display(void);
+static int check_clock(void);
+static int check_snapshot(void);
+static int check_square_wave(void);
+static int check_shadow(void);
+static int check_failed_commit(void);
+static int check_set_datetime(void);
+static int check_alarm(void);
+static int check_temperature(void);
+static uint32_t model_seconds(void);
+static int check_aging_trim(void);
+static int check_aging_offset(void);
+static int check_bcd_codec(void);
+static uint8_t reference_bcd(uint32_t value);
+static int check_datetime_rollover(void);
+static bool datetime_seconds(const ds3231_time_t *time, const ds3231_date_t *date, int64_t *seconds);
+static int64_t snapshot_ms(const ds3231_snapshot_t *snapshot);
+static int check_calendar(void);
+static int check_time_zones(void);
+static int check_local_time(uint32_t utc_seconds);
+static void lock_shadow(void);
+static void unlock_shadow(void);
+static int check_shadow_lock(void);
+
+#define BENCH_ITERATIONS 10000
+#define TIME_COLUMN 30
+#define TIME_PAGE 0
+#define GLYPH_WIDTH 6
+#define WINDOW_BYTES 7                      // control byte, column and page address commands
+#define STANDARD_SCL_HZ 100000
+#define FAST_SCL_HZ 400000
+#define TRIM_DRIFT_PPB 7300                 // crystal error injected in the aging trim check
+#define TRIM_SAMPLE_PERIOD_S 60
+#define TRIM_RUN_S (16 * 3600)
+#define TRIM_STEP_AT_S (90 * 60)            // the time is set one hour ahead here
+#define TRIM_JITTER_MS 7                    // reference stamps are off by up to +-3 ms
+#define US_PER_S 1000000ULL
+#define ROLLOVER_APIS 3                     // time then date, datetime burst, snapshot
+#define ROLLOVER_MAX_DELAY 3                // transactions let through before the second rolls over
+#define CALENDAR_FIRST_YEAR 1583            // first full Gregorian year, checks the slow path before 1600
+#define CALENDAR_LAST_YEAR 2499             // and after 2400
+#define TZ_CHECK_STEP_S 3600                // the zones are compared with libc every hour
+#define TZ_CHECK_END_S 3155760000UL         // 2100-01-01, the tables run to the end of 2100
+
+static uint32_t elapsed_seconds = 0;        // seconds the model was ticked in check_temperature
+static bool shadow_locked = false;
+static uint32_t nested_locks = 0;           // a second take by the holder, a dead lock with the board mutex
+
+/*
+ * Description: monotonic time stamp
+ * Parameters:
+ * 		None
+ * Returns:
+ *   		double nano seconds
+ */
+
+static double now_ns(void) {
+
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+/*
+ * Description: prints the bus and cpu cost of one iteration of a driver path
+ * Parameters:
+ * 		const char * name of the path
+ * 		uint8_t the slave the path talks to
+ * 		uint32_t number of iterations which were run since the counters were reset
+ * 		double host cpu time of all the iterations in ns
+ * Returns:
+ *   		None
+ */
+
+static void report(const char *path, uint8_t device_addr, uint32_t iterations, double cpu_ns) {
+
+	i2c_host_device_stats_t stats;
+
+	i2c_host_get_stats(device_addr, &stats);
+	printf("%-22s %7.1f %8.1f %10.1f %10.1f %9.0f\n", path,
+			(double) stats.transactions / iterations, (double) stats.payload_bytes / iterations,
+			i2c_host_bus_time_us(&stats, STANDARD_SCL_HZ) / iterations,
+			i2c_host_bus_time_us(&stats, FAST_SCL_HZ) / iterations, cpu_ns / iterations);
+}
+
+/*
+ * Description: the per second refresh of the display task, the time is drawn over the last one and flushed
+ * Parameters:
+ * 		ds3231_time_t * the time to be shown
+ * Returns:
+ *   		None
+ */
+
+static void display_frame(ds3231_time_t *time) {
+
+	char buffer[12];
+
+	snprintf(buffer, sizeof(buffer), "%02d:%02d:%02d", time->hour, time->min, time->sec);
+	oled_printstring(buffer, TIME_COLUMN, TIME_PAGE);
+	oled_flush();
+}
+
+/*
+ * Description: checks a string written by the driver lands in the GDDRAM where it was asked, a ':' is
+ *              drawn at the third glyph position of the time, that drawing the same time again sends nothing
+ *              and that a new second sends only the columns of the digit which changed
+ * Parameters:
+ * 		None
+ * Returns:
+ *   		int 0 if the display model holds what the driver wrote
+ */
+
+static int check_display(void) {
+
+	ds3231_time_t time = { .sec = 56, .min = 34, .hour = 12 };
+	static const uint8_t colon[5] = { 0x00, 0x36, 0x36, 0x00, 0x00 };
+	uint8_t column = TIME_COLUMN + 2 * GLYPH_WIDTH;
+	i2c_host_device_stats_t before, after;
+
+	display_frame(&time);
+	for (int i = 0; i < 5; i++) {
+		if (ssd1306_model_gddram(TIME_PAGE, column + i) != colon[i]) {
+			printf("display check failed at column %d\n", column + i);
+			return 1;
+		}
+	}
+	if (ssd1306_model_gddram(TIME_PAGE, TIME_COLUMN - 1) != 0) {
+		printf("display check failed, write before the start column\n");
+		return 1;
+	}
+
+	i2c_host_get_stats(OLED_ADDRESS, &before);
+	display_frame(&time);                          // the same text again, nothing is dirty
+	i2c_host_get_stats(OLED_ADDRESS, &after);
+	if (after.transactions != before.transactions) {
+		printf("display check failed, unchanged frame sent %u transactions\n",
+				(unsigned) (after.transactions - before.transactions));
+		return 1;
+	}
+
+	time.sec = 57;                                 // one digit, one window and one glyph of data
+	display_frame(&time);
+	i2c_host_get_stats(OLED_ADDRESS, &before);
+	if (before.transactions - after.transactions != 2
+			|| before.payload_bytes - after.payload_bytes > 2 + WINDOW_BYTES + GLYPH_WIDTH) {
+		printf("display check failed, one digit sent %u bytes\n",
+				(unsigned) (before.payload_bytes - after.payload_bytes));
+		return 1;
+	}
+	return 0;
+}
+
+/*
+ * Description: sets the clock, lets the model run across a day and a leap February and reads it back
+ * Parameters:
+ * 		None
+ * Returns:
+ *   		int 0 if the time and date read back are the expected ones
+ */
+
+static int check_clock(void) {
+
+	ds3231_time_t time = { .sec = 59, .min = 59, .hour = 23 };
+	ds3231_date_t date = { .dow = 3, .date = 28, .month = 2, .year = 2024 };
+
+	ds3231_set_time(&time);
+	ds3231_set_date(&date);
+	ds3231_model_tick_second();
+	ds3231_read_time(&time);
+	ds3231_read_date(&date);
+
+	if (time.hour != 0 || time.min != 0 || time.sec != 0 || date.date != 29 || date.month != 2
+			|| date.year != 2024 || date.dow != 4) {
+		printf("clock check failed: %02d:%02d:%02d %02d/%02d/%d dow %d\n", time.hour, time.min,
+				time.sec, date.date, date.month, date.year, date.dow);
+		return 1;
+	}
+	return 0;
+}
+
+/*
+ * Description: reads a snapshot right after a power on reset of the model and checks every field of it
+ * Parameters:
+ * 		None
+ * Returns:
+ *   		int 0 if the snapshot holds the power on values of the registers
+ */
+
+static int check_snapshot(void) {
+
+	ds3231_snapshot_t snapshot;
+
+	ds3231_model_reset();
+	if (ds3231_read_snapshot(&snapshot) != I2C_STATUS_OK || snapshot.time.sec != 0
+			|| snapshot.date.date != 1 || snapshot.date.month != 1 || snapshot.date.year != 2000
+			|| snapshot.control != 0x1C || !(snapshot.status & DS3231_STATUS_OSF)
+			|| snapshot.temperature_quarter_c != 25 * 4) {
+		printf("snapshot check failed: control %02x status %02x temperature %d/4\n",
+				snapshot.control, snapshot.status, snapshot.temperature_quarter_c);
+		return 1;
+	}
+	return 0;
+}
+
+/*
+ * Description: selects the 1 Hz square wave from the power on state and checks only INTCN and RS2:RS1 of
+ *              the control register changed
+ * Parameters:
+ * 		None
+ * Returns:
+ *   		int 0 if the control register holds the 1 Hz square wave setting
+ */
+
+static int check_square_wave(void) {
+
+	uint8_t *registers = ds3231_model_registers();
+
+	ds3231_model_reset();
+	ds3231_shadow_invalidate();            // the model was changed behind the driver
+	registers[0x0E] |= 0x80;               // EOSC, must be kept as it is
+	if (ds3231_set_square_wave(DS3231_SQW_1HZ) != I2C_STATUS_OK || registers[0x0E] != 0x80) {
+		printf("square wave check failed: control %02x\n", registers[0x0E]);
+		return 1;
+	}
+	return 0;
+}
+
+/*
+ * Description: stages the two alarm 1 registers at the ends of the alarm range and checks they are sent in
+ *              one burst over the valid registers between them, then checks the control register is
+ *              served from the shadow
+ * Parameters:
+ * 		None
+ * Returns:
+ *   		int 0 if the writes were coalesced and the read needed no transaction
+ */
+
+static int check_shadow(void) {
+
+	ds3231_snapshot_t snapshot;
+	i2c_host_device_stats_t stats;
+	uint8_t *registers = ds3231_model_registers();
+	uint8_t alarm_seconds = 0x30, alarm_day = 0x81, control;
+
+	ds3231_model_reset();
+	ds3231_read_snapshot(&snapshot);        // makes the whole copy valid
+	i2c_host_reset();
+	ds3231_shadow_lock();
+	ds3231_shadow_write(0x07, &alarm_seconds, 1);
+	ds3231_shadow_write(0x0A, &alarm_day, 1);
+	ds3231_shadow_commit();
+	ds3231_shadow_read(0x0E, &control, 1);
+	ds3231_shadow_unlock();
+	i2c_host_get_stats(DS3231_ADDRESS, &stats);
+
+	if (stats.transactions != 1 || registers[0x07] != 0x30 || registers[0x0A] != 0x81
+			|| control != registers[0x0E]) {
+		printf("shadow check failed: %u transactions\n", (unsigned) stats.transactions);
+		return 1;
+	}
+	return 0;
+}
+
+/*
+ * Description: stages a time and the aging offset, fails the first of the two writes of the commit on the
+ *              bus and checks the time is then read from the device and keeps running, and that a later
+ *              commit of another register does not write the staged time
+ * Parameters:
+ * 		None
+ * Returns:
+ *   		int 0 if the failed run was dropped from the copy
+ */
+
+static int check_failed_commit(void) {
+
+	uint8_t *registers = ds3231_model_registers();
+	uint8_t staged_time[3] = { 0x30, 0x45, 0x07 }, aging = 0x12;   // 07:45:30
+	ds3231_time_t time;
+	i2c_status_t status;
+
+	i2c_host_reset();
+	ds3231_shadow_invalidate();
+	registers[0x00] = 0x05;                          // 12:00:05 on the device
+	registers[0x01] = 0x00;
+	registers[0x02] = 0x12;
+	ds3231_shadow_lock();
+	ds3231_shadow_write(0x00, staged_time, sizeof(staged_time));
+	ds3231_shadow_write(0x10, &aging, 1);
+	i2c_host_fail_rtc_after(0, I2C_STATUS_NACK);     // the time run fails, the aging run goes through
+	status = ds3231_shadow_commit();
+	ds3231_shadow_unlock();
+
+	ds3231_model_tick_second();
+	ds3231_read_time(&time);
+	ds3231_clear_alarm1_flag();
+
+	if (status != I2C_STATUS_NACK || registers[0x10] != aging || time.hour != 12 || time.min != 0
+			|| time.sec != 6 || registers[0x00] != 0x06 || registers[0x02] != 0x12) {
+		printf("failed commit check failed: status %d, read %02u:%02u:%02u, device %02x:%02x:%02x\n", status,
+				time.hour, time.min, time.sec, registers[0x02], registers[0x01], registers[0x00]);
+		return 1;
+	}
+	return 0;
+}
+
+/*
+ * Description: sets the last second of 2099 in one burst on a model with OSF and A1F set, checks OSF was
+ *              cleared without touching A1F and EN32kHz and that the next second is in the next century.
+ *              Then fails the status read and checks nothing is written.
+ * Parameters:
+ * 		None
+ * Returns:
+ *   		int 0 if the date and time and the status register are the expected ones
+ */
+
+static int check_set_datetime(void) {
+
+	ds3231_time_t time = { .sec = 59, .min = 59, .hour = 23 };
+	ds3231_date_t date = { .dow = 5, .date = 31, .month = 12, .year = 2099 };
+	uint8_t *registers = ds3231_model_registers();
+	i2c_status_t status;
+
+	ds3231_model_reset();
+	ds3231_shadow_invalidate();
+	registers[0x0F] |= 0x01;               // A1F
+	if (ds3231_set_datetime(&time, &date) != I2C_STATUS_OK || registers[0x0F] != 0x09) {
+		printf("set datetime check failed: status %02x\n", registers[0x0F]);
+		return 1;
+	}
+
+	ds3231_model_tick_second();
+	ds3231_read_date(&date);
+	if (date.date != 1 || date.month != 1 || date.year != 2100) {
+		printf("set datetime check failed: %02d/%02d/%d\n", date.date, date.month, date.year);
+		return 1;
+	}
+
+	ds3231_shadow_invalidate();
+	registers[0x0F] = 0x80;                // OSF with the 32 kHz output off
+	i2c_host_fail_rtc_after(0, I2C_STATUS_NACK);   // the status read fails
+	status = ds3231_set_datetime(&time, &date);
+	ds3231_set_32khz_output(false);         // a later commit must not carry the time
+	if (status != I2C_STATUS_NACK || registers[0x0F] != 0x80 || registers[0x00] != 0x00) {
+		printf("set datetime check failed: %d after a failed status read, status %02x, seconds %02x\n",
+				status, registers[0x0F], registers[0x00]);
+		return 1;
+	}
+	return 0;
+}
+
+/*
+ * Description: programs alarm 1 three seconds ahead over a midnight and checks the INT pin is asserted on
+ *              that second only and released when the flag is cleared. Then clears A1F on a status register
+ *              which is not in the copy and checks only A1F changed, after a failed read changed nothing.
+ * Parameters:
+ * 		None
+ * Returns:
+ *   		int 0 if the alarm fired on the programmed second
+ */
+
+static int check_alarm(void) {
+
+	ds3231_time_t time = { .sec = 58, .min = 59, .hour = 23 }, alarm = { .sec = 1, .min = 0, .hour = 0 };
+	ds3231_date_t date = { .dow = 0, .date = 31, .month = 1, .year = 2027 };
+	uint8_t *registers = ds3231_model_registers();
+	i2c_status_t failed_status, status;
+	int fired_at = -1;
+
+	ds3231_model_reset();
+	ds3231_shadow_invalidate();
+	ds3231_set_datetime(&time, &date);
+	ds3231_set_alarm1(&alarm, 1);
+	ds3231_clear_alarm1_flag();
+	ds3231_enable_alarm1_interrupt(true);
+
+	for (int i = 1; i <= 5 && fired_at < 0; i++) {
+		ds3231_model_tick_second();
+		if (ds3231_model_int_asserted())
+			fired_at = i;
+	}
+	ds3231_clear_alarm1_flag();
+
+	if (fired_at != 3 || ds3231_model_int_asserted()) {
+		printf("alarm check failed: fired after %d s\n", fired_at);
+		return 1;
+	}
+
+	ds3231_shadow_invalidate();
+	registers[0x0F] = 0x81;                 // OSF and A1F with the 32 kHz output off
+	i2c_host_fail_rtc_after(0, I2C_STATUS_NACK);
+	failed_status = ds3231_clear_alarm1_flag();
+	status = ds3231_clear_alarm1_flag();
+	if (failed_status != I2C_STATUS_NACK || status != I2C_STATUS_OK || registers[0x0F] != 0x80) {
+		printf("alarm check failed: clear gave %d then %d, status %02x\n", failed_status, status,
+				registers[0x0F]);
+		return 1;
+	}
+	return 0;
+}
+
+/*
+ * Description: clock of the temperature cache, the seconds the model was ticked
+ * Parameters:
+ * 		None
+ * Returns:
+ *   		uint32_t seconds
+ */
+
+static uint32_t model_seconds(void) {
+	return elapsed_seconds;
+}
+
+/*
+ * Description: reads the temperature once per second for three minutes while the die warms up and checks
+ *              only one read per 64 s reaches the bus, then forces a conversion and checks the new value
+ *              comes without waiting for the conversion and a second one is not started while BSY is set
+ * Parameters:
+ * 		None
+ * Returns:
+ *   		int 0 if the cache and the forced conversion behave as expected
+ */
+
+static int check_temperature(void) {
+
+	i2c_host_device_stats_t stats;
+	int16_t centi_celsius;
+	bool started, restarted;
+	i2c_status_t status;
+
+	ds3231_model_reset();
+	ds3231_shadow_invalidate();
+	ds3231_set_clock(model_seconds);
+	i2c_host_reset();
+
+	for (elapsed_seconds = 0; elapsed_seconds < 180; elapsed_seconds++) {
+		ds3231_model_set_temperature(100 + elapsed_seconds / 10);      // 25.00 C and rising
+		ds3231_read_temperature(&centi_celsius);
+		ds3231_model_tick_second();
+	}
+	i2c_host_get_stats(DS3231_ADDRESS, &stats);
+	if (stats.transactions != 3) {
+		printf("temperature check failed: %u reads in 180 s\n", (unsigned) stats.transactions);
+		return 1;
+	}
+
+	ds3231_model_set_temperature(-21);                          // -5.25 C
+	ds3231_force_conversion(&started);
+	status = ds3231_force_conversion(&restarted);              // BSY is set, nothing to start
+	ds3231_read_temperature(&centi_celsius);                    // conversion still running
+	ds3231_model_tick_second();
+	ds3231_read_temperature(&centi_celsius);
+	ds3231_set_clock(NULL);
+	if (centi_celsius != -525 || !started || restarted || status != I2C_STATUS_OK) {
+		printf("temperature check failed: %d after a forced conversion, started %d %d, status %d\n",
+				centi_celsius, started, restarted, status);
+		return 1;
+	}
+	return 0;
+}
+
+/*
+ * Description: RTC time of a snapshot in ms since 2000-01-01 with the sub-second part of the model oscillator
+ * Parameters:
+ * 		const ds3231_snapshot_t * the snapshot
+ * Returns:
+ *   		int64_t ms
+ */
+
+static int64_t snapshot_ms(const ds3231_snapshot_t *snapshot) {
+
+	int64_t seconds = (int64_t) calendar_days_from_civil(snapshot->date.year, snapshot->date.month,
+			snapshot->date.date) * CALENDAR_SECONDS_PER_DAY + snapshot->time.hour * 3600
+			+ snapshot->time.min * 60 + snapshot->time.sec;
+
+	return seconds * 1000 + ds3231_model_phase_us() / 1000;
+}
+
+/*
+ * Description: writes the aging offset while the device is converting and checks it is still reported as
+ *              written, then makes the start of the conversion fail on the bus and checks the error is
+ *              returned
+ * Parameters:
+ * 		None
+ * Returns:
+ *   		int 0 if only the busy device was reported as I2C_STATUS_OK
+ */
+
+static int check_aging_offset(void) {
+
+	uint8_t *registers = ds3231_model_registers();
+	i2c_status_t busy_status, bus_status;
+
+	i2c_host_reset();
+	ds3231_shadow_invalidate();
+	registers[0x0F] |= 0x04;                        // BSY, the device runs its own conversion
+	busy_status = ds3231_set_aging_offset(5);
+	ds3231_model_tick_second();                     // the conversion ends
+	i2c_host_fail_rtc_after(1, I2C_STATUS_BUS_BUSY);   // the aging write goes through, the control read fails
+	bus_status = ds3231_set_aging_offset(6);
+
+	if (busy_status != I2C_STATUS_OK || bus_status != I2C_STATUS_BUS_BUSY || registers[0x10] != 6) {
+		printf("aging offset check failed: status %d while converting, %d on a bus error\n", busy_status,
+				bus_status);
+		return 1;
+	}
+	return 0;
+}
+
+/*
+ * Description: runs the calibration loop of the target against a model with a crystal 7.3 ppm fast, a
+ *              reference with a few ms of jitter sampled once a minute for 16 hours and the time set one
+ *              hour ahead during the first window. The fit has to start again at the time step, trim the
+ *              aging offset to 73 and then keep it there.
+ * Parameters:
+ * 		None
+ * Returns:
+ *   		int 0 if the offset converged
+ */
+
+static int check_aging_trim(void) {
+
+	ds3231_time_t time = { .sec = 0, .min = 0, .hour = 12 };
+	ds3231_date_t date = { .dow = 0, .date = 24, .month = 12, .year = 2023 };
+	ds3231_snapshot_t snapshot;
+	aging_trim_fit_t fit;
+	uint64_t true_us = 0;
+	uint32_t noise = 1, trims = 0, restarts = 0;
+	int64_t reference_ms;
+	int32_t error_ppb = TRIM_DRIFT_PPB;
+	int8_t offset = 0;
+
+	ds3231_model_reset();
+	ds3231_shadow_invalidate();
+	ds3231_set_datetime(&time, &date);
+	ds3231_model_set_drift(TRIM_DRIFT_PPB);
+	aging_trim_reset(&fit);
+
+	while (true_us < TRIM_RUN_S * US_PER_S) {
+		ds3231_model_run_us(TRIM_SAMPLE_PERIOD_S * US_PER_S);
+		true_us += TRIM_SAMPLE_PERIOD_S * US_PER_S;
+
+		if (true_us == TRIM_STEP_AT_S * US_PER_S) {
+			ds3231_read_snapshot(&snapshot);
+			snapshot.time.hour++;
+			ds3231_set_datetime(&snapshot.time, &snapshot.date);
+		}
+
+		noise = noise * 1103515245 + 12345;
+		reference_ms = (int64_t) (true_us / 1000) + (int32_t) ((noise >> 16) % TRIM_JITTER_MS) - TRIM_JITTER_MS / 2;
+		ds3231_read_snapshot(&snapshot);
+		aging_trim_add_sample(&fit, reference_ms, snapshot_ms(&snapshot));
+
+		if (aging_trim_estimate(&fit, &error_ppb)) {
+			aging_trim_apply(error_ppb, &offset);
+			restarts += fit.restarts;
+			aging_trim_reset(&fit);
+			trims++;
+		}
+	}
+
+	restarts += fit.restarts;
+	if (restarts != 1 || trims != 3 || offset != TRIM_DRIFT_PPB / DS3231_AGING_PPB_PER_LSB
+			|| error_ppb >= AGING_TRIM_DEADBAND_PPB || error_ppb <= -AGING_TRIM_DEADBAND_PPB) {
+		printf("aging trim check failed: %u restarts, %u trims, offset %d, last error %d ppb\n",
+				(unsigned) restarts, (unsigned) trims, offset, (int) error_ppb);
+		return 1;
+	}
+	return 0;
+}
+
+/*
+ * Description: packed BCD of a value with divisions, the reference of the codec checks
+ * Parameters:
+ * 		uint32_t the value 0 to 99
+ * Returns:
+ *   		uint8_t the BCD byte
+ */
+
+static uint8_t reference_bcd(uint32_t value) {
+	return (uint8_t) ((value / 10) << 4 | (value % 10));
+}
+
+/*
+ * Description: checks the BCD codec on every valid BCD byte and every value 0 to 99, in every position of
+ *              a seven register pass, then takes every value of every time and date field, years 2000 to
+ *              2199, through the driver and the model registers and back
+ * Parameters:
+ * 		None
+ * Returns:
+ *   		int 0 if every conversion matched the reference
+ */
+
+static int check_bcd_codec(void) {
+
+	static const uint8_t no_masks[7] = { 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF };
+	uint8_t binary[7], bcd[7], decoded[7], encoded[7];
+	uint8_t *registers = ds3231_model_registers();
+	ds3231_time_t time;
+	ds3231_date_t date;
+	ds3231_snapshot_t snapshot;
+	uint8_t expected[7];
+
+	for (uint32_t value = 0; value < 100; value++) {
+		if (bcd_to_binary(reference_bcd(value)) != value || bcd_from_binary(value) != reference_bcd(value)) {
+			printf("bcd check failed: %u\n", (unsigned) value);
+			return 1;
+		}
+
+		for (int i = 0; i < 7; i++) {
+			binary[i] = (value + i * 13) % 100;
+			bcd[i] = reference_bcd(binary[i]);
+		}
+		bcd_decode(bcd, no_masks, decoded, 7);
+		bcd_encode(binary, encoded, 7);
+		if (memcmp(decoded, binary, 7) != 0 || memcmp(encoded, bcd, 7) != 0) {
+			printf("bcd check failed: pass of %u\n", (unsigned) value);
+			return 1;
+		}
+	}
+
+	ds3231_model_reset();
+	ds3231_shadow_invalidate();
+	for (uint32_t k = 0; k < 200; k++) {
+		time = (ds3231_time_t) { .sec = k % 60, .min = (k + 7) % 60, .hour = k % 24 };
+		date = (ds3231_date_t) { .dow = k % 7, .date = k % 31 + 1, .month = k % 12 + 1, .year = 2000 + k };
+		expected[0] = reference_bcd(time.sec);
+		expected[1] = reference_bcd(time.min);
+		expected[2] = reference_bcd(time.hour);
+		expected[3] = reference_bcd(calendar_day_of_week(calendar_days_from_civil(date.year, date.month,
+				date.date)));      // the dow given is not used
+		expected[4] = reference_bcd(date.date);
+		expected[5] = reference_bcd(date.month) | (date.year >= 2100 ? 0x80 : 0);
+		expected[6] = reference_bcd(date.year % 100);
+
+		ds3231_set_datetime(&time, &date);
+		ds3231_read_snapshot(&snapshot);
+		if (memcmp(registers, expected, 7) != 0 || snapshot.time.sec != time.sec || snapshot.time.min != time.min
+				|| snapshot.time.hour != time.hour || snapshot.date.dow != (expected[3] & 0x07)
+				|| snapshot.date.date != date.date || snapshot.date.month != date.month
+				|| snapshot.date.year != date.year) {
+			printf("bcd check failed: %02d:%02d:%02d %02d/%02d/%d\n", time.hour, time.min, time.sec, date.date,
+					date.month, date.year);
+			return 1;
+		}
+	}
+	return 0;
+}
+
+/*
+ * Description: seconds since 2000-01-01 of a time and date read from the RTC, checking that it is a real date
+ * Parameters:
+ * 		const ds3231_time_t * the time
+ * 		const ds3231_date_t * the date
+ * 		int64_t * the seconds
+ * Returns:
+ *   		bool false when a field is out of range or the date does not exist
+ */
+
+static bool datetime_seconds(const ds3231_time_t *time, const ds3231_date_t *date, int64_t *seconds) {
+
+	int32_t days;
+	uint16_t year;
+	uint8_t month, day;
+
+	if (time->sec > 59 || time->min > 59 || time->hour > 23 || date->month < 1 || date->month > 12
+			|| date->date < 1)
+		return false;
+
+	days = calendar_days_from_civil(date->year, date->month, date->date);
+	calendar_civil_from_days(days, &year, &month, &day);
+	if (year != date->year || month != date->month || day != date->date)
+		return false;
+
+	*seconds = (int64_t) days * CALENDAR_SECONDS_PER_DAY + time->hour * 3600 + time->min * 60 + time->sec;
+	return true;
+}
+
+/*
+ * Description: reads the RTC across the last second of a minute, day, month, leap day, year and century with
+ *              the second rolling over before each transaction of the read in turn. A read has to give the
+ *              second before or the second after the roll over, anything else is a torn pair. The time then
+ *              date reads are expected to tear, the burst reads never.
+ * Parameters:
+ * 		None
+ * Returns:
+ *   		int 0 if no burst read was torn
+ */
+
+static int check_datetime_rollover(void) {
+
+	static const ds3231_time_t last_second[] = {
+		{ .sec = 59, .min = 59, .hour = 12 }, { .sec = 59, .min = 59, .hour = 23 }
+	};
+	static const ds3231_date_t last_day[] = {
+		{ .date = 15, .month = 3, .year = 2023 }, { .date = 31, .month = 1, .year = 2023 },
+		{ .date = 28, .month = 2, .year = 2023 }, { .date = 28, .month = 2, .year = 2024 },
+		{ .date = 29, .month = 2, .year = 2024 }, { .date = 30, .month = 4, .year = 2023 },
+		{ .date = 30, .month = 11, .year = 2031 }, { .date = 31, .month = 12, .year = 2023 },
+		{ .date = 31, .month = 12, .year = 2099 }, { .date = 31, .month = 12, .year = 2150 }
+	};
+	ds3231_time_t time;
+	ds3231_date_t date, boundary;
+	ds3231_snapshot_t snapshot;
+	int64_t before, after;
+	uint32_t torn[ROLLOVER_APIS] = { 0 }, reads = 0;
+
+	for (size_t t = 0; t < sizeof(last_second) / sizeof(last_second[0]); t++) {
+		for (size_t d = 0; d < sizeof(last_day) / sizeof(last_day[0]); d++) {
+			boundary = last_day[d];
+			boundary.dow = calendar_day_of_week(calendar_days_from_civil(boundary.year, boundary.month,
+					boundary.date));
+			datetime_seconds(&last_second[t], &boundary, &before);
+
+			for (int api = 0; api < ROLLOVER_APIS; api++) {
+				for (uint32_t delay = 0; delay < ROLLOVER_MAX_DELAY; delay++) {
+					ds3231_model_reset();
+					ds3231_shadow_invalidate();
+					ds3231_set_datetime(&last_second[t], &boundary);
+					i2c_host_tick_rtc_before(delay);
+
+					if (api == 0) {
+						ds3231_read_time(&time);
+						ds3231_read_date(&date);
+					} else if (api == 1) {
+						ds3231_read_datetime(&time, &date);
+					} else {
+						ds3231_read_snapshot(&snapshot);
+						time = snapshot.time;
+						date = snapshot.date;
+					}
+					reads++;
+
+					if (!datetime_seconds(&time, &date, &after) || after < before || after > before + 1)
+						torn[api]++;
+				}
+			}
+		}
+	}
+	i2c_host_reset();
+
+	if (torn[1] != 0 || torn[2] != 0 || torn[0] == 0) {
+		printf("rollover check failed: %u reads, torn: %u time then date, %u datetime, %u snapshot\n",
+				(unsigned) reads, (unsigned) torn[0], (unsigned) torn[1], (unsigned) torn[2]);
+		return 1;
+	}
+	return 0;
+}
+
+/*
+ * Description: checks the calendar against the libc gmtime, timegm and strftime for every day of the years
+ *              CALENDAR_FIRST_YEAR to CALENDAR_LAST_YEAR (the fast era 1600 to 2400 and the division path
+ *              around it), every second of a day and the ends of the 32 bit seconds range
+ * Parameters:
+ * 		None
+ * Returns:
+ *   		int 0 if every conversion matched libc
+ */
+
+static int check_calendar(void) {
+
+	int32_t first = calendar_days_from_civil(CALENDAR_FIRST_YEAR, 1, 1);
+	int32_t last = calendar_days_from_civil(CALENDAR_LAST_YEAR, 12, 31);
+	uint32_t seconds, seconds_of_day;
+	uint16_t year, iso_year;
+	uint8_t month, day, hour, minute, second, week;
+	char expected_week[16], week_text[16];
+	struct tm tm;
+	time_t unix_time;
+
+	for (int32_t days = first; days <= last; days++) {
+		unix_time = (time_t) days * 86400 + CALENDAR_UNIX_EPOCH_OFFSET;
+		gmtime_r(&unix_time, &tm);
+		calendar_civil_from_days(days, &year, &month, &day);
+		week = calendar_iso_week(days, &iso_year);
+		strftime(expected_week, sizeof(expected_week), "%G-W%V", &tm);
+		snprintf(week_text, sizeof(week_text), "%d-W%02d", iso_year, week);
+
+		if (year != tm.tm_year + 1900 || month != tm.tm_mon + 1 || day != tm.tm_mday
+				|| calendar_days_from_civil(year, month, day) != days
+				|| calendar_day_of_week(days) != tm.tm_wday
+				|| calendar_day_of_year(year, month, day) != tm.tm_yday + 1
+				|| strcmp(week_text, expected_week) != 0) {
+			printf("calendar check failed: day %ld is %02d/%02d/%d %s\n", (long) days, day, month, year,
+					week_text);
+			return 1;
+		}
+
+		if (days < 0 || (uint64_t) days * 86400 > UINT32_MAX - 86399)
+			continue;
+		seconds = (uint32_t) days * 86400;
+		if (calendar_days_from_seconds(seconds, &seconds_of_day) != days || seconds_of_day != 0
+				|| calendar_days_from_seconds(seconds + 86399, &seconds_of_day) != days
+				|| seconds_of_day != 86399 || calendar_to_unix(seconds) != (int64_t) unix_time) {
+			printf("calendar check failed: seconds of day %ld\n", (long) days);
+			return 1;
+		}
+	}
+
+	for (seconds = 0; seconds < 86400; seconds++) {
+		calendar_time_of_day(seconds, &hour, &minute, &second);
+		if (hour != seconds / 3600 || minute != seconds / 60 % 60 || second != seconds % 60) {
+			printf("calendar check failed: time of day %lu\n", (unsigned long) seconds);
+			return 1;
+		}
+	}
+
+	if (calendar_days_from_seconds(UINT32_MAX, &seconds_of_day) != (int32_t) (UINT32_MAX / 86400)
+			|| seconds_of_day != UINT32_MAX % 86400 || !calendar_from_unix(CALENDAR_UNIX_EPOCH_OFFSET, &seconds)
+			|| seconds != 0 || calendar_from_unix(CALENDAR_UNIX_EPOCH_OFFSET - 1, &seconds)
+			|| calendar_from_unix(CALENDAR_UNIX_EPOCH_OFFSET + UINT32_MAX + 1LL, &seconds)) {
+		printf("calendar check failed: seconds range\n");
+		return 1;
+	}
+	return 0;
+}
+
+/*
+ * Description: compares the local time of every compiled zone with the libc localtime of the same zone
+ *              every TZ_CHECK_STEP_S seconds from 2000 to 2100, on both sides of every transition of the
+ *              tables and, once a day, at half the time, which leaves the cached period
+ * Parameters:
+ * 		None
+ * Returns:
+ *   		int 0 if every offset and abbreviation matched libc
+ */
+
+static int check_time_zones(void) {
+
+	const tz_zone_t *zone;
+	char *saved_tz = getenv("TZ");
+
+	if (tz_select("Nowhere/Unknown") || strcmp(tz_selected()->name, TZ_DEFAULT_ZONE) != 0) {
+		printf("time zone check failed: unknown zone selected\n");
+		return 1;
+	}
+
+	for (uint8_t i = 0; i < tz_zone_count; i++) {
+		zone = &tz_zones[i];
+		if (!tz_select(zone->name) || tz_selected() != zone)
+			return 1;
+		setenv("TZ", zone->name, 1);
+		tzset();
+
+		for (uint32_t seconds = 0; seconds < TZ_CHECK_END_S; seconds += TZ_CHECK_STEP_S) {
+			if (check_local_time(seconds) || (seconds % 86400 == 0 && check_local_time(seconds / 2)))
+				return 1;
+		}
+		for (uint16_t period = 1; period < zone->count; period++) {
+			if (check_local_time(zone->starts[period] - 1) || check_local_time(zone->starts[period]))
+				return 1;
+		}
+	}
+
+	if (saved_tz != NULL)
+		setenv("TZ", saved_tz, 1);
+	else
+		unsetenv("TZ");
+	tzset();
+	tz_select(TZ_DEFAULT_ZONE);
+	return 0;
+}
+
+/*
+ * Description: converts one time with the selected zone and with libc
+ * Parameters:
+ * 		uint32_t UTC seconds since 2000-01-01
+ * Returns:
+ *   		int 0 if the offset and the abbreviation matched
+ */
+
+static int check_local_time(uint32_t utc_seconds) {
+
+	time_t unix_time = (time_t) calendar_to_unix(utc_seconds);
+	struct tm tm;
+	tz_local_t local;
+
+	localtime_r(&unix_time, &tm);
+	tz_to_local(utc_seconds, &local);
+	if (local.offset_minutes * 60 != tm.tm_gmtoff || local.seconds != utc_seconds + (uint32_t) tm.tm_gmtoff
+			|| strcmp(local.abbreviation, tm.tm_zone) != 0) {
+		printf("time zone check failed: %s at %lu is %+d %s, libc %+ld %s\n", tz_selected()->name,
+				(unsigned long) utc_seconds, local.offset_minutes, local.abbreviation, tm.tm_gmtoff / 60,
+				tm.tm_zone);
+		return 1;
+	}
+	return 0;
+}
+
+/*
+ * Description: lock of the register copy on the host, there is one thread so it only records its use
+ * Parameters:
+ * 		None
+ * Returns:
+ *   		None
+ */
+
+static void lock_shadow(void) {
+
+	if (shadow_locked)
+		nested_locks++;
+	shadow_locked = true;
+}
+
+/*
+ * Description: gives back the lock taken by lock_shadow
+ * Parameters:
+ * 		None
+ * Returns:
+ *   		None
+ */
+
+static void unlock_shadow(void) {
+
+	shadow_locked = false;
+}
+
+/*
+ * Description: checks every use of the register copy by the driver was made holding the lock, without
+ *              taking it twice, and the lock was given back
+ * Parameters:
+ * 		None
+ * Returns:
+ *   		int 0 if the copy was always used under the lock
+ */
+
+static int check_shadow_lock(void) {
+
+	ds3231_shadow_stats_t stats;
+
+	ds3231_shadow_get_stats(&stats);
+	if (stats.unlocked_accesses != 0 || nested_locks != 0 || shadow_locked) {
+		printf("shadow lock check failed: %u unlocked, %u nested\n", (unsigned) stats.unlocked_accesses,
+				(unsigned) nested_locks);
+		return 1;
+	}
+	return 0;
+}
+
+int main(int argc, char **argv) {
+
+	ds3231_time_t time = { 0 };
+	ds3231_date_t date;
+	ds3231_snapshot_t snapshot;
+	double start;
+	int failures = 0;
+
+	i2c_hal_set_ops(&i2c_host_hal_ops);
+	i2c_host_reset();
+	ds3231_shadow_set_lock(lock_shadow, unlock_shadow);
+
+	printf("%-22s %7s %8s %10s %10s %9s\n", "path", "trans", "bytes", "us@100k", "us@400k",
+			"cpu ns");
+
+	start = now_ns();
+	oled_init();
+	oled_clearDisplay();
+	report("display init + clear", OLED_ADDRESS, 1, now_ns() - start);
+
+	failures += check_display();
+	failures += check_clock();
+	failures += check_snapshot();
+	failures += check_square_wave();
+	failures += check_shadow();
+	failures += check_failed_commit();
+	failures += check_set_datetime();
+	failures += check_alarm();
+	failures += check_temperature();
+	failures += check_aging_trim();
+	failures += check_aging_offset();
+	failures += check_bcd_codec();
+	failures += check_datetime_rollover();
+	failures += check_calendar();
+	failures += check_time_zones();
+
+	i2c_host_reset();
+	start = now_ns();
+	for (uint32_t i = 0; i < BENCH_ITERATIONS; i++) {
+		time.sec = i % 60;
+		display_frame(&time);
+	}
+	report("display time frame", OLED_ADDRESS, BENCH_ITERATIONS, now_ns() - start);
+
+	i2c_host_reset();
+	start = now_ns();
+	for (uint32_t i = 0; i < BENCH_ITERATIONS; i++) {
+		ds3231_read_time(&time);
+		ds3231_read_date(&date);
+	}
+	report("rtc time + date read", DS3231_ADDRESS, BENCH_ITERATIONS, now_ns() - start);
+
+	i2c_host_reset();
+	start = now_ns();
+	for (uint32_t i = 0; i < BENCH_ITERATIONS; i++)
+		ds3231_read_datetime(&time, &date);
+	report("rtc datetime read", DS3231_ADDRESS, BENCH_ITERATIONS, now_ns() - start);
+
+	i2c_host_reset();
+	start = now_ns();
+	for (uint32_t i = 0; i < BENCH_ITERATIONS; i++)
+		ds3231_read_snapshot(&snapshot);
+	report("rtc snapshot read", DS3231_ADDRESS, BENCH_ITERATIONS, now_ns() - start);
+
+	i2c_host_reset();
+	start = now_ns();
+	for (uint32_t i = 0; i < BENCH_ITERATIONS; i++) {
+		ds3231_set_date(&date);
+		ds3231_set_time(&time);
+	}
+	report("rtc date, time set", DS3231_ADDRESS, BENCH_ITERATIONS, now_ns() - start);
+
+	i2c_host_reset();
+	start = now_ns();
+	for (uint32_t i = 0; i < BENCH_ITERATIONS; i++)
+		ds3231_set_datetime(&time, &date);
+	report("rtc datetime set", DS3231_ADDRESS, BENCH_ITERATIONS, now_ns() - start);
+
+	i2c_host_reset();
+	start = now_ns();
+	for (uint32_t i = 0; i < BENCH_ITERATIONS; i++)
+		ds3231_set_square_wave(DS3231_SQW_1HZ);
+	report("rtc square wave set", DS3231_ADDRESS, BENCH_ITERATIONS, now_ns() - start);
+
+	if (argc > 1 && strcmp(argv[1], "-r") == 0) {
+		oled_printstring("12:34:56", TIME_COLUMN, TIME_PAGE);
+		oled_flush();
+		ssd1306_model_render(stdout);
+	}
+
+	failures += check_shadow_lock();
+	printf("%s\n", failures ? "model checks FAILED" : "model checks passed");
+	return failures ? 1 : 0;
+}
@@ -0,0 +1,245 @@
+/*******************************************************************************
+ * Copyright (C) 2023 by PRANJAL GUPTA
+ *
+ * Redistribution, modification or use of this software in source or binary
+ * forms is permitted as long as the files maintain this copyright. Users are
+ * permitted to modify this and use it to learn about the field of embedded
+ * software. PRANJAL GUPTA and the University of Colorado are not liable for
+ * any misuse of this material.
+ * ****************************************************************************/
+
+/**
+ * @file    i2c_hal_host.c
+ * @brief   This file contains the host backend of the i2c bus interface. The segments of a write are
+ *          joined and handed to the model of the addressed slave, a read is a register address write
+ *          followed by a read as on the wire. Every transaction is counted with the number of SCL periods
+ *          it would take, so the bus time of a driver path can be worked out for any SCL frequency.
+ *          A slave without a model does not acknowledge its address.
+ *
+ * @author  Pranjal Gupta
+ * @date    12/18/2023
+ *
+ */
+#include "i2c_hal_host.h"
+#include "ds3231_model.h"
+#include "ssd1306_model.h"
+#include "DS3231.h"
+#include "oled_driver.h"
+#include "string.h"
+
+static i2c_status_t host_transmitv(i2c_priority_t priority, uint8_t device_addr,
+		const i2c_iovec_t *segments, uint8_t count);
+static i2c_status_t host_read(i2c_priority_t priority, uint8_t device_addr, uint8_t read_addr,
+		uint8_t *rx_buffer, uint8_t length);
+static i2c_host_device_stats_t *host_device(uint8_t device_addr);
+static i2c_status_t ds3231_transaction_start(void);
+
+#define HOST_MAX_WRITE 1024
+#define BITS_PER_BYTE 9                 // eight data bits and the acknowledge
+#define START_STOP_BITS 2
+
+static i2c_host_device_stats_t ds3231_stats, oled_stats, other_stats;
+static int32_t rtc_tick_countdown = -1;     // DS3231 transactions before the model ticks, -1 for none
+static int32_t rtc_fail_countdown = -1;     // DS3231 transactions before one fails, -1 for none
+static i2c_status_t rtc_fail_status;
+
+const i2c_hal_ops_t i2c_host_hal_ops = {
+	.transmitv = host_transmitv,
+	.read = host_read
+};
+
+/*
+ * Description: resets the models and the counters
+ * Parameters:
+ * 		None
+ * Returns:
+ *   		None
+ */
+
+void i2c_host_reset(void) {
+
+	ds3231_model_reset();
+	ssd1306_model_reset();
+	memset(&ds3231_stats, 0, sizeof(ds3231_stats));
+	memset(&oled_stats, 0, sizeof(oled_stats));
+	memset(&other_stats, 0, sizeof(other_stats));
+	rtc_tick_countdown = -1;
+	rtc_fail_countdown = -1;
+}
+
+/*
+ * Description: lets the DS3231 model tick one second at the start of a later transaction, like a second
+ *              rolling over on the chip between two transactions of the driver. The chip copies the time
+ *              registers to its read buffer on the start condition, so a tick never lands inside one.
+ * Parameters:
+ * 		uint32_t number of DS3231 transactions to let through first, 0 ticks before the next one
+ * Returns:
+ *   		None
+ */
+
+void i2c_host_tick_rtc_before(uint32_t transactions) {
+	rtc_tick_countdown = (int32_t) transactions;
+}
+
+/*
+ * Description: makes one later DS3231 transaction fail with a bus error, it does not reach the model
+ * Parameters:
+ * 		uint32_t number of DS3231 transactions to let through first, 0 fails the next one
+ * 		i2c_status_t the result of the failed transaction
+ * Returns:
+ *   		None
+ */
+
+void i2c_host_fail_rtc_after(uint32_t transactions, i2c_status_t status) {
+	rtc_fail_countdown = (int32_t) transactions;
+	rtc_fail_status = status;
+}
+
+/*
+ * Description: called at the start of every DS3231 transaction, ticks the model or fails the transaction
+ *              when it is due
+ * Parameters:
+ * 		None
+ * Returns:
+ *   		i2c_status_t I2C_STATUS_OK when the transaction goes on to the model
+ */
+
+static i2c_status_t ds3231_transaction_start(void) {
+
+	bool fail = rtc_fail_countdown == 0;
+
+	if (rtc_tick_countdown == 0)
+		ds3231_model_tick_second();
+	if (rtc_tick_countdown >= 0)
+		rtc_tick_countdown--;
+	if (rtc_fail_countdown >= 0)
+		rtc_fail_countdown--;
+	return fail ? rtc_fail_status : I2C_STATUS_OK;
+}
+
+/*
+ * Description: returns the counters of a slave, the slaves without a model share one set
+ * Parameters:
+ * 		uint8_t device address of the slave
+ * Returns:
+ *   		i2c_host_device_stats_t * the counters
+ */
+
+static i2c_host_device_stats_t *host_device(uint8_t device_addr) {
+
+	switch (device_addr) {
+	case DS3231_ADDRESS:
+		return &ds3231_stats;
+	case OLED_ADDRESS:
+		return &oled_stats;
+	default:
+		return &other_stats;
+	}
+}
+
+/*
+ * Description: copies the counters of a slave
+ * Parameters:
+ * 		uint8_t device address of the slave
+ * 		i2c_host_device_stats_t * the structure to be filled
+ * Returns:
+ *   		None
+ */
+
+void i2c_host_get_stats(uint8_t device_addr, i2c_host_device_stats_t *stats) {
+	*stats = *host_device(device_addr);
+}
+
+/*
+ * Description: time the counted transactions take on a bus running at the given SCL frequency
+ * Parameters:
+ * 		const i2c_host_device_stats_t * the counters
+ * 		uint32_t SCL frequency in Hz
+ * Returns:
+ *   		double the bus time in micro seconds
+ */
+
+double i2c_host_bus_time_us(const i2c_host_device_stats_t *stats, uint32_t scl_hz) {
+	return stats->wire_bits * 1e6 / scl_hz;
+}
+
+/*
+ * Description: host version of a write transaction
+ * Parameters:
+ * 		i2c_priority_t priority of the transaction, not used on the host
+ * 		uint8_t device addr the device address of the slave
+ * 		const i2c_iovec_t * the segments to be sent one after the other
+ * 		uint8_t number of segments
+ * Returns:
+ *   		i2c_status_t the result of the transaction
+ */
+
+static i2c_status_t host_transmitv(i2c_priority_t priority, uint8_t device_addr,
+		const i2c_iovec_t *segments, uint8_t count) {
+
+	i2c_host_device_stats_t *stats = host_device(device_addr);
+	uint8_t buffer[HOST_MAX_WRITE];
+	int length = 0;
+
+	for (uint8_t i = 0; i < count; i++) {
+		if (length + segments[i].length > HOST_MAX_WRITE)
+			return I2C_STATUS_DMA_ERROR;
+		memcpy(&buffer[length], segments[i].data, segments[i].length);
+		length += segments[i].length;
+	}
+
+	stats->transactions++;
+	if (stats == &other_stats) {
+		stats->nacks++;
+		stats->wire_bits += START_STOP_BITS + BITS_PER_BYTE;
+		return I2C_STATUS_NACK;
+	}
+
+	stats->payload_bytes += length;
+	stats->wire_bits += START_STOP_BITS + BITS_PER_BYTE * (1 + length);
+
+	if (device_addr == DS3231_ADDRESS) {
+		if (ds3231_transaction_start() != I2C_STATUS_OK)
+			return rtc_fail_status;
+		ds3231_model_write(buffer, length);
+	} else
+		ssd1306_model_write(buffer, length);
+
+	return I2C_STATUS_OK;
+}
+
+/*
+ * Description: host version of a register read, address and register written, repeated start, address
+ *              and the bytes read
+ * Parameters:
+ * 		i2c_priority_t priority of the transaction, not used on the host
+ * 		uint8_t device addr the device address of the slave
+ * 		uint8_t read_addr  address of the register to be read from the slave
+ * 		uint8_t *rx_buffer the data buffer to store the read data
+ * 		uint8_t length  the length of the data to be read
+ * Returns:
+ *   		i2c_status_t the result of the transaction
+ */
+
+static i2c_status_t host_read(i2c_priority_t priority, uint8_t device_addr, uint8_t read_addr,
+		uint8_t *rx_buffer, uint8_t length) {
+
+	i2c_host_device_stats_t *stats = host_device(device_addr);
+
+	stats->transactions++;
+	if (device_addr != DS3231_ADDRESS) {          // the display has no read back over i2c
+		stats->nacks++;
+		stats->wire_bits += START_STOP_BITS + BITS_PER_BYTE;
+		return I2C_STATUS_NACK;
+	}
+
+	stats->payload_bytes += 1 + length;
+	stats->wire_bits += START_STOP_BITS + 1 + BITS_PER_BYTE * (3 + length);   // repeated start
+
+	if (ds3231_transaction_start() != I2C_STATUS_OK)
+		return rtc_fail_status;
+	ds3231_model_write(&read_addr, 1);
+	ds3231_model_read(rx_buffer, length);
+
+	return I2C_STATUS_OK;
+}
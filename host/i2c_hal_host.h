@@ -0,0 +1,42 @@
+/*******************************************************************************
+ * Copyright (C) 2023 by PRANJAL GUPTA
+ *
+ * Redistribution, modification or use of this software in source or binary
+ * forms is permitted as long as the files maintain this copyright. Users are
+ * permitted to modify this and use it to learn about the field of embedded
+ * software. PRANJAL GUPTA and the University of Colorado are not liable for
+ * any misuse of this material.
+ * ****************************************************************************/
+
+/**
+ * @file    i2c_hal_host.h
+ * @brief   This file has the host backend of the i2c bus interface, the transactions are routed to the
+ *          DS3231 and SSD1306 models and counted.
+ *
+ * @author  Pranjal Gupta
+ * @date    12/18/2023
+ *
+ */
+
+#ifndef I2C_HAL_HOST_H_
+#define I2C_HAL_HOST_H_
+
+#include "stdint.h"
+#include "i2c_hal.h"
+
+typedef struct {
+	uint32_t transactions;
+	uint32_t payload_bytes;     // bytes after the address byte, register address included
+	uint32_t wire_bits;         // SCL periods on the wire, start, address, data, acknowledges and stop
+	uint32_t nacks;
+} i2c_host_device_stats_t;
+
+extern const i2c_hal_ops_t i2c_host_hal_ops;
+
+void i2c_host_reset(void);
+void i2c_host_get_stats(uint8_t device_addr, i2c_host_device_stats_t *stats);
+double i2c_host_bus_time_us(const i2c_host_device_stats_t *stats, uint32_t scl_hz);
+void i2c_host_tick_rtc_before(uint32_t transactions);
+void i2c_host_fail_rtc_after(uint32_t transactions, i2c_status_t status);
+
+#endif /* I2C_HAL_HOST_H_ */
@@ -0,0 +1,243 @@
+/*******************************************************************************
+ * Copyright (C) 2023 by PRANJAL GUPTA
+ *
+ * Redistribution, modification or use of this software in source or binary
+ * forms is permitted as long as the files maintain this copyright. Users are
+ * permitted to modify this and use it to learn about the field of embedded
+ * software. PRANJAL GUPTA and the University of Colorado are not liable for
+ * any misuse of this material.
+ * ****************************************************************************/
+
+/**
+ * @file    ssd1306_model.c
+ * @brief   This file contains a host model of the SSD1306 as seen from the i2c bus. The control byte of a
+ *          write (Co = 0) selects whether the rest of it is a command stream or GDDRAM data. The commands
+ *          which move the write position (memory mode, column and page windows, page mode start
+ *          addresses) are followed, the others are only counted. The GDDRAM is 8 pages of 128 columns.
+ *
+ * @author  Pranjal Gupta
+ * @date    12/18/2023
+ *
+ */
+#include "ssd1306_model.h"
+#include "string.h"
+
+static int command_arguments(uint8_t command);
+static void run_command(const uint8_t *command);
+static void write_data(uint8_t data);
+
+#define CONTROL_DATA_BIT 0x40
+#define MODE_HORIZONTAL 0
+#define MODE_VERTICAL 1
+#define MODE_PAGE 2
+#define MAX_COMMAND_LENGTH 3
+
+static uint8_t gddram[SSD1306_MODEL_PAGES][SSD1306_MODEL_COLUMNS];
+static uint8_t addressing_mode;
+static uint8_t column, page;
+static uint8_t column_start, column_end, page_start, page_end;
+static ssd1306_model_stats_t stats;
+
+/*
+ * Description: puts the controller in its reset state, page addressing at page 0 column 0, display off
+ * Parameters:
+ * 		None
+ * Returns:
+ *   		None
+ */
+
+void ssd1306_model_reset(void) {
+
+	memset(gddram, 0, sizeof(gddram));
+	memset(&stats, 0, sizeof(stats));
+	addressing_mode = MODE_PAGE;
+	column = page = 0;
+	column_start = page_start = 0;
+	column_end = SSD1306_MODEL_COLUMNS - 1;
+	page_end = SSD1306_MODEL_PAGES - 1;
+}
+
+/*
+ * Description: number of argument bytes following a command byte
+ * Parameters:
+ * 		uint8_t the command byte
+ * Returns:
+ *   		int number of arguments
+ */
+
+static int command_arguments(uint8_t command) {
+
+	switch (command) {
+	case 0x20:      // memory addressing mode
+	case 0x81:      // contrast
+	case 0x8D:      // charge pump
+	case 0xA8:      // multiplex ratio
+	case 0xD3:      // display offset
+	case 0xD5:      // clock divide ratio
+	case 0xD9:      // pre-charge period
+	case 0xDA:      // com pins
+	case 0xDB:      // vcomh deselect level
+		return 1;
+	case 0x21:      // column address window
+	case 0x22:      // page address window
+		return 2;
+	default:
+		return 0;
+	}
+}
+
+/*
+ * Description: runs one command with its arguments
+ * Parameters:
+ * 		const uint8_t * the command byte followed by its arguments
+ * Returns:
+ *   		None
+ */
+
+static void run_command(const uint8_t *command) {
+
+	stats.commands++;
+
+	if (command[0] <= 0x0F) {                                   // lower column start, page mode
+		column = (column & 0xF0) | command[0];
+	} else if (command[0] <= 0x1F) {                            // higher column start, page mode
+		column = (uint8_t) ((column & 0x0F) | ((command[0] & 0x0F) << 4));
+	} else if (command[0] >= 0xB0 && command[0] <= 0xB7) {      // page start, page mode
+		page = command[0] & 0x07;
+	} else {
+		switch (command[0]) {
+		case 0x20:
+			addressing_mode = command[1] & 0x03;
+			break;
+		case 0x21:
+			column_start = column = command[1] & 0x7F;
+			column_end = command[2] & 0x7F;
+			break;
+		case 0x22:
+			page_start = page = command[1] & 0x07;
+			page_end = command[2] & 0x07;
+			break;
+		case 0xAE:
+			stats.display_on = false;
+			break;
+		case 0xAF:
+			stats.display_on = true;
+			break;
+		default:
+			if (!((command[0] >= 0x40 && command[0] <= 0x7F) || command_arguments(command[0]) != 0
+					|| (command[0] >= 0xA0 && command[0] <= 0xA7) || command[0] == 0xC0
+					|| command[0] == 0xC8))
+				stats.unknown_commands++;
+			break;
+		}
+	}
+}
+
+/*
+ * Description: stores one GDDRAM byte and moves the write position as the addressing mode does
+ * Parameters:
+ * 		uint8_t the byte, bit 0 is the top row of the page
+ * Returns:
+ *   		None
+ */
+
+static void write_data(uint8_t data) {
+
+	gddram[page][column] = data;
+	stats.data_bytes++;
+
+	switch (addressing_mode) {
+	case MODE_HORIZONTAL:
+		if (column++ == column_end) {
+			column = column_start;
+			page = (page == page_end) ? page_start : page + 1;
+		}
+		break;
+	case MODE_VERTICAL:
+		if (page++ == page_end) {
+			page = page_start;
+			column = (column == column_end) ? column_start : column + 1;
+		}
+		break;
+	default:
+		if (column < SSD1306_MODEL_COLUMNS - 1)      // page mode does not move to the next page
+			column++;
+		break;
+	}
+}
+
+/*
+ * Description: a write transaction, the bytes after the address byte
+ * Parameters:
+ * 		const uint8_t * the bytes, starting with the control byte
+ * 		int number of bytes
+ * Returns:
+ *   		None
+ */
+
+void ssd1306_model_write(const uint8_t *data, int length) {
+
+	uint8_t command[MAX_COMMAND_LENGTH];
+	int needed = 0, have = 0;
+
+	if (length == 0)
+		return;
+
+	if (data[0] & CONTROL_DATA_BIT) {
+		for (int i = 1; i < length; i++)
+			write_data(data[i]);
+		return;
+	}
+
+	for (int i = 1; i < length; i++) {
+		command[have++] = data[i];
+		if (have == 1)
+			needed = 1 + command_arguments(data[i]);
+		if (have == needed) {
+			run_command(command);
+			have = 0;
+		}
+	}
+}
+
+/*
+ * Description: returns one byte of the GDDRAM
+ * Parameters:
+ * 		uint8_t page 0 to 7
+ * 		uint8_t column 0 to 127
+ * Returns:
+ *   		uint8_t the 8 pixels of the column in the page
+ */
+
+uint8_t ssd1306_model_gddram(uint8_t page, uint8_t column) {
+	return gddram[page % SSD1306_MODEL_PAGES][column % SSD1306_MODEL_COLUMNS];
+}
+
+/*
+ * Description: copies the command and data counters
+ * Parameters:
+ * 		ssd1306_model_stats_t * the structure to be filled
+ * Returns:
+ *   		None
+ */
+
+void ssd1306_model_get_stats(ssd1306_model_stats_t *model_stats) {
+	*model_stats = stats;
+}
+
+/*
+ * Description: prints the GDDRAM as text, one character per pixel
+ * Parameters:
+ * 		FILE * the stream to print on
+ * Returns:
+ *   		None
+ */
+
+void ssd1306_model_render(FILE *out) {
+
+	for (int row = 0; row < SSD1306_MODEL_PAGES * 8; row++) {
+		for (int col = 0; col < SSD1306_MODEL_COLUMNS; col++)
+			fputc((gddram[row / 8][col] >> (row % 8)) & 1 ? '#' : '.', out);
+		fputc('\n', out);
+	}
+}
@@ -0,0 +1,43 @@
+/*******************************************************************************
+ * Copyright (C) 2023 by PRANJAL GUPTA
+ *
+ * Redistribution, modification or use of this software in source or binary
+ * forms is permitted as long as the files maintain this copyright. Users are
+ * permitted to modify this and use it to learn about the field of embedded
+ * software. PRANJAL GUPTA and the University of Colorado are not liable for
+ * any misuse of this material.
+ * ****************************************************************************/
+
+/**
+ * @file    ssd1306_model.h
+ * @brief   This file has the function prototypes of the host model of the SSD1306 controller and GDDRAM.
+ *
+ * @author  Pranjal Gupta
+ * @date    12/18/2023
+ *
+ */
+
+#ifndef SSD1306_MODEL_H_
+#define SSD1306_MODEL_H_
+
+#include "stdint.h"
+#include "stdbool.h"
+#include "stdio.h"
+
+#define SSD1306_MODEL_PAGES 8
+#define SSD1306_MODEL_COLUMNS 128
+
+typedef struct {
+	uint32_t commands;          // command bytes decoded, arguments not counted
+	uint32_t data_bytes;        // bytes written to the GDDRAM
+	uint32_t unknown_commands;
+	bool display_on;
+} ssd1306_model_stats_t;
+
+void ssd1306_model_reset(void);
+void ssd1306_model_write(const uint8_t *data, int length);
+uint8_t ssd1306_model_gddram(uint8_t page, uint8_t column);
+void ssd1306_model_get_stats(ssd1306_model_stats_t *model_stats);
+void ssd1306_model_render(FILE *out);
+
+#endif /* SSD1306_MODEL_H_ */
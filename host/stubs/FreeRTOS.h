@@ -0,0 +1,30 @@
+/*******************************************************************************
+ * Copyright (C) 2023 by PRANJAL GUPTA
+ *
+ * Redistribution, modification or use of this software in source or binary
+ * forms is permitted as long as the files maintain this copyright. Users are
+ * permitted to modify this and use it to learn about the field of embedded
+ * software. PRANJAL GUPTA and the University of Colorado are not liable for
+ * any misuse of this material.
+ * ****************************************************************************/
+
+/**
+ * @file    FreeRTOS.h
+ * @brief   This file stands in for the FreeRTOS header in the host build of the clock service and the cycle
+ *          counter, it only has the configuration and the port macros they use.
+ *
+ * @author  Pranjal Gupta
+ * @date    12/30/2023
+ *
+ */
+
+#ifndef HOST_FREERTOS_H_
+#define HOST_FREERTOS_H_
+
+#define configCPU_CLOCK_HZ 48000000U      // SystemCoreClock of the board
+#define configTICK_RATE_HZ 1000U
+
+#define portSET_INTERRUPT_MASK_FROM_ISR() 0U
+#define portCLEAR_INTERRUPT_MASK_FROM_ISR(mask) ((void) (mask))
+
+#endif /* HOST_FREERTOS_H_ */
@@ -0,0 +1,43 @@
+/*******************************************************************************
+ * Copyright (C) 2023 by PRANJAL GUPTA
+ *
+ * Redistribution, modification or use of this software in source or binary
+ * forms is permitted as long as the files maintain this copyright. Users are
+ * permitted to modify this and use it to learn about the field of embedded
+ * software. PRANJAL GUPTA and the University of Colorado are not liable for
+ * any misuse of this material.
+ * ****************************************************************************/
+
+/**
+ * @file    MKL25Z4.h
+ * @brief   This file stands in for the KL25Z device header in the host build of the clock service, the
+ *          SysTick registers read by the cycle counter and the RTC are simulated by clock_host.c.
+ *
+ * @author  Pranjal Gupta
+ * @date    12/30/2023
+ *
+ */
+
+#ifndef HOST_MKL25Z4_H_
+#define HOST_MKL25Z4_H_
+
+#include "stdint.h"
+
+typedef struct {
+	volatile uint32_t LOAD;
+	volatile uint32_t VAL;            // counts down from LOAD, the tick is at the reload
+} SysTick_Type;
+
+typedef struct {
+	volatile uint32_t ICSR;
+} SCB_Type;
+
+#define SCB_ICSR_PENDSTSET_Msk (1UL << 26)
+
+extern SysTick_Type host_systick;
+extern SCB_Type host_scb;
+
+#define SysTick (&host_systick)
+#define SCB (&host_scb)
+
+#endif /* HOST_MKL25Z4_H_ */
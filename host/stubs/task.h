@@ -0,0 +1,27 @@
+/*******************************************************************************
+ * Copyright (C) 2023 by PRANJAL GUPTA
+ *
+ * Redistribution, modification or use of this software in source or binary
+ * forms is permitted as long as the files maintain this copyright. Users are
+ * permitted to modify this and use it to learn about the field of embedded
+ * software. PRANJAL GUPTA and the University of Colorado are not liable for
+ * any misuse of this material.
+ * ****************************************************************************/
+
+/**
+ * @file    task.h
+ * @brief   This file stands in for the FreeRTOS task header in the host build of the clock service. The host
+ *          checks run in one thread, so the critical sections are empty.
+ *
+ * @author  Pranjal Gupta
+ * @date    12/30/2023
+ *
+ */
+
+#ifndef HOST_TASK_H_
+#define HOST_TASK_H_
+
+#define taskENTER_CRITICAL()
+#define taskEXIT_CRITICAL()
+
+#endif /* HOST_TASK_H_ */
@@ -18,170 +18,340 @@
  */
 
 #include "DS3231.h"
-#include "i2c.h"
+#include "ds3231_shadow.h"
+#include "bcd.h"
+#include "calendar.h"
 #include "stdint.h"
 #include "stdbool.h"
 #include "stdlib.h"
 
-static uint8_t decimal_to_bcd_conversion(uint8_t dec_num);
-static int bcd_to_decimal_conversion(uint8_t bcd_num);
+static void decode_datetime(const uint8_t *registers, ds3231_time_t *time, ds3231_date_t *date);
+static void encode_datetime(const ds3231_time_t *time, const ds3231_date_t *date, uint8_t *registers);
+static void store_temperature(const uint8_t *registers);
+static i2c_status_t start_conversion(bool *started);
 
 
+#define DS3231_CONTROL_REG_ADDR 0x0E
 #define DS3231_CONTROL_STATUS 0x0F
+#define DS3231_AGING_REG_ADDR 0x10
+#define DS3231_TEMP_MSB_REG_ADDR 0x11
+#define DS3231_TEMP_LSB_REG_ADDR 0x12
+#define TEMP_FRACTION_SHIFT 6
+#define CONTROL_INTCN_BIT 0x04           // INT/SQW pin is the alarm interrupt instead of the square wave
+#define CONTROL_RS_SHIFT 3
+#define CONTROL_RS_MASK (0x03 << CONTROL_RS_SHIFT)
+#define CONTROL_A1IE_BIT 0x01
+#define CONTROL_CONV_BIT 0x20            // starts a temperature conversion, cleared by the device when done
+#define STATUS_BSY 0x04                  // a conversion is running
+#define CENTI_PER_QUARTER_DEGREE 25
+#define TEMP_REG_COUNT 2
+#define STATUS_ALARM_FLAGS 0x03          // A2F and A1F, writing 1 leaves them as they are
+#define DS3231_ALARM1_REG_ADDR 0x07
+#define ALARM1_REG_COUNT 4
+#define STATUS_EN32KHZ 0x08
+#define DATETIME_REG_COUNT (DS3231_TIME_REG_COUNT + DS3231_DATE_REG_COUNT)
 #define DS3231_DAY_REF_ADDR 0x03
 #define CURRENT_CENTURY_OFFSET 2000
 #define CENTURY_FACTOR 100
 #define CENTURY_BIT_IN_MONTH_REG 7
-#define EXTRACTING_SEVEN_BIT_MASK 0x7F
+#define DS3231_TIME_REG_COUNT 3
+#define DS3231_DATE_REG_COUNT 4
 #define DS3231_SEC_REG_ADDR 0
+#define DS3231_MONTH_REG_ADDR 0x05
+
+/* BCD digits of the seconds to year registers, without CH, 12/24, century and unused bits */
+static const uint8_t datetime_digit_masks[DATETIME_REG_COUNT] = { 0x7F, 0x7F, 0x3F, 0x07, 0x3F, 0x1F, 0xFF };
+
+/* last temperature read and the time it was read at */
+static struct {
+	bool valid;
+	bool conversion_pending;
+	int16_t centi_celsius;
+	uint32_t read_at;
+} temperature_cache;
+static ds3231_clock_t seconds_clock = NULL;
 
 
 /*
- * Description: Converts decimal to bcd number
+ * Description: Sets the time in RTC DS3231 by converting them into bcd numbers first and then writing using i2c,
+ *              registers staged in the shadow before are written in the same commit
  *
  * Parameters:
- *    			uint8_t  a decimal number
+ *    		ds3231_time_t a pointer which contains the time data t be write in the RTC
  *
  * Returns:
- *   		uint8_t the converted bcd number
+ *   		NULL
  */
 
 
-static uint8_t decimal_to_bcd_conversion(uint8_t dec_num){
+void ds3231_set_time(ds3231_time_t *time){
 
-	return (uint8_t)((dec_num/10*16) + (dec_num % 10));
+	uint8_t data_to_send[DATETIME_REG_COUNT];
 
-}
+	encode_datetime(time, NULL, data_to_send);
+	ds3231_shadow_lock();
+	ds3231_shadow_write(DS3231_SEC_REG_ADDR, data_to_send, DS3231_TIME_REG_COUNT);
+	ds3231_shadow_commit();
+	ds3231_shadow_unlock();
 
+}
 
 /*
- * Description: Converts bcd to decimal number
+ * Description: It reads the time back using i2c from the RTC DS3231 and converts them back into decimal form
  *
  * Parameters:
- *    			uint8_t  a bcd number
+ *    		ds3231_time_t a pointer which contains the read data from the RTC
  *
  * Returns:
- *   		int the converted decimal number
+ *   		NULL
  */
 
 
-static int bcd_to_decimal_conversion(uint8_t bcd_num){
-	return (int)((bcd_num/16*10) + (bcd_num%16));
+void ds3231_read_time(ds3231_time_t *time){
+
+	uint8_t data_to_read[DATETIME_REG_COUNT] = { 0 };
+
+	ds3231_shadow_lock();
+	ds3231_shadow_read(DS3231_SEC_REG_ADDR, data_to_read, DS3231_TIME_REG_COUNT);
+	ds3231_shadow_unlock();
+	decode_datetime(data_to_read, time, NULL);
+
 }
 
 
 /*
- * Description: Sets the time in RTC DS3231 by converting them into bcd numbers first and then writing using i2c
+ * Description: Sets the date in RTC DS3231 by converting them into bcd numbers first and then writing using i2c,
+ *              registers staged in the shadow before are written in the same commit. The century bit of the
+ *              month register is set for the years 2100 to 2199.
  *
  * Parameters:
- *    		ds3231_time_t a pointer which contains the time data t be write in the RTC
+ *    		ds3231_date_t a pointer which contains the date to be written in the RTC
  *
  * Returns:
  *   		NULL
  */
+void ds3231_set_date(ds3231_date_t *date){
 
+	uint8_t data_to_send[DATETIME_REG_COUNT];
 
-void ds3231_set_time(ds3231_time_t *time){
+	encode_datetime(NULL, date, data_to_send);
+	ds3231_shadow_lock();
+	ds3231_shadow_write(DS3231_DAY_REF_ADDR, &data_to_send[DS3231_DAY_REF_ADDR], DS3231_DATE_REG_COUNT);
+	ds3231_shadow_commit();
+	ds3231_shadow_unlock();
+}
+
+/*
+ * Description: converts the time and the date into the registers 0x00 to 0x06 in one pass, the century
+ *              bit of the month register is set for the years 2100 to 2199. The day of the week is worked out
+ *              from the date, the dow field of the caller is not used.
+ *
+ * Parameters:
+ *    		const ds3231_time_t * the time, NULL leaves the registers 0x00 to 0x02 at 0
+ *    		const ds3231_date_t * the date, NULL leaves the registers 0x03 to 0x06 at 0
+ *    		uint8_t * the seven registers starting at 0x00
+ *
+ * Returns:
+ *   		NULL
+ */
+static void encode_datetime(const ds3231_time_t *time, const ds3231_date_t *date, uint8_t *registers){
 
-	uint8_t data_to_send[4];
+	uint8_t binary[DATETIME_REG_COUNT] = { 0 };
+	uint8_t century = 0;
 
-	data_to_send[0] = DS3231_SEC_REG_ADDR;
-	data_to_send[1] = decimal_to_bcd_conversion(time->sec);
-	data_to_send[2] = decimal_to_bcd_conversion(time->min);
-	data_to_send[3] = decimal_to_bcd_conversion(time->hour);
+	if (time != NULL) {
+		binary[0] = time->sec;
+		binary[1] = time->min;
+		binary[2] = time->hour;
+	}
 
+	if (date != NULL) {
+		century = date->year >= CURRENT_CENTURY_OFFSET + CENTURY_FACTOR;
+		binary[3] = calendar_day_of_week(calendar_days_from_civil(date->year, date->month, date->date));
+		binary[4] = date->date;
+		binary[5] = date->month;
+		binary[6] = (uint8_t) (date->year - CURRENT_CENTURY_OFFSET - century * CENTURY_FACTOR);
+	}
 
-	i2c_data_transmit(DS3231_ADDRESS, data_to_send, sizeof(data_to_send));
+	bcd_encode(binary, registers, DATETIME_REG_COUNT);
+	registers[DS3231_MONTH_REG_ADDR] |= century << CENTURY_BIT_IN_MONTH_REG;
 
 }
 
 /*
- * Description: It reads the time back using i2c from the RTC DS3231 and converts them back into decimal form
+ * Description: Sets the time and the date in one burst write of the registers 0x00 to 0x06, so a second
+ *              rolling over between the time and the date can not be stored, and then clears the OSF flag
+ *              as the time is valid again. The DS3231 restarts its one second countdown when the seconds
+ *              register is written. The status register is written back as it was read with OSF cleared,
+ *              the alarm flags are written as 1 which leaves them as they are. Nothing is written when the
+ *              status register can not be read.
  *
  * Parameters:
- *    		ds3231_time_t a pointer which contains the read data from the RTC
+ *    		const ds3231_time_t * the time to be written in the RTC
+ *    		const ds3231_date_t * the date to be written in the RTC
  *
  * Returns:
- *   		NULL
+ *   		i2c_status_t the first error of the status read and the writes, I2C_STATUS_OK when both were written
  */
+i2c_status_t ds3231_set_datetime(const ds3231_time_t *time, const ds3231_date_t *date){
+
+	uint8_t data_to_send[DATETIME_REG_COUNT];
+	uint8_t status;
+	i2c_status_t result;
+
+	encode_datetime(time, date, data_to_send);
+	ds3231_shadow_lock();
+
+	result = I2C_STATUS_OK;
+	if (!ds3231_shadow_cached(DS3231_CONTROL_STATUS, &status))
+		result = ds3231_shadow_read(DS3231_CONTROL_STATUS, &status, 1);
+	if (result == I2C_STATUS_OK) {
+		status = (status & ~DS3231_STATUS_OSF) | STATUS_ALARM_FLAGS;
+		ds3231_shadow_write(DS3231_SEC_REG_ADDR, data_to_send, sizeof(data_to_send));
+		ds3231_shadow_write(DS3231_CONTROL_STATUS, &status, 1);
+		result = ds3231_shadow_commit();
+	}
+	ds3231_shadow_unlock();
 
+	return result;
+}
 
-void ds3231_read_time(ds3231_time_t *time){
+/*
+ * Description: It reads the date back using i2c from the RTC DS3231 and converts them back into decimal form
+ *
+ * Parameters:
+ *    		ds3231_date_t a pointer which contains the read data from the RTC
+ *
+ * Returns:
+ *   		NULL
+ */
+void ds3231_read_date(ds3231_date_t *date){
 
-	i2c_read_bytes(DS3231_ADDRESS, DS3231_SEC_REG_ADDR ,(uint8_t*)time, sizeof(ds3231_time_t));
+	uint8_t data_to_read[DATETIME_REG_COUNT] = { 0 };
 
-	time->sec = bcd_to_decimal_conversion(time->sec);
-	time->min = bcd_to_decimal_conversion(time->min);
-	time->hour = bcd_to_decimal_conversion(time->hour);
+	ds3231_shadow_lock();
+	ds3231_shadow_read(DS3231_DAY_REF_ADDR, &data_to_read[DS3231_DAY_REF_ADDR], DS3231_DATE_REG_COUNT);
+	ds3231_shadow_unlock();
+	decode_datetime(data_to_read, NULL, date);
 
 }
 
-
-
 /*
- * Description: Sets the date in RTC DS3231 by converting them into bcd numbers first and then writing using i2c
+ * Description: reads the time and the date in one burst of the registers 0x00 to 0x06. The DS3231 copies the
+ *              time keeping registers to its read buffer on the start condition, so both belong to the same
+ *              second. ds3231_read_time followed by ds3231_read_date are two transactions and can give
+ *              00:00:00 with the date of the day before when midnight falls between them.
  *
  * Parameters:
- *    		ds3231_date_t a pointer which contains the date to be written in the RTC
+ *    		ds3231_time_t a pointer which is filled with the time
+ *    		ds3231_date_t a pointer which is filled with the date
  *
  * Returns:
- *   		NULL
+ *   		i2c_status_t the result of the read, the time and the date are only filled when it is I2C_STATUS_OK
  */
-void ds3231_set_date(ds3231_date_t *date){
+i2c_status_t ds3231_read_datetime(ds3231_time_t *time, ds3231_date_t *date){
 
-	uint8_t data_to_send[5];
-	uint8_t century = (date->year / CENTURY_FACTOR) % 20; // extracting the century from the current year
-	date->month = ((date->month & EXTRACTING_SEVEN_BIT_MASK) | (century << CENTURY_BIT_IN_MONTH_REG));   // setting the century bit in month register
-	uint8_t year = (date->year % CENTURY_FACTOR);        // Extracting the current year
+	uint8_t data_to_read[DATETIME_REG_COUNT];
+	i2c_status_t status;
 
-	data_to_send[0] = DS3231_DAY_REF_ADDR;
-	data_to_send[1] = decimal_to_bcd_conversion(date->dow);
-	data_to_send[2] = decimal_to_bcd_conversion(date->date);
-	data_to_send[3] = decimal_to_bcd_conversion(date->month);
-	data_to_send[4] = decimal_to_bcd_conversion(year);
+	ds3231_shadow_lock();
+	status = ds3231_shadow_read(DS3231_SEC_REG_ADDR, data_to_read, sizeof(data_to_read));
+	ds3231_shadow_unlock();
+	if (status == I2C_STATUS_OK)
+		decode_datetime(data_to_read, time, date);
 
+	return status;
 
-	i2c_data_transmit(DS3231_ADDRESS, data_to_send, sizeof(data_to_send));
 }
 
 /*
- * Description: It reads the date back using i2c from the RTC DS3231 and converts them back into decimal form
+ * Description: converts the registers 0x00 to 0x06 into the time and the date in one pass
  *
  * Parameters:
- *    		ds3231_date_t a pointer which contains the read data from the RTC
+ *    		const uint8_t * the seven registers starting at 0x00
+ *    		ds3231_time_t a pointer which is filled with the time, NULL when it is not needed
+ *    		ds3231_date_t a pointer which is filled with the date, NULL when it is not needed
  *
  * Returns:
  *   		NULL
  */
-void ds3231_read_date(ds3231_date_t *date){
+static void decode_datetime(const uint8_t *registers, ds3231_time_t *time, ds3231_date_t *date){
 
-	uint8_t data_to_read[4], year;
-	uint16_t century;
-	i2c_read_bytes(DS3231_ADDRESS, DS3231_DAY_REF_ADDR, data_to_read, sizeof(data_to_read));
+	uint8_t binary[DATETIME_REG_COUNT];
 
-	date->dow = bcd_to_decimal_conversion(data_to_read[0]);
-	date->date = bcd_to_decimal_conversion(data_to_read[1]);
-	date->month = bcd_to_decimal_conversion(data_to_read[2]);
-	year = bcd_to_decimal_conversion(data_to_read[3]);
-	century = (data_to_read[2] >> CENTURY_BIT_IN_MONTH_REG )*CENTURY_FACTOR + CURRENT_CENTURY_OFFSET; // calculating the century
-	date->month = date->month & EXTRACTING_SEVEN_BIT_MASK;  // removing the century bit from month register
-	date->year = century + year;
+	bcd_decode(registers, datetime_digit_masks, binary, DATETIME_REG_COUNT);
+
+	if (time != NULL) {
+		time->sec = binary[0];
+		time->min = binary[1];
+		time->hour = binary[2];
+	}
+
+	if (date != NULL) {
+		date->dow = binary[3];
+		date->date = binary[4];
+		date->month = binary[5];
+		date->year = CURRENT_CENTURY_OFFSET + binary[6]
+				+ (registers[DS3231_MONTH_REG_ADDR] >> CENTURY_BIT_IN_MONTH_REG) * CENTURY_FACTOR;
+	}
 
 }
 
 /*
- * Description: It reads the control status back using i2c from the RTC DS3231 and converts them back into decimal form
+ * Description: It reads the control status register back using i2c from the RTC DS3231. The register is a
+ *              set of flags so it is returned as read, OSF is bit 7.
  *
  * Parameters:
- *    		ds3231_time_t a pointer which contains the read data from the RTC
+ *    		uint8_t a pointer which contains the read data from the RTC
  *
  * Returns:
  *   		NULL
  */
 void ds3231_error_status(uint8_t *status){
 
-	i2c_read_bytes(DS3231_ADDRESS, DS3231_CONTROL_STATUS, status, 1);
-	*status = bcd_to_decimal_conversion(*status);
+	ds3231_shadow_lock();
+	ds3231_shadow_read(DS3231_CONTROL_STATUS, status, 1);
+	ds3231_shadow_unlock();
+
+}
+
+
+/*
+ * Description: reads the whole register map, 0x00 to 0x12, in one burst and decodes the time, date,
+ *              control, status, aging offset and temperature of the same instant. The DS3231 copies the
+ *              time keeping registers to its read buffers on the start condition, so time and date
+ *              can not be torn by a second rolling over during the read.
+ *
+ * Parameters:
+ *    		ds3231_snapshot_t a pointer which is filled with the decoded registers
+ *
+ * Returns:
+ *   		i2c_status_t the result of the read, the snapshot is only filled when it is I2C_STATUS_OK
+ */
+i2c_status_t ds3231_read_snapshot(ds3231_snapshot_t *snapshot){
+
+	uint8_t registers[DS3231_REGISTER_COUNT];
+	i2c_status_t status;
+
+	ds3231_shadow_lock();
+	status = ds3231_shadow_read(DS3231_SEC_REG_ADDR, registers, sizeof(registers));
+	if (status != I2C_STATUS_OK) {
+		ds3231_shadow_unlock();
+		return status;
+	}
+
+	decode_datetime(registers, &snapshot->time, &snapshot->date);
+	snapshot->control = registers[DS3231_CONTROL_REG_ADDR];
+	ds3231_shadow_refresh(DS3231_CONTROL_REG_ADDR, snapshot->control & ~CONTROL_CONV_BIT);   // cleared by the device
+	snapshot->status = registers[DS3231_CONTROL_STATUS];
+	snapshot->aging_offset = (int8_t) registers[DS3231_AGING_REG_ADDR];
+	snapshot->temperature_quarter_c = (int16_t) (((int8_t) registers[DS3231_TEMP_MSB_REG_ADDR]) * 4
+			+ (registers[DS3231_TEMP_LSB_REG_ADDR] >> TEMP_FRACTION_SHIFT));
+	if (!temperature_cache.conversion_pending)
+		store_temperature(&registers[DS3231_TEMP_MSB_REG_ADDR]);
+	ds3231_shadow_unlock();
+
+	return I2C_STATUS_OK;
 
 }
 
@@ -232,3 +402,354 @@ char *ds3231_get_day_of_week(uint8_t dow){
 
 	return NULL;
 }
+
+
+/*
+ * Description: routes the square wave to the INT/SQW pin at the given rate by clearing INTCN and setting
+ *              RS2:RS1 in the control register, the other control bits are kept. The control register
+ *              is read from the shadow when it is valid there. At 1 Hz the falling edge
+ *              comes with the update of the seconds register, the output is open drain and needs a pull-up.
+ *
+ * Parameters:
+ *    		ds3231_sqw_rate_t the frequency of the square wave
+ *
+ * Returns:
+ *   		i2c_status_t the result of the read or the write of the control register
+ */
+i2c_status_t ds3231_set_square_wave(ds3231_sqw_rate_t rate){
+
+	uint8_t control;
+	i2c_status_t status;
+
+	ds3231_shadow_lock();
+	status = ds3231_shadow_read(DS3231_CONTROL_REG_ADDR, &control, 1);
+	if (status == I2C_STATUS_OK) {
+		control &= ~(CONTROL_INTCN_BIT | CONTROL_RS_MASK);
+		control |= (rate << CONTROL_RS_SHIFT) & CONTROL_RS_MASK;
+
+		ds3231_shadow_write(DS3231_CONTROL_REG_ADDR, &control, 1);
+		status = ds3231_shadow_commit();
+	}
+	ds3231_shadow_unlock();
+
+	return status;
+
+}
+
+
+/*
+ * Description: programs alarm 1 to match the date of the month, hours, minutes and seconds, all the mask
+ *              bits are cleared so the alarm flag is set once when the time keeping registers reach it
+ *
+ * Parameters:
+ *    		const ds3231_time_t * time of the alarm
+ *    		uint8_t date of the month of the alarm
+ *
+ * Returns:
+ *   		i2c_status_t the result of the write
+ */
+i2c_status_t ds3231_set_alarm1(const ds3231_time_t *time, uint8_t date){
+
+	uint8_t data_to_send[DATETIME_REG_COUNT];
+	i2c_status_t status;
+
+	encode_datetime(time, NULL, data_to_send);
+	data_to_send[3] = bcd_from_binary(date);                  // DY/DT cleared, matches the date
+	ds3231_shadow_lock();
+	ds3231_shadow_write(DS3231_ALARM1_REG_ADDR, data_to_send, ALARM1_REG_COUNT);
+	status = ds3231_shadow_commit();
+	ds3231_shadow_unlock();
+
+	return status;
+
+}
+
+
+/*
+ * Description: lets alarm 1 pull the INT/SQW pin low by setting INTCN and A1IE, or clears A1IE. The square
+ *              wave is stopped while INTCN is set, ds3231_set_square_wave clears it again.
+ *
+ * Parameters:
+ *    		bool true to enable the interrupt
+ *
+ * Returns:
+ *   		i2c_status_t the result of the read or the write of the control register
+ */
+i2c_status_t ds3231_enable_alarm1_interrupt(bool enable){
+
+	uint8_t control;
+	i2c_status_t status;
+
+	ds3231_shadow_lock();
+	status = ds3231_shadow_read(DS3231_CONTROL_REG_ADDR, &control, 1);
+	if (status == I2C_STATUS_OK) {
+		if (enable)
+			control |= CONTROL_INTCN_BIT | CONTROL_A1IE_BIT;
+		else
+			control &= ~CONTROL_A1IE_BIT;
+
+		ds3231_shadow_write(DS3231_CONTROL_REG_ADDR, &control, 1);
+		status = ds3231_shadow_commit();
+	}
+	ds3231_shadow_unlock();
+
+	return status;
+
+}
+
+
+/*
+ * Description: clears the alarm 1 flag, which releases the INT/SQW pin. The status register is read first
+ *              and written back with only A1F changed, OSF and A2F are written as 1 which leaves them as
+ *              they are.
+ *
+ * Parameters:
+ *    		None
+ *
+ * Returns:
+ *   		i2c_status_t the result of the read or the write of the status register
+ */
+i2c_status_t ds3231_clear_alarm1_flag(void){
+
+	uint8_t status;
+	i2c_status_t result;
+
+	ds3231_shadow_lock();
+	result = ds3231_shadow_read(DS3231_CONTROL_STATUS, &status, 1);
+	if (result == I2C_STATUS_OK) {
+		status = (status | DS3231_STATUS_OSF | STATUS_ALARM_FLAGS) & ~DS3231_STATUS_A1F;
+		ds3231_shadow_write(DS3231_CONTROL_STATUS, &status, 1);
+		result = ds3231_shadow_commit();
+	}
+	ds3231_shadow_unlock();
+
+	return result;
+
+}
+
+
+/*
+ * Description: switches the 32.768 kHz output of the DS3231 on or off (EN32kHz). The output is open drain and
+ *              on at power up. OSF and the alarm flags are written as 1 which leaves them as they are.
+ *
+ * Parameters:
+ *    		bool true to enable the output
+ *
+ * Returns:
+ *   		i2c_status_t the result of the read or the write of the status register
+ */
+i2c_status_t ds3231_set_32khz_output(bool enable){
+
+	uint8_t status;
+	i2c_status_t result;
+
+	ds3231_shadow_lock();
+	result = ds3231_shadow_read(DS3231_CONTROL_STATUS, &status, 1);
+	if (result == I2C_STATUS_OK) {
+		status |= DS3231_STATUS_OSF | STATUS_ALARM_FLAGS;
+		if (enable)
+			status |= STATUS_EN32KHZ;
+		else
+			status &= ~STATUS_EN32KHZ;
+		ds3231_shadow_write(DS3231_CONTROL_STATUS, &status, 1);
+		result = ds3231_shadow_commit();
+	}
+	ds3231_shadow_unlock();
+
+	return result;
+
+}
+
+
+/*
+ * Description: sets the clock used to know when the cached temperature is out of date, without a clock the
+ *              temperature is read from the RTC every time. The cached temperature is dropped.
+ *
+ * Parameters:
+ *    		ds3231_clock_t function returning a count of seconds
+ *
+ * Returns:
+ *   		NULL
+ */
+void ds3231_set_clock(ds3231_clock_t clock){
+
+	seconds_clock = clock;
+	temperature_cache.valid = false;            // its time stamp is from the old clock
+
+}
+
+
+/*
+ * Description: keeps the temperature registers read from the RTC as the cached temperature
+ *
+ * Parameters:
+ *    		const uint8_t * the temperature MSB and LSB registers
+ *
+ * Returns:
+ *   		NULL
+ */
+static void store_temperature(const uint8_t *registers){
+
+	int16_t quarters = (int16_t) (((int8_t) registers[0]) * 4 + (registers[1] >> TEMP_FRACTION_SHIFT));
+
+	temperature_cache.centi_celsius = quarters * CENTI_PER_QUARTER_DEGREE;
+	temperature_cache.read_at = seconds_clock != NULL ? seconds_clock() : 0;
+	temperature_cache.valid = true;
+
+}
+
+
+/*
+ * Description: returns the die temperature of the RTC. The value is kept for DS3231_TEMP_CONVERSION_PERIOD_S
+ *              after it was read, a snapshot read refreshes it for free. While a conversion started with
+ *              ds3231_force_conversion runs, each call checks CONV and BSY with one read and returns the
+ *              cached value until the conversion is done, so the caller never waits for it.
+ *
+ * Parameters:
+ *    		int16_t * the temperature in 0.01 degree C
+ *
+ * Returns:
+ *   		i2c_status_t the result of the read, I2C_STATUS_OK when the cached value was used
+ */
+i2c_status_t ds3231_read_temperature(int16_t *centi_celsius){
+
+	uint8_t registers[DS3231_TEMP_LSB_REG_ADDR - DS3231_CONTROL_REG_ADDR + 1];
+	i2c_status_t status = I2C_STATUS_OK;
+
+	ds3231_shadow_lock();                       // the cache is shared with ds3231_force_conversion
+	if (temperature_cache.conversion_pending) {
+		status = ds3231_shadow_read(DS3231_CONTROL_REG_ADDR, registers, sizeof(registers));
+		if (status == I2C_STATUS_OK) {
+			ds3231_shadow_refresh(DS3231_CONTROL_REG_ADDR, registers[0] & ~CONTROL_CONV_BIT);
+			if (!(registers[0] & CONTROL_CONV_BIT) && !(registers[1] & STATUS_BSY)) {
+				temperature_cache.conversion_pending = false;
+				store_temperature(&registers[DS3231_TEMP_MSB_REG_ADDR - DS3231_CONTROL_REG_ADDR]);
+			}
+		}
+	} else if (!temperature_cache.valid || seconds_clock == NULL
+			|| seconds_clock() - temperature_cache.read_at >= DS3231_TEMP_CONVERSION_PERIOD_S) {
+		status = ds3231_shadow_read(DS3231_TEMP_MSB_REG_ADDR, registers, TEMP_REG_COUNT);
+		if (status == I2C_STATUS_OK)
+			store_temperature(registers);
+	}
+
+	if (status == I2C_STATUS_OK)
+		*centi_celsius = temperature_cache.centi_celsius;
+	ds3231_shadow_unlock();
+
+	return status;
+
+}
+
+
+/*
+ * Description: starts a temperature conversion by setting CONV in the control register and returns at once,
+ *              ds3231_read_temperature gives the new value when the conversion is done. Nothing is started
+ *              while the device runs its own conversion (BSY), the new value then comes with that conversion.
+ *
+ * Parameters:
+ *    		bool * set to false when BSY was set and no conversion was started, NULL when it is not needed
+ *
+ * Returns:
+ *   		i2c_status_t the result of the reads and the write, I2C_STATUS_OK when BSY was set
+ */
+i2c_status_t ds3231_force_conversion(bool *started){
+
+	i2c_status_t status;
+
+	ds3231_shadow_lock();
+	status = start_conversion(started);
+	ds3231_shadow_unlock();
+
+	return status;
+
+}
+
+
+/*
+ * Description: sets CONV in the control register unless BSY is set, the caller holds the shadow lock
+ *
+ * Parameters:
+ *    		bool * set to true when CONV was written, NULL when it is not needed
+ *
+ * Returns:
+ *   		i2c_status_t the result of the reads and the write, I2C_STATUS_OK when BSY was set
+ */
+static i2c_status_t start_conversion(bool *started){
+
+	uint8_t registers[2];                       // control and status
+	i2c_status_t status;
+
+	if (started != NULL)
+		*started = false;
+	status = ds3231_shadow_read(DS3231_CONTROL_REG_ADDR, registers, sizeof(registers));
+	if (status != I2C_STATUS_OK || (registers[1] & STATUS_BSY))
+		return status;
+
+	registers[0] |= CONTROL_CONV_BIT;
+	ds3231_shadow_write(DS3231_CONTROL_REG_ADDR, &registers[0], 1);
+	status = ds3231_shadow_commit();
+	ds3231_shadow_refresh(DS3231_CONTROL_REG_ADDR, registers[0] & ~CONTROL_CONV_BIT);   // cleared by the device
+	if (status == I2C_STATUS_OK) {
+		temperature_cache.conversion_pending = true;
+		if (started != NULL)
+			*started = true;
+	}
+
+	return status;
+
+}
+
+
+/*
+ * Description: reads the aging offset register, it comes from the register copy once it was read
+ *
+ * Parameters:
+ *    		int8_t * the offset, positive values slow the oscillator down by about 0.1 ppm per step
+ *
+ * Returns:
+ *   		i2c_status_t the result of the read
+ */
+i2c_status_t ds3231_read_aging_offset(int8_t *offset){
+
+	uint8_t aging;
+	i2c_status_t status;
+
+	ds3231_shadow_lock();
+	status = ds3231_shadow_read(DS3231_AGING_REG_ADDR, &aging, 1);
+	ds3231_shadow_unlock();
+	if (status == I2C_STATUS_OK)
+		*offset = (int8_t) aging;
+
+	return status;
+
+}
+
+
+/*
+ * Description: writes the aging offset register and starts a temperature conversion, the DS3231 only applies
+ *              the new offset to the oscillator at the end of a conversion. When the device is already
+ *              converting the offset is applied at the end of the next conversion, at most 64 s later.
+ *
+ * Parameters:
+ *    		int8_t the offset, positive values slow the oscillator down by about 0.1 ppm per step
+ *
+ * Returns:
+ *   		i2c_status_t the first error of the write and the start of the conversion, I2C_STATUS_OK when
+ *   		the device was already converting
+ */
+i2c_status_t ds3231_set_aging_offset(int8_t offset){
+
+	uint8_t aging = (uint8_t) offset;
+	i2c_status_t status;
+
+	ds3231_shadow_lock();
+	ds3231_shadow_write(DS3231_AGING_REG_ADDR, &aging, 1);
+	status = ds3231_shadow_commit();
+	if (status == I2C_STATUS_OK)
+		status = start_conversion(NULL);
+	ds3231_shadow_unlock();
+
+	return status;
+
+}
@@ -21,8 +21,19 @@
 #define DS3231_H_
 
 #include "stdint.h"
+#include "stdbool.h"
+#include "i2c.h"
 
 #define DS3231_ADDRESS 0x68
+#define DS3231_MAX_SCL_HZ 400000      // fast mode
+#define DS3231_REGISTER_COUNT 0x13    // seconds (0x00) to temperature LSB (0x12)
+#define DS3231_STATUS_OSF 0x80        // oscillator was stopped, time not valid
+#define DS3231_STATUS_A1F 0x01        // alarm 1 matched
+#define DS3231_TEMP_CONVERSION_PERIOD_S 64    // the DS3231 measures its temperature every 64 s
+#define DS3231_AGING_PPB_PER_LSB 100  // typical frequency change of one aging offset step at 25 degree C
+
+/* returns a count of seconds, used to know when the temperature has to be read again */
+typedef uint32_t (*ds3231_clock_t)(void);
 
 typedef struct {
 	uint8_t sec;
@@ -37,13 +48,44 @@ typedef struct {
 	uint16_t year;
 }ds3231_date_t;
 
+/* frequency of the INT/SQW output, the RS2:RS1 field of the control register */
+typedef enum {
+	DS3231_SQW_1HZ,
+	DS3231_SQW_1024HZ,
+	DS3231_SQW_4096HZ,
+	DS3231_SQW_8192HZ
+}ds3231_sqw_rate_t;
+
+/* every register decoded from one burst read, time and date belong to the same second */
+typedef struct {
+	ds3231_time_t time;
+	ds3231_date_t date;
+	uint8_t control;
+	uint8_t status;
+	int8_t aging_offset;
+	int16_t temperature_quarter_c;    // temperature in 0.25 degree C steps
+}ds3231_snapshot_t;
+
 
 void ds3231_set_time(ds3231_time_t *time);
 void ds3231_read_time(ds3231_time_t *time);
 void ds3231_set_date(ds3231_date_t *date);
 void ds3231_read_date(ds3231_date_t *date);
+i2c_status_t ds3231_read_datetime(ds3231_time_t *time, ds3231_date_t *date);
 char *ds3231_get_day_of_week(uint8_t dow);
 void ds3231_error_status(uint8_t *status);
+i2c_status_t ds3231_read_snapshot(ds3231_snapshot_t *snapshot);
+i2c_status_t ds3231_set_datetime(const ds3231_time_t *time, const ds3231_date_t *date);
+i2c_status_t ds3231_set_square_wave(ds3231_sqw_rate_t rate);
+i2c_status_t ds3231_set_alarm1(const ds3231_time_t *time, uint8_t date);
+i2c_status_t ds3231_enable_alarm1_interrupt(bool enable);
+i2c_status_t ds3231_clear_alarm1_flag(void);
+i2c_status_t ds3231_set_32khz_output(bool enable);
+void ds3231_set_clock(ds3231_clock_t clock);
+i2c_status_t ds3231_read_temperature(int16_t *centi_celsius);
+i2c_status_t ds3231_force_conversion(bool *started);
+i2c_status_t ds3231_read_aging_offset(int8_t *offset);
+i2c_status_t ds3231_set_aging_offset(int8_t offset);
 
 
 
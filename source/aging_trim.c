@@ -0,0 +1,188 @@
+/*******************************************************************************
+ * Copyright (C) 2023 by PRANJAL GUPTA
+ *
+ * Redistribution, modification or use of this software in source or binary
+ * forms is permitted as long as the files maintain this copyright. Users are
+ * permitted to modify this and use it to learn about the field of embedded
+ * software. PRANJAL GUPTA and the University of Colorado are not liable for
+ * any misuse of this material.
+ * ****************************************************************************/
+
+/**
+ * @file    aging_trim.c
+ * @brief   This file contains the frequency error fit of the DS3231 against a reference clock. Every sample
+ *          is the RTC time taken at the time a reference time stamp was received, the slope of the least
+ *          squares line through the time error is the frequency error of the RTC. A long window averages
+ *          out the jitter of the reference link, the error is then turned into a change of the aging
+ *          offset register. It has no RTOS dependency and is built on the host too.
+ *
+ * @author  Pranjal Gupta
+ * @date    12/24/2023
+ *
+ */
+#include "aging_trim.h"
+#include "DS3231.h"
+
+static void start_fit(aging_trim_fit_t *fit, int64_t reference_ms, int64_t rtc_ms);
+
+#define MS_PER_S 1000.0
+#define US_PER_MS 1000.0
+#define PPB_PER_PPM 1000.0
+#define AGING_OFFSET_MIN (-128)
+#define AGING_OFFSET_MAX 127
+
+/*
+ * Description: empties the fit
+ * Parameters:
+ * 		aging_trim_fit_t * the fit
+ * Returns:
+ *   		None
+ */
+
+void aging_trim_reset(aging_trim_fit_t *fit) {
+
+	*fit = (aging_trim_fit_t) { 0 };
+}
+
+/*
+ * Description: starts the fit again from one sample, the restart count is kept
+ * Parameters:
+ * 		aging_trim_fit_t * the fit
+ * 		int64_t reference time of the sample in ms
+ * 		int64_t RTC time of the sample in ms
+ * Returns:
+ *   		None
+ */
+
+static void start_fit(aging_trim_fit_t *fit, int64_t reference_ms, int64_t rtc_ms) {
+
+	uint32_t restarts = fit->restarts;
+
+	aging_trim_reset(fit);
+	fit->restarts = restarts;
+	fit->samples = 1;
+	fit->first_reference_ms = reference_ms;
+	fit->first_offset_ms = rtc_ms - reference_ms;
+}
+
+/*
+ * Description: adds one sample to the fit. A sample far off the line fitted so far means the RTC time was
+ *              set or the reference jumped, the fit is then started again from this sample.
+ * Parameters:
+ * 		aging_trim_fit_t * the fit
+ * 		int64_t reference time in ms, any epoch
+ * 		int64_t RTC time at the same instant in ms, any epoch
+ * Returns:
+ *   		bool false when the sample started a new fit or was older than the last one
+ */
+
+bool aging_trim_add_sample(aging_trim_fit_t *fit, int64_t reference_ms, int64_t rtc_ms) {
+
+	double x, y, dx, residual, predicted;
+
+	if (fit->samples == 0) {
+		start_fit(fit, reference_ms, rtc_ms);
+		return true;
+	}
+
+	x = (reference_ms - fit->first_reference_ms) / MS_PER_S;
+	y = (rtc_ms - reference_ms - fit->first_offset_ms) * US_PER_MS;
+	if (x <= fit->last_x)
+		return false;
+
+	predicted = fit->mean_y;
+	if (fit->m2_x > 0)
+		predicted += fit->c_xy / fit->m2_x * (x - fit->mean_x);
+	residual = y - predicted;
+	if (residual > AGING_TRIM_MAX_RESIDUAL_MS * US_PER_MS || residual < -AGING_TRIM_MAX_RESIDUAL_MS * US_PER_MS) {
+		fit->restarts++;
+		start_fit(fit, reference_ms, rtc_ms);
+		return false;
+	}
+
+	fit->samples++;
+	dx = x - fit->mean_x;
+	fit->mean_x += dx / fit->samples;
+	fit->mean_y += (y - fit->mean_y) / fit->samples;
+	fit->m2_x += dx * (x - fit->mean_x);
+	fit->c_xy += dx * (y - fit->mean_y);
+	fit->last_x = x;
+	return true;
+}
+
+/*
+ * Description: gives the frequency error of the RTC once the samples span AGING_TRIM_WINDOW_S
+ * Parameters:
+ * 		const aging_trim_fit_t * the fit
+ * 		int32_t * the error in ppb, positive when the RTC runs fast
+ * Returns:
+ *   		bool false while the window is too short
+ */
+
+bool aging_trim_estimate(const aging_trim_fit_t *fit, int32_t *error_ppb) {
+
+	double ppb;
+
+	if (fit->samples < AGING_TRIM_MIN_SAMPLES || fit->last_x < AGING_TRIM_WINDOW_S || fit->m2_x <= 0)
+		return false;
+
+	ppb = fit->c_xy / fit->m2_x * PPB_PER_PPM;
+	*error_ppb = (int32_t) (ppb < 0 ? ppb - 0.5 : ppb + 0.5);
+	return true;
+}
+
+/*
+ * Description: works out the aging offset which cancels a frequency error, a positive offset slows the
+ *              oscillator down. Errors inside AGING_TRIM_DEADBAND_PPB give the same offset.
+ * Parameters:
+ * 		int8_t the offset the error was measured with
+ * 		int32_t the error in ppb, positive when the RTC runs fast
+ * Returns:
+ *   		int8_t the new offset, limited to the range of the register
+ */
+
+int8_t aging_trim_offset(int8_t offset, int32_t error_ppb) {
+
+	int32_t steps, trimmed;
+
+	if (error_ppb > -AGING_TRIM_DEADBAND_PPB && error_ppb < AGING_TRIM_DEADBAND_PPB)
+		return offset;
+
+	if (error_ppb < 0)
+		steps = -((-error_ppb + DS3231_AGING_PPB_PER_LSB / 2) / DS3231_AGING_PPB_PER_LSB);
+	else
+		steps = (error_ppb + DS3231_AGING_PPB_PER_LSB / 2) / DS3231_AGING_PPB_PER_LSB;
+
+	trimmed = offset + steps;
+	if (trimmed < AGING_OFFSET_MIN)
+		trimmed = AGING_OFFSET_MIN;
+	if (trimmed > AGING_OFFSET_MAX)
+		trimmed = AGING_OFFSET_MAX;
+	return (int8_t) trimmed;
+}
+
+/*
+ * Description: corrects the aging offset of the DS3231 for a measured frequency error, nothing is written
+ *              when the offset stays the same
+ * Parameters:
+ * 		int32_t the error in ppb measured with the current offset, positive when the RTC runs fast
+ * 		int8_t * the offset in use afterwards
+ * Returns:
+ *   		i2c_status_t the result of the read and the write
+ */
+
+i2c_status_t aging_trim_apply(int32_t error_ppb, int8_t *offset) {
+
+	int8_t current;
+	i2c_status_t status;
+
+	status = ds3231_read_aging_offset(&current);
+	if (status != I2C_STATUS_OK)
+		return status;
+
+	*offset = aging_trim_offset(current, error_ppb);
+	if (*offset == current)
+		return I2C_STATUS_OK;
+
+	return ds3231_set_aging_offset(*offset);
+}
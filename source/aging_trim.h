@@ -0,0 +1,74 @@
+/*******************************************************************************
+ * Copyright (C) 2023 by PRANJAL GUPTA
+ *
+ * Redistribution, modification or use of this software in source or binary
+ * forms is permitted as long as the files maintain this copyright. Users are
+ * permitted to modify this and use it to learn about the field of embedded
+ * software. PRANJAL GUPTA and the University of Colorado are not liable for
+ * any misuse of this material.
+ * ****************************************************************************/
+
+/**
+ * @file    aging_trim.h
+ * @brief   This file has the function prototypes of the frequency error fit of the DS3231 against a reference
+ *          clock and of the aging offset trim computed from it.
+ *
+ * @author  Pranjal Gupta
+ * @date    12/24/2023
+ *
+ */
+
+#ifndef AGING_TRIM_H_
+#define AGING_TRIM_H_
+
+#include "stdint.h"
+#include "stdbool.h"
+#include "i2c.h"
+
+/*
+ * Shortest span of reference samples a frequency error is given for. With a few ms of jitter on the
+ * reference and one sample a minute the error of the fit is below one aging offset step after 4 hours.
+ */
+#ifndef AGING_TRIM_WINDOW_S
+#define AGING_TRIM_WINDOW_S (4 * 3600)
+#endif
+
+#define AGING_TRIM_MIN_SAMPLES 16
+
+/*
+ * Errors smaller than this leave the offset as it is. Rounding alone would let the fit noise toggle the
+ * offset by one step around the best value from window to window.
+ */
+#ifndef AGING_TRIM_DEADBAND_PPB
+#define AGING_TRIM_DEADBAND_PPB 100
+#endif
+
+/* a sample this far off the fitted line means the RTC time was set, the fit starts again from it */
+#ifndef AGING_TRIM_MAX_RESIDUAL_MS
+#define AGING_TRIM_MAX_RESIDUAL_MS 250
+#endif
+
+/*
+ * Least squares line through the RTC time error against the reference time, kept as running means and
+ * sums of squares so no sample is stored. x is the reference time in s since the first sample, y the
+ * RTC time error in us since the first sample, the slope in us/s is the frequency error in ppm.
+ */
+typedef struct {
+	uint32_t samples;
+	uint32_t restarts;           // fits dropped because the RTC time jumped
+	int64_t first_reference_ms;
+	int64_t first_offset_ms;     // RTC time minus reference time of the first sample
+	double mean_x;
+	double mean_y;
+	double m2_x;                 // sum of the squared x deviations
+	double c_xy;                 // sum of the x deviation times the y deviation
+	double last_x;
+} aging_trim_fit_t;
+
+void aging_trim_reset(aging_trim_fit_t *fit);
+bool aging_trim_add_sample(aging_trim_fit_t *fit, int64_t reference_ms, int64_t rtc_ms);
+bool aging_trim_estimate(const aging_trim_fit_t *fit, int32_t *error_ppb);
+int8_t aging_trim_offset(int8_t offset, int32_t error_ppb);
+i2c_status_t aging_trim_apply(int32_t error_ppb, int8_t *offset);
+
+#endif /* AGING_TRIM_H_ */
@@ -0,0 +1,94 @@
+/*******************************************************************************
+ * Copyright (C) 2023 by PRANJAL GUPTA
+ *
+ * Redistribution, modification or use of this software in source or binary
+ * forms is permitted as long as the files maintain this copyright. Users are
+ * permitted to modify this and use it to learn about the field of embedded
+ * software. PRANJAL GUPTA and the University of Colorado are not liable for
+ * any misuse of this material.
+ * ****************************************************************************/
+
+/**
+ * @file    bcd.c
+ * @brief   This file contains the packed BCD codec of the DS3231 registers without divisions, the Cortex-M0+
+ *          has no divide instruction and every / or % by 10 or 16 is a call to the library divide. A BCD
+ *          byte is 16 * tens + units and the binary value 10 * tens + units, so decoding takes 6 * tens
+ *          off the byte and encoding adds it. The tens of a value up to 99 are (value * 205) >> 11, exact
+ *          up to 1028, one multiply and one shift on the single cycle multiplier.
+ *
+ * @author  Pranjal Gupta
+ * @date    12/26/2023
+ *
+ */
+#include "bcd.h"
+
+#define BCD_TENS_SHIFT 4
+#define BCD_TENS_GAP 6                    // 16 - 10 per tens digit
+#define DIV10_MULTIPLIER 205              // 2^11 / 10 rounded up
+#define DIV10_SHIFT 11
+
+/*
+ * Description: converts one packed BCD byte into binary
+ * Parameters:
+ * 		uint8_t the BCD byte, both digits 0 to 9
+ * Returns:
+ *   		uint8_t the value 0 to 99
+ */
+
+uint8_t bcd_to_binary(uint8_t bcd) {
+	return (uint8_t) (bcd - (bcd >> BCD_TENS_SHIFT) * BCD_TENS_GAP);
+}
+
+/*
+ * Description: converts a binary value into one packed BCD byte
+ * Parameters:
+ * 		uint8_t the value 0 to 99
+ * Returns:
+ *   		uint8_t the BCD byte
+ */
+
+uint8_t bcd_from_binary(uint8_t binary) {
+	return (uint8_t) (binary + ((binary * DIV10_MULTIPLIER) >> DIV10_SHIFT) * BCD_TENS_GAP);
+}
+
+/*
+ * Description: converts a run of BCD registers into binary in one pass, the bits which are not part of
+ *              the number (century, 12/24 hour mode, alarm mask bits) are taken off with a mask per register
+ * Parameters:
+ * 		const uint8_t * the registers
+ * 		const uint8_t * the mask of the BCD digits of every register
+ * 		uint8_t * the binary values
+ * 		uint8_t number of registers
+ * Returns:
+ *   		None
+ */
+
+void bcd_decode(const uint8_t *bcd, const uint8_t *masks, uint8_t *binary, uint8_t count) {
+
+	uint8_t value;
+
+	for (uint8_t i = 0; i < count; i++) {
+		value = bcd[i] & masks[i];
+		binary[i] = (uint8_t) (value - (value >> BCD_TENS_SHIFT) * BCD_TENS_GAP);
+	}
+}
+
+/*
+ * Description: converts a run of binary values into BCD registers in one pass
+ * Parameters:
+ * 		const uint8_t * the values, 0 to 99 each
+ * 		uint8_t * the registers
+ * 		uint8_t number of registers
+ * Returns:
+ *   		None
+ */
+
+void bcd_encode(const uint8_t *binary, uint8_t *bcd, uint8_t count) {
+
+	uint8_t value;
+
+	for (uint8_t i = 0; i < count; i++) {
+		value = binary[i];
+		bcd[i] = (uint8_t) (value + ((value * DIV10_MULTIPLIER) >> DIV10_SHIFT) * BCD_TENS_GAP);
+	}
+}
@@ -0,0 +1,30 @@
+/*******************************************************************************
+ * Copyright (C) 2023 by PRANJAL GUPTA
+ *
+ * Redistribution, modification or use of this software in source or binary
+ * forms is permitted as long as the files maintain this copyright. Users are
+ * permitted to modify this and use it to learn about the field of embedded
+ * software. PRANJAL GUPTA and the University of Colorado are not liable for
+ * any misuse of this material.
+ * ****************************************************************************/
+
+/**
+ * @file    bcd.h
+ * @brief   This file has the function prototypes of the packed BCD codec used for the DS3231 registers.
+ *
+ * @author  Pranjal Gupta
+ * @date    12/26/2023
+ *
+ */
+
+#ifndef BCD_H_
+#define BCD_H_
+
+#include "stdint.h"
+
+uint8_t bcd_to_binary(uint8_t bcd);
+uint8_t bcd_from_binary(uint8_t binary);
+void bcd_decode(const uint8_t *bcd, const uint8_t *masks, uint8_t *binary, uint8_t count);
+void bcd_encode(const uint8_t *binary, uint8_t *bcd, uint8_t count);
+
+#endif /* BCD_H_ */
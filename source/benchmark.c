@@ -0,0 +1,253 @@
+/*******************************************************************************
+ * Copyright (C) 2023 by PRANJAL GUPTA
+ *
+ * Redistribution, modification or use of this software in source or binary
+ * forms is permitted as long as the files maintain this copyright. Users are
+ * permitted to modify this and use it to learn about the field of embedded
+ * software. PRANJAL GUPTA and the University of Colorado are not liable for
+ * any misuse of this material.
+ * ****************************************************************************/
+
+/**
+ * @file    benchmark.c
+ * @brief   This file contains the on target cycle count measurements, the results are printed on the
+ *          debug console. Build with CPU_PROFILE_ENABLE=1 to include them.
+ *
+ * @author  Pranjal Gupta
+ * @date    12/14/2023
+ *
+ */
+#include "benchmark.h"
+
+#if CPU_PROFILE_ENABLE
+
+#include "cycle_counter.h"
+#include "i2c.h"
+#include "i2c_scheduler.h"
+#include "oled_driver.h"
+#include "bcd.h"
+#include "fsl_debug_console.h"
+
+#define BENCH_DISPLAY_FRAMES 32
+#define BENCH_TRANSACTIONS 200
+#define OLED_COMMAND_BYTE 0x00
+#define BENCH_BCD_PASSES 1000
+#define BENCH_BCD_REGISTERS 7
+
+static uint32_t frame_count = 0;
+static uint32_t window_start_cycles;
+static uint32_t window_start_run_time;
+
+/* seconds to year registers of 23:59:59 Saturday 31/12/2099, read back from RAM on every pass */
+static volatile uint8_t bench_registers[BENCH_BCD_REGISTERS] = { 0x59, 0x59, 0x23, 0x06, 0x31, 0x12, 0x99 };
+static const uint8_t bench_masks[BENCH_BCD_REGISTERS] = { 0x7F, 0x7F, 0x3F, 0x07, 0x3F, 0x1F, 0xFF };
+static volatile uint32_t bench_sink;
+
+/*
+ * Description: returns the run time in cycles the task has spent on the cpu so far
+ * Parameters:
+ * 		TaskHandle_t the task to be looked at
+ * Returns:
+ *   		uint32_t the run time counter of the task
+ */
+
+static uint32_t task_run_time(TaskHandle_t task) {
+	TaskStatus_t task_status;
+
+	vTaskGetInfo(task, &task_status, pdFALSE, eRunning);
+	return task_status.ulRunTimeCounter;
+}
+
+/*
+ * Description: prints the log2 histogram of the i2c transfer durations of every bus with the worst case
+ *              seen so far
+ * Parameters:
+ * 		None
+ * Returns:
+ *   		None
+ */
+
+static void print_latency_histogram(void) {
+
+	i2c_latency_histogram_t histogram;
+
+	for (int bus = 0; bus < I2C_BUS_COUNT; bus++) {
+		i2c_get_latency_histogram(bus, &histogram);
+		PRINTF("i2c%d latency max %u us, %u timeouts, %u recoveries\r\n", bus,
+				(unsigned) histogram.max_us, (unsigned) histogram.timeouts,
+				(unsigned) histogram.recoveries);
+		for (int i = 0; i < I2C_LATENCY_BUCKETS; i++) {
+			if (histogram.bucket[i] != 0)
+				PRINTF("  >= %u us: %u\r\n", (unsigned) (1U << i), (unsigned) histogram.bucket[i]);
+		}
+	}
+}
+
+/*
+ * Description: called by the display task after every refresh. Every BENCH_DISPLAY_FRAMES frames it prints
+ *              the wall clock cycles and the cycles the display task and the i2c bus owner tasks were busy
+ *              on the cpu per frame and the i2c latency histogram, then
+ *              switches the i2c driver between polled and interrupt mode so both are compared in one run.
+ * Parameters:
+ * 		TaskHandle_t the handle of the display task
+ * Returns:
+ *   		None
+ */
+
+void benchmark_display_frame(TaskHandle_t display_task) {
+
+	uint32_t now = cycle_counter_now();
+	uint32_t run_time = task_run_time(display_task)
+			+ task_run_time(i2c_scheduler_task_handle(I2C_BUS_0))
+			+ task_run_time(i2c_scheduler_task_handle(I2C_BUS_1));
+
+	if (frame_count == 0) {
+		window_start_cycles = now;
+		window_start_run_time = run_time;
+	}
+
+	if (++frame_count <= BENCH_DISPLAY_FRAMES)
+		return;
+
+	PRINTF("display %s: %u wall cycles/frame, %u busy cycles/frame\r\n",
+			i2c_get_transfer_mode() == I2C_MODE_POLLED ? "polled" : "interrupt",
+			(unsigned) ((now - window_start_cycles) / BENCH_DISPLAY_FRAMES),
+			(unsigned) ((run_time - window_start_run_time) / BENCH_DISPLAY_FRAMES));
+	print_latency_histogram();
+
+	i2c_set_transfer_mode(i2c_get_transfer_mode() == I2C_MODE_POLLED ?
+					I2C_MODE_INTERRUPT : I2C_MODE_POLLED);
+	frame_count = 0;
+}
+
+/*
+ * Description: runs back to back two byte display commands and returns the cycles taken per transaction
+ * Parameters:
+ * 		None
+ * Returns:
+ *   		uint32_t cycles per transaction
+ */
+
+static uint32_t bench_small_transactions(void) {
+
+	uint8_t command[2] = { OLED_COMMAND_BYTE, OLED_NORMALDISPLAY };   // harmless to repeat
+	uint32_t start = cycle_counter_now();
+
+	for (int i = 0; i < BENCH_TRANSACTIONS; i++)
+		i2c_scheduler_transmit(I2C_PRIORITY_LOW, OLED_ADDRESS, command, sizeof(command));
+
+	return (cycle_counter_now() - start) / BENCH_TRANSACTIONS;
+}
+
+/*
+ * Description: compares the small transaction throughput with the old fixed delay after every write
+ *              against the stop detection on the bus status bits, results printed on the debug console
+ * Parameters:
+ * 		None
+ * Returns:
+ *   		None
+ */
+
+void benchmark_i2c_transaction_rate(void) {
+
+	uint32_t cycles;
+
+	i2c_set_fixed_delay(true);
+	cycles = bench_small_transactions();
+	PRINTF("i2c fixed delay: %u cycles/transaction, %u transactions/s\r\n",
+			(unsigned) cycles, (unsigned) (configCPU_CLOCK_HZ / cycles));
+
+	i2c_set_fixed_delay(false);
+	cycles = bench_small_transactions();
+	PRINTF("i2c idle detect: %u cycles/transaction, %u transactions/s\r\n",
+			(unsigned) cycles, (unsigned) (configCPU_CLOCK_HZ / cycles));
+}
+
+/*
+ * Description: the BCD to decimal conversion the DS3231 driver used before bcd.c, kept as the reference of
+ *              the codec benchmark
+ * Parameters:
+ * 		uint8_t a bcd number
+ * Returns:
+ *   		uint8_t the decimal number
+ */
+
+static uint8_t divide_bcd_to_decimal(uint8_t bcd_num) {
+	return (uint8_t) ((bcd_num / 16 * 10) + (bcd_num % 16));
+}
+
+/*
+ * Description: the decimal to BCD conversion the DS3231 driver used before bcd.c, kept as the reference of
+ *              the codec benchmark
+ * Parameters:
+ * 		uint8_t a decimal number
+ * Returns:
+ *   		uint8_t the bcd number
+ */
+
+static uint8_t divide_decimal_to_bcd(uint8_t dec_num) {
+	return (uint8_t) ((dec_num / 10 * 16) + (dec_num % 10));
+}
+
+/*
+ * Description: compares the cycles taken to convert the seven time and date registers with the divisions
+ *              of the old conversion functions and with the codec of bcd.c, results printed on the debug
+ *              console. Every pass copies the registers from RAM and sums the results, the same in both.
+ * Parameters:
+ * 		None
+ * Returns:
+ *   		None
+ */
+
+void benchmark_bcd_codec(void) {
+
+	uint8_t registers[BENCH_BCD_REGISTERS], binary[BENCH_BCD_REGISTERS];
+	uint32_t start, divide_cycles, codec_cycles, sum = 0;
+
+	start = cycle_counter_now();
+	for (int pass = 0; pass < BENCH_BCD_PASSES; pass++) {
+		for (int i = 0; i < BENCH_BCD_REGISTERS; i++)
+			binary[i] = divide_bcd_to_decimal(bench_registers[i] & bench_masks[i]);
+		for (int i = 0; i < BENCH_BCD_REGISTERS; i++)
+			sum += binary[i];
+	}
+	divide_cycles = (cycle_counter_now() - start) / BENCH_BCD_PASSES;
+
+	start = cycle_counter_now();
+	for (int pass = 0; pass < BENCH_BCD_PASSES; pass++) {
+		for (int i = 0; i < BENCH_BCD_REGISTERS; i++)
+			registers[i] = bench_registers[i];
+		bcd_decode(registers, bench_masks, binary, BENCH_BCD_REGISTERS);
+		for (int i = 0; i < BENCH_BCD_REGISTERS; i++)
+			sum += binary[i];
+	}
+	codec_cycles = (cycle_counter_now() - start) / BENCH_BCD_PASSES;
+
+	PRINTF("bcd decode of 7 registers: %u cycles with divisions, %u cycles with bcd_decode\r\n",
+			(unsigned) divide_cycles, (unsigned) codec_cycles);
+
+	start = cycle_counter_now();
+	for (int pass = 0; pass < BENCH_BCD_PASSES; pass++) {
+		for (int i = 0; i < BENCH_BCD_REGISTERS; i++)
+			registers[i] = divide_decimal_to_bcd(bench_registers[i] & bench_masks[i]);
+		for (int i = 0; i < BENCH_BCD_REGISTERS; i++)
+			sum += registers[i];
+	}
+	divide_cycles = (cycle_counter_now() - start) / BENCH_BCD_PASSES;
+
+	start = cycle_counter_now();
+	for (int pass = 0; pass < BENCH_BCD_PASSES; pass++) {
+		for (int i = 0; i < BENCH_BCD_REGISTERS; i++)
+			binary[i] = bench_registers[i] & bench_masks[i];
+		bcd_encode(binary, registers, BENCH_BCD_REGISTERS);
+		for (int i = 0; i < BENCH_BCD_REGISTERS; i++)
+			sum += registers[i];
+	}
+	codec_cycles = (cycle_counter_now() - start) / BENCH_BCD_PASSES;
+
+	PRINTF("bcd encode of 7 registers: %u cycles with divisions, %u cycles with bcd_encode\r\n",
+			(unsigned) divide_cycles, (unsigned) codec_cycles);
+	bench_sink = sum;
+}
+
+#endif /* CPU_PROFILE_ENABLE */
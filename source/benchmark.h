@@ -0,0 +1,31 @@
+/*******************************************************************************
+ * Copyright (C) 2023 by PRANJAL GUPTA
+ *
+ * Redistribution, modification or use of this software in source or binary
+ * forms is permitted as long as the files maintain this copyright. Users are
+ * permitted to modify this and use it to learn about the field of embedded
+ * software. PRANJAL GUPTA and the University of Colorado are not liable for
+ * any misuse of this material.
+ * ****************************************************************************/
+
+/**
+ * @file    benchmark.h
+ * @brief   This file has function prototypes for the on target cycle count measurements.
+ *          They are compiled in only when CPU_PROFILE_ENABLE is set to 1.
+ *
+ * @author  Pranjal Gupta
+ * @date    12/14/2023
+ *
+ */
+
+#ifndef BENCHMARK_H_
+#define BENCHMARK_H_
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+void benchmark_display_frame(TaskHandle_t display_task);
+void benchmark_i2c_transaction_rate(void);
+void benchmark_bcd_codec(void);
+
+#endif /* BENCHMARK_H_ */
@@ -0,0 +1,241 @@
+/*******************************************************************************
+ * Copyright (C) 2023 by PRANJAL GUPTA
+ *
+ * Redistribution, modification or use of this software in source or binary
+ * forms is permitted as long as the files maintain this copyright. Users are
+ * permitted to modify this and use it to learn about the field of embedded
+ * software. PRANJAL GUPTA and the University of Colorado are not liable for
+ * any misuse of this material.
+ * ****************************************************************************/
+
+/**
+ * @file    calendar.c
+ * @brief   This file contains the conversion between proleptic Gregorian dates and days since 2000-01-01.
+ *          The year is counted from March so the leap day is the last day of the year and the month lengths
+ *          follow a linear formula. The Cortex-M0+ has no divide instruction, so within the 400 year era
+ *          starting 1600-03-01 every division is a multiply and a shift whose constants are exact over the
+ *          range of their operand (checked by host_bench against libc), only dates outside that era divide.
+ *
+ * @author  Pranjal Gupta
+ * @date    12/21/2023
+ *
+ */
+#include "calendar.h"
+#include "stddef.h"
+
+static uint32_t mod7(uint32_t value);
+
+#define DAYS_PER_ERA 146097              // days in 400 years
+#define ERA_START_YEAR 1600              // the fast era runs from 1600-03-01 to 2400-02-29
+#define ERA_START_TO_EPOCH 146037        // 1600-03-01 to 2000-01-01
+#define EPOCH_DAY_OF_WEEK 6              // 2000-01-01 was a saturday, 0 is sunday
+#define DAY_OF_WEEK_BIAS (7UL << 26)     // keeps the days before 2000 positive, a multiple of 7
+#define ISO_THURSDAY 3                   // days from monday to the thursday deciding the ISO year
+
+/* (153 * mp + 2) / 5, days from March 1st to the first of the month mp counted from March, mp 0 to 11 */
+#define MONTH_START(mp) ((979U * (mp) + 16U) >> 5)
+/* (5 * doy + 2) / 153, month counted from March of the day doy counted from March 1st, doy 0 to 365 */
+#define MONTH_OF(doy) ((2141U * (doy) + 1305U) >> 16)
+
+/*
+ * Description: converts a date into the number of days since 2000-01-01
+ * Parameters:
+ * 		uint16_t year
+ * 		uint8_t month 1 to 12
+ * 		uint8_t day of the month 1 to 31
+ * Returns:
+ *   		int32_t days since 2000-01-01, negative before it
+ */
+
+int32_t calendar_days_from_civil(uint16_t year, uint8_t month, uint8_t day) {
+
+	int32_t y = (int32_t) year - ERA_START_YEAR - (month <= 2);
+	int32_t era = 0;
+	uint32_t year_of_era, day_of_era;
+
+	if ((uint32_t) y >= 400) {                        // outside 1600-03-01 to 2400-02-29
+		era = (y >= 0 ? y : y - 399) / 400;
+		y -= era * 400;
+	}
+
+	year_of_era = (uint32_t) y;
+	day_of_era = year_of_era * 365 + (year_of_era >> 2) - ((year_of_era * 41) >> 12)   // / 100 below 400
+			+ MONTH_START(month > 2 ? month - 3U : month + 9U) + day - 1;
+
+	return era * DAYS_PER_ERA + (int32_t) day_of_era - ERA_START_TO_EPOCH;
+}
+
+/*
+ * Description: converts a number of days since 2000-01-01 into a date. The century of the era and the year
+ *              of the century are worked out from four times the day count, the leap days make the average
+ *              century 36524.25 days and the average year 365.25 days long.
+ * Parameters:
+ * 		int32_t days since 2000-01-01
+ * 		uint16_t * year
+ * 		uint8_t * month 1 to 12
+ * 		uint8_t * day of the month 1 to 31
+ * Returns:
+ *   		None
+ */
+
+void calendar_civil_from_days(int32_t days, uint16_t *year, uint8_t *month, uint8_t *day) {
+
+	int32_t z = days + ERA_START_TO_EPOCH;            // days since 1600-03-01
+	int32_t era = 0;
+	uint32_t century, day_of_century, year_of_century, day_of_year, mp;
+
+	if ((uint32_t) z >= DAYS_PER_ERA) {
+		era = (z >= 0 ? z : z - (DAYS_PER_ERA - 1)) / DAYS_PER_ERA;
+		z -= era * DAYS_PER_ERA;
+	}
+
+	century = ((uint32_t) z * 14699 + 13908) >> 29;                      // (4z + 3) / 146097
+	day_of_century = (4 * (uint32_t) z + 3 - DAYS_PER_ERA * century) >> 2;
+	year_of_century = (day_of_century * 91867 + 69915) >> 25;            // (4n + 3) / 1461
+	day_of_year = day_of_century - ((1461 * year_of_century) >> 2);
+	mp = MONTH_OF(day_of_year);
+
+	*day = (uint8_t) (day_of_year - MONTH_START(mp) + 1);
+	*month = (uint8_t) (mp < 10 ? mp + 3 : mp - 9);
+	*year = (uint16_t) (ERA_START_YEAR + era * 400 + (int32_t) (100 * century + year_of_century) + (*month <= 2));
+}
+
+/*
+ * Description: day of the week of a day
+ * Parameters:
+ * 		int32_t days since 2000-01-01
+ * Returns:
+ *   		uint8_t 0 for sunday to 6 for saturday, the numbering of ds3231_get_day_of_week
+ */
+
+uint8_t calendar_day_of_week(int32_t days) {
+	return (uint8_t) mod7((uint32_t) days + EPOCH_DAY_OF_WEEK + DAY_OF_WEEK_BIAS);
+}
+
+/*
+ * Description: day of the year of a date
+ * Parameters:
+ * 		uint16_t year
+ * 		uint8_t month 1 to 12
+ * 		uint8_t day of the month 1 to 31
+ * Returns:
+ *   		uint16_t 1 for January 1st to 366 for December 31st of a leap year
+ */
+
+uint16_t calendar_day_of_year(uint16_t year, uint8_t month, uint8_t day) {
+	return (uint16_t) (calendar_days_from_civil(year, month, day) - calendar_days_from_civil(year, 1, 1) + 1);
+}
+
+/*
+ * Description: ISO 8601 week of a day. Weeks start on monday and week 1 is the one with the first thursday
+ *              of the year, so the first and last days of a year can belong to the week year before or after.
+ * Parameters:
+ * 		int32_t days since 2000-01-01
+ * 		uint16_t * the week year, NULL if not needed
+ * Returns:
+ *   		uint8_t week 1 to 53
+ */
+
+uint8_t calendar_iso_week(int32_t days, uint16_t *iso_year) {
+
+	uint8_t dow = calendar_day_of_week(days);
+	int32_t thursday = days - (dow == 0 ? 6 : dow - 1) + ISO_THURSDAY;
+	uint16_t year;
+	uint8_t month, day;
+
+	calendar_civil_from_days(thursday, &year, &month, &day);
+	if (iso_year != NULL)
+		*iso_year = year;
+
+	return (uint8_t) ((((uint32_t) (thursday - calendar_days_from_civil(year, 1, 1)) * 293) >> 11) + 1); // / 7
+}
+
+/*
+ * Description: splits seconds since 2000-01-01 into days and the seconds of the day, one 64 bit multiply
+ *              instead of a division by 86400
+ * Parameters:
+ * 		uint32_t seconds since 2000-01-01
+ * 		uint32_t * seconds since midnight, NULL if not needed
+ * Returns:
+ *   		int32_t days since 2000-01-01
+ */
+
+int32_t calendar_days_from_seconds(uint32_t seconds, uint32_t *seconds_of_day) {
+
+	uint32_t days = (uint32_t) (((uint64_t) seconds * 0xC22E4507ULL) >> 48);   // exact for every uint32_t
+
+	if (seconds_of_day != NULL)
+		*seconds_of_day = seconds - days * CALENDAR_SECONDS_PER_DAY;
+	return (int32_t) days;
+}
+
+/*
+ * Description: splits the seconds since midnight into hours, minutes and seconds
+ * Parameters:
+ * 		uint32_t seconds since midnight, below 86400
+ * 		uint8_t * hour 0 to 23
+ * 		uint8_t * minute 0 to 59
+ * 		uint8_t * second 0 to 59
+ * Returns:
+ *   		None
+ */
+
+void calendar_time_of_day(uint32_t seconds_of_day, uint8_t *hour, uint8_t *minute, uint8_t *second) {
+
+	uint32_t h = (seconds_of_day * 37283) >> 27;                 // / 3600
+	uint32_t rest = seconds_of_day - h * 3600;
+	uint32_t m = (rest * 2185) >> 17;                            // / 60
+
+	*hour = (uint8_t) h;
+	*minute = (uint8_t) m;
+	*second = (uint8_t) (rest - m * 60);
+}
+
+/*
+ * Description: converts seconds since 2000-01-01 into Unix time
+ * Parameters:
+ * 		uint32_t seconds since 2000-01-01
+ * Returns:
+ *   		int64_t seconds since 1970-01-01, 64 bit as the DS3231 counts past 2106
+ */
+
+int64_t calendar_to_unix(uint32_t seconds) {
+	return (int64_t) seconds + CALENDAR_UNIX_EPOCH_OFFSET;
+}
+
+/*
+ * Description: converts Unix time into seconds since 2000-01-01
+ * Parameters:
+ * 		int64_t seconds since 1970-01-01
+ * 		uint32_t * seconds since 2000-01-01
+ * Returns:
+ *   		bool false when the time is before 2000 or does not fit in 32 bits
+ */
+
+bool calendar_from_unix(int64_t unix_time, uint32_t *seconds) {
+
+	int64_t since_epoch = unix_time - CALENDAR_UNIX_EPOCH_OFFSET;
+
+	if (since_epoch < 0 || since_epoch > UINT32_MAX)
+		return false;
+
+	*seconds = (uint32_t) since_epoch;
+	return true;
+}
+
+/*
+ * Description: remainder of a division by 7. 2^12 is 1 modulo 7, so folding the value into 12 bit pieces
+ *              keeps the remainder, the last division is a multiply exact below 5461.
+ * Parameters:
+ * 		uint32_t the value
+ * Returns:
+ *   		uint32_t the value modulo 7
+ */
+
+static uint32_t mod7(uint32_t value) {
+
+	value = (value >> 12) + (value & 0xFFF);
+	value = (value >> 12) + (value & 0xFFF);             // below 4352
+
+	return value - 7 * ((value * 2341) >> 14);
+}
@@ -0,0 +1,41 @@
+/*******************************************************************************
+ * Copyright (C) 2023 by PRANJAL GUPTA
+ *
+ * Redistribution, modification or use of this software in source or binary
+ * forms is permitted as long as the files maintain this copyright. Users are
+ * permitted to modify this and use it to learn about the field of embedded
+ * software. PRANJAL GUPTA and the University of Colorado are not liable for
+ * any misuse of this material.
+ * ****************************************************************************/
+
+/**
+ * @file    calendar.h
+ * @brief   This file has function prototypes for the conversion between civil dates and a count of days or
+ *          seconds since 2000-01-01 00:00:00, the epoch of the DS3231 calendar, and Unix time.
+ *
+ * @author  Pranjal Gupta
+ * @date    12/21/2023
+ *
+ */
+
+#ifndef CALENDAR_H_
+#define CALENDAR_H_
+
+#include "stdint.h"
+#include "stdbool.h"
+
+#define CALENDAR_EPOCH_YEAR 2000
+#define CALENDAR_SECONDS_PER_DAY 86400UL
+#define CALENDAR_UNIX_EPOCH_OFFSET 946684800LL      // 1970-01-01 to 2000-01-01 in seconds
+
+int32_t calendar_days_from_civil(uint16_t year, uint8_t month, uint8_t day);
+void calendar_civil_from_days(int32_t days, uint16_t *year, uint8_t *month, uint8_t *day);
+uint8_t calendar_day_of_week(int32_t days);
+uint16_t calendar_day_of_year(uint16_t year, uint8_t month, uint8_t day);
+uint8_t calendar_iso_week(int32_t days, uint16_t *iso_year);
+int32_t calendar_days_from_seconds(uint32_t seconds, uint32_t *seconds_of_day);
+void calendar_time_of_day(uint32_t seconds_of_day, uint8_t *hour, uint8_t *minute, uint8_t *second);
+int64_t calendar_to_unix(uint32_t seconds);
+bool calendar_from_unix(int64_t unix_time, uint32_t *seconds);
+
+#endif /* CALENDAR_H_ */
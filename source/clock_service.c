@@ -0,0 +1,492 @@
+/*******************************************************************************
+ * Copyright (C) 2023 by PRANJAL GUPTA
+ *
+ * Redistribution, modification or use of this software in source or binary
+ * forms is permitted as long as the files maintain this copyright. Users are
+ * permitted to modify this and use it to learn about the field of embedded
+ * software. PRANJAL GUPTA and the University of Colorado are not liable for
+ * any misuse of this material.
+ * ****************************************************************************/
+
+/**
+ * @file    clock_service.c
+ * @brief   This file contains a software clock. The DS3231 is read once per CLOCK_RESYNC_PERIOD_S, the time in
+ *          between is extrapolated from the 64 bit core cycle counter, using the core cycles per RTC second
+ *          measured between two syncs taken on a square wave edge. The time never goes back, a sync which
+ *          finds the clock slightly ahead holds it until the RTC has caught up. A step larger than
+ *          CLOCK_MAX_SLEW_US is taken as a change of the RTC time and applied at once.
+ *          The state is published with a sequence counter: the one writer (the task doing the sync) updates
+ *          it in a short critical section and readers copy it without a lock, retrying when the counter
+ *          changed while copying, so any task or ISR can read the time without a bus transaction.
+ *          With CLOCK_SOURCE_RTC_CLKIN the KL25Z RTC, counting the 32K output of the DS3231, is loaded at the
+ *          first edge sync and every query reads it instead, there is no drift to follow and no resync.
+ *
+ * @author  Pranjal Gupta
+ * @date    12/21/2023
+ *
+ */
+#include "clock_service.h"
+#include "calendar.h"
+#include "cycle_counter.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include "MKL25Z4.h"
+#include "rtc_clkin.h"
+#include "stdlib.h"
+
+/* extrapolation state, read by every task and written only by clock_service_sync */
+typedef struct {
+	bool valid;
+	uint32_t base_seconds;           // RTC time at base_cycles
+	uint64_t base_cycles;
+	uint32_t us_per_cycle_q32;       // micro seconds per core cycle, 32 fractional bits
+	clock_timestamp_t floor;         // time given out just before the last sync
+	uint64_t base_ms;                // base_seconds in milli seconds
+	uint32_t ms_per_cycle_q42;       // milli seconds per core cycle, 42 fractional bits
+	uint64_t floor_ms;               // floor in milli seconds
+} clock_state_t;
+
+static void read_state(clock_state_t *copy);
+static void extrapolate(const clock_state_t *clock, uint64_t cycles, clock_timestamp_t *now);
+static void set_valid(bool valid);
+#if CLOCK_SOURCE_RTC_CLKIN
+static void sync_rtc_clkin(uint32_t seconds, uint64_t cycles, bool at_edge);
+#endif
+
+#define COMPILER_BARRIER() __asm volatile ("" ::: "memory")
+#define US_PER_S 1000000UL
+#define MS_PER_S 1000U
+#define US_PER_MS 1000U
+#define MS_PER_US_Q32 4294968ULL         // 2^32 / 1000 rounded up, exact below 6 s
+#define US_SPLIT_Q45 2251799814ULL       // 2^45 / 15625 rounded up
+#define US_SPLIT_MAX_BITS 38             // elapsed micro seconds split without a division
+#define SECONDS_PER_HOUR 3600
+#define SECONDS_PER_MINUTE 60
+#define DRIFT_FILTER_SHIFT 2             // a new drift sample has a weight of 1/4
+#define CLOCK_MAX_SLEW_US 2000000L
+
+static clock_state_t state;
+static volatile uint32_t sequence = 0;
+
+/* kept by the writer only */
+static bool last_sync_at_edge = false;
+static uint32_t last_sync_seconds;
+static uint64_t last_sync_cycles;
+static uint32_t last_check_seconds;
+static uint32_t cycles_per_second = 0;
+static clock_service_stats_t service_stats;
+
+/*
+ * Description: copies the published state, retries while the writer changed it during the copy
+ * Parameters:
+ * 		clock_state_t * the copy
+ * Returns:
+ *   		None
+ */
+
+static void read_state(clock_state_t *copy) {
+
+	uint32_t start;
+
+	do {
+		start = sequence;
+		COMPILER_BARRIER();
+		*copy = state;
+		COMPILER_BARRIER();
+	} while ((start & 1) || start != sequence);
+}
+
+/*
+ * Description: works out the time at a cycle count from the state, never earlier than the floor. The
+ *              micro seconds are split into seconds with a multiply, the M0+ has no divide instruction.
+ * Parameters:
+ * 		const clock_state_t * the state
+ * 		uint64_t the cycle count
+ * 		clock_timestamp_t * the time
+ * Returns:
+ *   		None
+ */
+
+static void extrapolate(const clock_state_t *clock, uint64_t cycles, clock_timestamp_t *now) {
+
+	uint64_t elapsed = cycles - clock->base_cycles;
+	uint64_t elapsed_us;
+	uint32_t elapsed_seconds;
+
+	if (elapsed >> 32)                 // more than ~89 s without a sync
+		elapsed_us = ((elapsed >> 16) * clock->us_per_cycle_q32) >> 16;
+	else
+		elapsed_us = (elapsed * clock->us_per_cycle_q32) >> 32;
+
+	if (elapsed_us >> US_SPLIT_MAX_BITS)       // more than ~76 h without a sync
+		elapsed_seconds = (uint32_t) (elapsed_us / US_PER_S);
+	else                                       // (us / 64) / 15625, exact for every 32 bit quotient
+		elapsed_seconds = (uint32_t) (((elapsed_us >> 6) * US_SPLIT_Q45) >> 45);
+
+	now->seconds = clock->base_seconds + elapsed_seconds;
+	now->microseconds = (uint32_t) (elapsed_us - (uint64_t) elapsed_seconds * US_PER_S);
+
+	if (now->seconds < clock->floor.seconds
+			|| (now->seconds == clock->floor.seconds && now->microseconds < clock->floor.microseconds))
+		*now = clock->floor;
+}
+
+/*
+ * Description: sets the clock to the time of a snapshot of the RTC. When the snapshot was read right after
+ *              a square wave edge the cycle count of the edge is the start of its second and, with the
+ *              previous edge sync, gives a drift sample of the core clock. A snapshot read at another time
+ *              only tells the second, so it is only used when the clock is not in that second.
+ * Parameters:
+ * 		const ds3231_snapshot_t * the snapshot
+ * 		uint64_t cycle_counter_now64 at the start of the second of the snapshot, or at the read
+ * 		bool true when the cycle count was taken on the edge
+ * Returns:
+ *   		None
+ */
+
+void clock_service_sync(const ds3231_snapshot_t *snapshot, uint64_t cycles, bool at_edge) {
+
+	uint32_t seconds = clock_service_from_datetime(&snapshot->time, &snapshot->date);
+	uint32_t nominal = configCPU_CLOCK_HZ;
+	uint32_t measured, elapsed_seconds;
+	clock_state_t next = state;          // only this function writes the state
+	clock_timestamp_t before;
+	int64_t step;
+
+	if (cycles_per_second == 0)
+		cycles_per_second = nominal;
+
+#if CLOCK_SOURCE_RTC_CLKIN
+	sync_rtc_clkin(seconds, cycles, at_edge);
+	return;
+#endif
+
+	last_check_seconds = seconds;
+	service_stats.syncs++;
+	if (!at_edge && state.valid) {
+		extrapolate(&state, cycles, &before);
+		if (before.seconds == seconds)          // keeps the phase of the last edge sync
+			return;
+	}
+
+	if (at_edge && last_sync_at_edge && state.valid) {
+		elapsed_seconds = seconds - last_sync_seconds;
+		if (elapsed_seconds > 0 && elapsed_seconds < UINT32_MAX / nominal) {
+			measured = (uint32_t) ((cycles - last_sync_cycles) / elapsed_seconds);
+			if ((uint32_t) abs((int32_t) (measured - nominal)) <= nominal / US_PER_S * CLOCK_MAX_DRIFT_PPM)
+				cycles_per_second += ((int32_t) (measured - cycles_per_second)) >> DRIFT_FILTER_SHIFT;
+			else
+				service_stats.rejected_samples++;
+		}
+	}
+
+	if (state.valid) {
+		extrapolate(&state, cycles, &before);
+		step = ((int64_t) seconds - before.seconds) * (int64_t) US_PER_S - before.microseconds;
+		service_stats.last_step_us = (int32_t) step;
+		if (step > -CLOCK_MAX_SLEW_US)
+			next.floor = before;
+		else
+			next.floor.seconds = next.floor.microseconds = 0;
+	} else {
+		next.floor.seconds = 0;
+		next.floor.microseconds = 0;
+	}
+
+	next.valid = true;
+	next.base_seconds = seconds;
+	next.base_cycles = cycles;
+	next.us_per_cycle_q32 = (uint32_t) (((uint64_t) US_PER_S << 32) / cycles_per_second);
+	next.base_ms = (uint64_t) seconds * MS_PER_S;
+	next.ms_per_cycle_q42 = (uint32_t) (((uint64_t) MS_PER_S << 42) / cycles_per_second);
+	next.floor_ms = (uint64_t) next.floor.seconds * MS_PER_S + next.floor.microseconds / US_PER_MS;
+
+	taskENTER_CRITICAL();
+	sequence++;
+	COMPILER_BARRIER();
+	state = next;
+	COMPILER_BARRIER();
+	sequence++;
+	taskEXIT_CRITICAL();
+
+	last_sync_at_edge = at_edge;
+	last_sync_seconds = seconds;
+	last_sync_cycles = cycles;
+	service_stats.drift_ppb = (int32_t) (((int64_t) cycles_per_second - nominal) * 1000000000LL / nominal);
+}
+
+#if CLOCK_SOURCE_RTC_CLKIN
+/*
+ * Description: loads the KL25Z RTC from a snapshot when it is not set or counts another second. It counts the
+ *              32K output of the DS3231, so after the first edge load the periodic syncs only check it and
+ *              hand the status register to the monitor. A snapshot read off the edge sets the RTC with the
+ *              phase of the read and the next edge sync loads it again with the phase of the edge.
+ * Parameters:
+ * 		uint32_t seconds since 2000-01-01 of the snapshot
+ * 		uint64_t cycle_counter_now64 at the start of the second of the snapshot, or at the read
+ * 		bool true when the cycle count was taken on the edge
+ * Returns:
+ *   		None
+ */
+
+static void sync_rtc_clkin(uint32_t seconds, uint64_t cycles, bool at_edge) {
+
+	uint32_t elapsed_us = cycle_counter_to_us((uint32_t) (cycle_counter_now64() - cycles));
+	uint32_t rtc_seconds, rtc_microseconds;
+
+	last_check_seconds = seconds;
+	service_stats.syncs++;
+
+	if (state.valid && (last_sync_at_edge || !at_edge) && rtc_clkin_read(&rtc_seconds, &rtc_microseconds)
+			&& rtc_seconds == seconds + elapsed_us / US_PER_S)
+		return;
+
+	rtc_clkin_load(seconds, elapsed_us);
+	last_sync_at_edge = at_edge;
+	set_valid(true);
+}
+#endif
+
+/*
+ * Description: marks the clock as not set, used after the RTC was set. The next sync may move the time
+ *              backwards and does not give a drift sample.
+ * Parameters:
+ * 		None
+ * Returns:
+ *   		None
+ */
+
+void clock_service_invalidate(void) {
+	set_valid(false);
+}
+
+/*
+ * Description: publishes a change of the valid flag alone
+ * Parameters:
+ * 		bool the new flag
+ * Returns:
+ *   		None
+ */
+
+static void set_valid(bool valid) {
+
+	taskENTER_CRITICAL();
+	sequence++;
+	COMPILER_BARRIER();
+	state.valid = valid;
+	COMPILER_BARRIER();
+	sequence++;
+	taskEXIT_CRITICAL();
+}
+
+/*
+ * Description: tells the task doing the sync whether the RTC has to be read, it is only called by that task
+ * Parameters:
+ * 		None
+ * Returns:
+ *   		bool true when the clock is not set or CLOCK_RESYNC_PERIOD_S passed since the last sync
+ */
+
+bool clock_service_sync_due(void) {
+
+	clock_timestamp_t now;
+
+	if (!clock_service_now(&now))
+		return true;
+
+	return now.seconds - last_check_seconds >= CLOCK_RESYNC_PERIOD_S;
+}
+
+/*
+ * Description: returns the current time without any bus transaction, can be called from tasks and ISRs
+ * Parameters:
+ * 		clock_timestamp_t * the time
+ * Returns:
+ *   		bool false when the clock has not been synced yet
+ */
+
+bool clock_service_now(clock_timestamp_t *now) {
+	return clock_service_time_at(cycle_counter_now64(), now);
+}
+
+/*
+ * Description: returns the time at a cycle count taken a little earlier, for events stamped in an ISR
+ *              and handled later by a task. Can be called from tasks and ISRs.
+ * Parameters:
+ * 		uint64_t cycle_counter_now64 at the event
+ * 		clock_timestamp_t * the time
+ * Returns:
+ *   		bool false when the clock has not been synced yet
+ */
+
+bool clock_service_time_at(uint64_t cycles, clock_timestamp_t *time) {
+
+	clock_state_t clock;
+#if CLOCK_SOURCE_RTC_CLKIN
+	uint32_t back_us = cycle_counter_to_us((uint32_t) (cycle_counter_now64() - cycles));
+#endif
+
+	read_state(&clock);
+	if (!clock.valid)
+		return false;
+
+#if CLOCK_SOURCE_RTC_CLKIN
+	if (!rtc_clkin_read(&time->seconds, &time->microseconds))
+		return false;
+	while (back_us > time->microseconds) {
+		time->seconds--;
+		time->microseconds += US_PER_S;
+	}
+	time->microseconds -= back_us;
+#else
+	extrapolate(&clock, cycles, time);
+#endif
+	return true;
+}
+
+/*
+ * Description: returns the current time in whole seconds, for the callers which need no more resolution
+ * Parameters:
+ * 		None
+ * Returns:
+ *   		uint32_t seconds since 2000-01-01, 0 when the clock has not been synced yet
+ */
+
+uint32_t clock_service_seconds(void) {
+
+	clock_timestamp_t now = { 0, 0 };
+
+	clock_service_now(&now);
+	return now.seconds;
+}
+
+/*
+ * Description: returns the second which started at a square wave edge. The time of the edge, extrapolated
+ *              or read back from the KL25Z RTC, is rounded to the nearest second, so a core clock a little
+ *              slow does not give the second before the edge.
+ * Parameters:
+ * 		uint64_t cycle count of the edge
+ * 		uint32_t * seconds since 2000-01-01
+ * Returns:
+ *   		bool false when the clock has not been synced yet
+ */
+
+bool clock_service_second_at_edge(uint64_t edge_cycles, uint32_t *seconds) {
+
+	clock_timestamp_t edge;
+
+	if (!clock_service_time_at(edge_cycles, &edge))
+		return false;
+
+	*seconds = edge.seconds + (edge.microseconds >= US_PER_S / 2);
+	return true;
+}
+
+/*
+ * Description: returns the current time and date in the format of the DS3231 driver
+ * Parameters:
+ * 		ds3231_time_t * the time
+ * 		ds3231_date_t * the date
+ * Returns:
+ *   		bool false when the clock has not been synced yet
+ */
+
+bool clock_service_get_datetime(ds3231_time_t *time, ds3231_date_t *date) {
+
+	clock_timestamp_t now;
+
+	if (!clock_service_now(&now))
+		return false;
+
+	clock_service_to_datetime(now.seconds, time, date);
+	return true;
+}
+
+/*
+ * Description: returns the time in milli seconds for log and event time stamps. It costs the same every
+ *              call, one copy of the state, one read of the cycle counter and one multiply, and never
+ *              touches the bus, so it can be called from any task and from ISRs.
+ * Parameters:
+ * 		None
+ * Returns:
+ *   		uint64_t milli seconds since 2000-01-01 00:00:00, 0 while the clock is not set
+ */
+
+uint64_t clock_service_now_ms(void) {
+
+	clock_state_t clock;
+#if CLOCK_SOURCE_RTC_CLKIN
+	uint32_t seconds, microseconds;
+#else
+	uint64_t elapsed, ms;
+#endif
+
+	read_state(&clock);
+	if (!clock.valid)
+		return 0;
+
+#if CLOCK_SOURCE_RTC_CLKIN
+	if (!rtc_clkin_read(&seconds, &microseconds))
+		return 0;
+	return (uint64_t) seconds * MS_PER_S + (((uint64_t) microseconds * MS_PER_US_Q32) >> 32);
+#else
+	elapsed = cycle_counter_now64() - clock.base_cycles;     // read after the state, never before the base
+	if (elapsed >> 32)                 // more than ~89 s without a sync
+		ms = ((elapsed >> 10) * clock.ms_per_cycle_q42) >> 32;
+	else
+		ms = (elapsed * clock.ms_per_cycle_q42) >> 42;
+	ms += clock.base_ms;
+
+	return ms > clock.floor_ms ? ms : clock.floor_ms;
+#endif
+}
+
+/*
+ * Description: converts seconds since 2000-01-01 into the time and date format of the DS3231 driver, the
+ *              day of the week is worked out from the date
+ * Parameters:
+ * 		uint32_t seconds since 2000-01-01
+ * 		ds3231_time_t * the time
+ * 		ds3231_date_t * the date
+ * Returns:
+ *   		None
+ */
+
+void clock_service_to_datetime(uint32_t seconds, ds3231_time_t *time, ds3231_date_t *date) {
+
+	uint32_t seconds_of_day;
+	int32_t days = calendar_days_from_seconds(seconds, &seconds_of_day);
+
+	calendar_civil_from_days(days, &date->year, &date->month, &date->date);
+	date->dow = calendar_day_of_week(days);
+	calendar_time_of_day(seconds_of_day, &time->hour, &time->min, &time->sec);
+}
+
+/*
+ * Description: converts a time and date in the format of the DS3231 driver into seconds since 2000-01-01
+ * Parameters:
+ * 		const ds3231_time_t * the time
+ * 		const ds3231_date_t * the date
+ * Returns:
+ *   		uint32_t seconds since 2000-01-01
+ */
+
+uint32_t clock_service_from_datetime(const ds3231_time_t *time, const ds3231_date_t *date) {
+
+	int32_t days = calendar_days_from_civil(date->year, date->month, date->date);
+
+	return (uint32_t) days * CALENDAR_SECONDS_PER_DAY + time->hour * SECONDS_PER_HOUR
+			+ time->min * SECONDS_PER_MINUTE + time->sec;
+}
+
+/*
+ * Description: copies the drift estimate and the sync counters
+ * Parameters:
+ * 		clock_service_stats_t * the structure to be filled
+ * Returns:
+ *   		None
+ */
+
+void clock_service_get_stats(clock_service_stats_t *stats) {
+	*stats = service_stats;
+}
@@ -0,0 +1,66 @@
+/*******************************************************************************
+ * Copyright (C) 2023 by PRANJAL GUPTA
+ *
+ * Redistribution, modification or use of this software in source or binary
+ * forms is permitted as long as the files maintain this copyright. Users are
+ * permitted to modify this and use it to learn about the field of embedded
+ * software. PRANJAL GUPTA and the University of Colorado are not liable for
+ * any misuse of this material.
+ * ****************************************************************************/
+
+/**
+ * @file    clock_service.h
+ * @brief   This file has function prototypes for the software clock extrapolated from the core cycle counter
+ *          between reads of the DS3231.
+ *
+ * @author  Pranjal Gupta
+ * @date    12/21/2023
+ *
+ */
+
+#ifndef CLOCK_SERVICE_H_
+#define CLOCK_SERVICE_H_
+
+#include "stdint.h"
+#include "stdbool.h"
+#include "DS3231.h"
+
+/*
+ * Seconds between two reads of the DS3231, 0 reads it on every square wave edge. The drift of the core
+ * clock is measured over this interval.
+ */
+#ifndef CLOCK_RESYNC_PERIOD_S
+#define CLOCK_RESYNC_PERIOD_S 60
+#endif
+
+/* measured core clock errors above this are taken as a bad sample and not used */
+#ifndef CLOCK_MAX_DRIFT_PPM
+#define CLOCK_MAX_DRIFT_PPM 500
+#endif
+
+typedef struct {
+	uint32_t seconds;          // since 2000-01-01 00:00:00
+	uint32_t microseconds;
+} clock_timestamp_t;
+
+typedef struct {
+	int32_t drift_ppb;         // core clock error against the RTC, positive when the core runs fast
+	int32_t last_step_us;      // correction applied at the last sync, positive when the clock was behind
+	uint32_t syncs;
+	uint32_t rejected_samples;
+} clock_service_stats_t;
+
+void clock_service_sync(const ds3231_snapshot_t *snapshot, uint64_t cycles, bool at_edge);
+void clock_service_invalidate(void);
+bool clock_service_sync_due(void);
+bool clock_service_now(clock_timestamp_t *now);
+bool clock_service_time_at(uint64_t cycles, clock_timestamp_t *time);
+uint64_t clock_service_now_ms(void);
+uint32_t clock_service_seconds(void);
+bool clock_service_second_at_edge(uint64_t edge_cycles, uint32_t *seconds);
+bool clock_service_get_datetime(ds3231_time_t *time, ds3231_date_t *date);
+void clock_service_to_datetime(uint32_t seconds, ds3231_time_t *time, ds3231_date_t *date);
+uint32_t clock_service_from_datetime(const ds3231_time_t *time, const ds3231_date_t *date);
+void clock_service_get_stats(clock_service_stats_t *stats);
+
+#endif /* CLOCK_SERVICE_H_ */
@@ -0,0 +1,128 @@
+/*******************************************************************************
+ * Copyright (C) 2023 by PRANJAL GUPTA
+ *
+ * Redistribution, modification or use of this software in source or binary
+ * forms is permitted as long as the files maintain this copyright. Users are
+ * permitted to modify this and use it to learn about the field of embedded
+ * software. PRANJAL GUPTA and the University of Colorado are not liable for
+ * any misuse of this material.
+ * ****************************************************************************/
+
+/**
+ * @file    cycle_counter.c
+ * @brief   This file contains a 32 bit core cycle counter. The Cortex-M0+ has no DWT cycle counter,
+ *          so the count is made from the FreeRTOS SysTick reload value and a tick count kept in the tick hook.
+ *          It is only valid once the scheduler has started and wraps after 2^32 cycles (~89 s at 48 MHz).
+ *          The tick count is 64 bit too, so the 64 bit count does not wrap in practice. Its 32 bit low
+ *          half wraps after ~49.7 days at 1 kHz, CYCLE_COUNTER_FIRST_TICK starts it just below to try that.
+ *
+ * @author  Pranjal Gupta
+ * @date    12/14/2023
+ *
+ */
+#include "cycle_counter.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include "MKL25Z4.h"
+
+#define CYCLES_PER_US (configCPU_CLOCK_HZ / 1000000U)
+
+static void cycle_counter_sample(uint64_t *ticks, uint32_t *load, uint32_t *val);
+
+static volatile uint64_t tick_count = CYCLE_COUNTER_FIRST_TICK;   // only changed in the tick interrupt
+
+/*
+ * Description: FreeRTOS tick hook, counts the SysTick reloads. It is called once for every tick
+ *              even when the scheduler is suspended, which the kernel tick count is not.
+ *
+ * Parameters:
+ *    		None
+ *
+ * Returns:
+ *   		None
+ */
+
+void vApplicationTickHook(void) {
+	tick_count++;
+}
+
+/*
+ * Description: returns the number of core cycles elapsed since the scheduler started. Safe to
+ *              call from tasks, from ISRs and from the context switch (run time stats clock).
+ *
+ * Parameters:
+ *    		None
+ *
+ * Returns:
+ *   		uint32_t the current cycle count
+ */
+
+uint32_t cycle_counter_now(void) {
+
+	uint64_t ticks;
+	uint32_t load, val;
+
+	cycle_counter_sample(&ticks, &load, &val);
+	return (uint32_t) ticks * (load + 1) + (load - val);
+}
+
+/*
+ * Description: returns the number of core cycles elapsed since the scheduler started without the 32 bit
+ *              wrap, for intervals longer than a minute. Safe to call from tasks and from ISRs.
+ *
+ * Parameters:
+ *    		None
+ *
+ * Returns:
+ *   		uint64_t the current cycle count
+ */
+
+uint64_t cycle_counter_now64(void) {
+
+	uint64_t ticks;
+	uint32_t load, val;
+
+	cycle_counter_sample(&ticks, &load, &val);
+	return ticks * (load + 1) + (load - val);
+}
+
+/*
+ * Description: reads the tick count and the SysTick counter as one consistent pair
+ *
+ * Parameters:
+ *    		uint64_t * number of SysTick reloads
+ *    		uint32_t * SysTick reload value
+ *    		uint32_t * SysTick current value, counting down
+ *
+ * Returns:
+ *   		None
+ */
+
+static void cycle_counter_sample(uint64_t *ticks, uint32_t *load, uint32_t *val) {
+
+	uint32_t mask;
+
+	mask = portSET_INTERRUPT_MASK_FROM_ISR();
+	*ticks = tick_count;
+	*load = SysTick->LOAD;
+	*val = SysTick->VAL;
+	if (SCB->ICSR & SCB_ICSR_PENDSTSET_Msk) { // counter reloaded but the tick interrupt has not run yet
+		*val = SysTick->VAL;
+		(*ticks)++;
+	}
+	portCLEAR_INTERRUPT_MASK_FROM_ISR(mask);
+}
+
+/*
+ * Description: converts a cycle count into micro seconds
+ *
+ * Parameters:
+ *    		uint32_t number of core cycles
+ *
+ * Returns:
+ *   		uint32_t the same duration in micro seconds
+ */
+
+uint32_t cycle_counter_to_us(uint32_t cycles) {
+	return cycles / CYCLES_PER_US;
+}
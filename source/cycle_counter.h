@@ -0,0 +1,34 @@
+/*******************************************************************************
+ * Copyright (C) 2023 by PRANJAL GUPTA
+ *
+ * Redistribution, modification or use of this software in source or binary
+ * forms is permitted as long as the files maintain this copyright. Users are
+ * permitted to modify this and use it to learn about the field of embedded
+ * software. PRANJAL GUPTA and the University of Colorado are not liable for
+ * any misuse of this material.
+ * ****************************************************************************/
+
+/**
+ * @file    cycle_counter.h
+ * @brief   This file has function prototypes for the free running core cycle counter built on SysTick.
+ *
+ * @author  Pranjal Gupta
+ * @date    12/14/2023
+ *
+ */
+
+#ifndef CYCLE_COUNTER_H_
+#define CYCLE_COUNTER_H_
+
+#include "stdint.h"
+
+/* tick count at the start of the scheduler, 0x100000000ULL - 60000 shows the 32 bit tick wrap after 1 min */
+#ifndef CYCLE_COUNTER_FIRST_TICK
+#define CYCLE_COUNTER_FIRST_TICK 0
+#endif
+
+uint32_t cycle_counter_now(void);
+uint64_t cycle_counter_now64(void);
+uint32_t cycle_counter_to_us(uint32_t cycles);
+
+#endif /* CYCLE_COUNTER_H_ */
@@ -0,0 +1,318 @@
+/*******************************************************************************
+ * Copyright (C) 2023 by PRANJAL GUPTA
+ *
+ * Redistribution, modification or use of this software in source or binary
+ * forms is permitted as long as the files maintain this copyright. Users are
+ * permitted to modify this and use it to learn about the field of embedded
+ * software. PRANJAL GUPTA and the University of Colorado are not liable for
+ * any misuse of this material.
+ * ****************************************************************************/
+
+/**
+ * @file    ds3231_shadow.c
+ * @brief   This file contains a RAM copy of the 19 DS3231 registers with a valid and a dirty bit per register.
+ *          Every bus read refreshes the copy. Reads of registers only changed by this driver (alarms, control,
+ *          aging) are served from the copy once it is valid, the time keeping, status and temperature
+ *          registers always go to the bus. Writes are staged in the copy and sent at commit, each run of
+ *          adjacent dirty registers as one burst write. Two runs are joined when the few registers between
+ *          them are valid and not volatile, writing back the value the device already holds.
+ *          The copy is shared by the display, alarm and calibration tasks, which run at different priorities
+ *          and all block on the bus owner in the middle of an update. Each driver level read-modify-write
+ *          therefore runs between ds3231_shadow_lock and ds3231_shadow_unlock, from the read through the
+ *          commit and the refresh. The lock is a mutex given with ds3231_shadow_set_lock, without one (host
+ *          build, before the scheduler runs) nothing is locked.
+ *
+ * @author  Pranjal Gupta
+ * @date    12/20/2023
+ *
+ */
+#include "ds3231_shadow.h"
+#include "DS3231.h"
+#include "i2c_hal.h"
+#include "string.h"
+
+static uint32_t register_mask(uint8_t reg, uint8_t count);
+static i2c_status_t write_run(uint8_t first, uint8_t last);
+static void check_locked(void);
+
+#define REGISTER_BIT(reg) (1UL << (reg))
+#define ALL_REGISTERS (REGISTER_BIT(DS3231_REGISTER_COUNT) - 1)
+#define VOLATILE_REGISTERS (register_mask(0x00, 7) | REGISTER_BIT(0x0F) | register_mask(0x11, 2))
+
+static uint8_t shadow[DS3231_REGISTER_COUNT];
+static uint32_t valid_mask = 0;
+static uint32_t dirty_mask = 0;
+static ds3231_shadow_stats_t shadow_stats;
+static ds3231_shadow_lock_t lock_function = NULL;
+static ds3231_shadow_lock_t unlock_function = NULL;
+static uint8_t lock_depth = 0;                 // only changed by the holder of the lock
+
+/*
+ * Description: bit mask of a range of registers
+ * Parameters:
+ * 		uint8_t first register of the range
+ * 		uint8_t number of registers
+ * Returns:
+ *   		uint32_t one bit per register of the range
+ */
+
+static uint32_t register_mask(uint8_t reg, uint8_t count) {
+	return ((REGISTER_BIT(count) - 1) << reg) & ALL_REGISTERS;
+}
+
+/*
+ * Description: sets the functions which take and give the lock of the copy. It has to be called before more
+ *              than one task uses the driver.
+ * Parameters:
+ * 		ds3231_shadow_lock_t takes the lock, blocking until it is free
+ * 		ds3231_shadow_lock_t gives the lock back
+ * Returns:
+ *   		None
+ */
+
+void ds3231_shadow_set_lock(ds3231_shadow_lock_t lock, ds3231_shadow_lock_t unlock) {
+
+	lock_function = lock;
+	unlock_function = unlock;
+}
+
+/*
+ * Description: takes the lock of the copy for one driver level operation, the copy and the bus transactions
+ *              of the operation are not interleaved with those of another task until ds3231_shadow_unlock.
+ *              It must not be called again before ds3231_shadow_unlock.
+ * Parameters:
+ * 		None
+ * Returns:
+ *   		None
+ */
+
+void ds3231_shadow_lock(void) {
+
+	if (lock_function != NULL)
+		lock_function();
+	lock_depth++;
+}
+
+/*
+ * Description: gives back the lock taken by ds3231_shadow_lock
+ * Parameters:
+ * 		None
+ * Returns:
+ *   		None
+ */
+
+void ds3231_shadow_unlock(void) {
+
+	lock_depth--;
+	if (unlock_function != NULL)
+		unlock_function();
+}
+
+/*
+ * Description: counts a use of the copy without the lock while a lock is set
+ * Parameters:
+ * 		None
+ * Returns:
+ *   		None
+ */
+
+static void check_locked(void) {
+
+	if (lock_function != NULL && lock_depth == 0)
+		shadow_stats.unlocked_accesses++;
+}
+
+/*
+ * Description: forgets the content of the copy, the next read of every register goes to the bus. Staged
+ *              writes are dropped as well.
+ * Parameters:
+ * 		None
+ * Returns:
+ *   		None
+ */
+
+void ds3231_shadow_invalidate(void) {
+
+	valid_mask = 0;
+	dirty_mask = 0;
+}
+
+/*
+ * Description: reads a range of registers. The copy is used when every register of the range is valid and
+ *              not volatile, otherwise the range is read in one bus transaction and stored in the copy.
+ *              Registers with a staged write keep the staged value in the copy, the non volatile ones are
+ *              returned with it, the time keeping and status registers always as read from the device.
+ * Parameters:
+ * 		uint8_t first register
+ * 		uint8_t * buffer for the values
+ * 		uint8_t number of registers
+ * Returns:
+ *   		i2c_status_t the result of the bus read, I2C_STATUS_OK when served from the copy
+ */
+
+i2c_status_t ds3231_shadow_read(uint8_t reg, uint8_t *values, uint8_t count) {
+
+	uint32_t mask = register_mask(reg, count);
+	i2c_status_t status;
+	check_locked();
+
+	if ((mask & VOLATILE_REGISTERS) == 0 && (mask & ~valid_mask) == 0) {
+		memcpy(values, &shadow[reg], count);
+		shadow_stats.cache_hits++;
+		return I2C_STATUS_OK;
+	}
+
+	status = i2c_hal_read(I2C_PRIORITY_HIGH, DS3231_ADDRESS, reg, values, count);
+	shadow_stats.bus_reads++;
+	if (status != I2C_STATUS_OK)
+		return status;
+
+	for (uint8_t i = 0; i < count; i++) {
+		if (!(dirty_mask & REGISTER_BIT(reg + i)))
+			shadow[reg + i] = values[i];
+		else if (!(VOLATILE_REGISTERS & REGISTER_BIT(reg + i)))
+			values[i] = shadow[reg + i];
+	}
+	valid_mask |= mask;
+
+	return I2C_STATUS_OK;
+}
+
+/*
+ * Description: gives the last value of a register seen on the bus or staged, without a transaction, volatile
+ *              registers included. Used for the bits of a volatile register which only the driver changes.
+ * Parameters:
+ * 		uint8_t the register
+ * 		uint8_t * the value
+ * Returns:
+ *   		bool true when the copy of the register is valid
+ */
+
+bool ds3231_shadow_cached(uint8_t reg, uint8_t *value) {
+
+	check_locked();
+
+	if (!(valid_mask & REGISTER_BIT(reg)))
+		return false;
+
+	*value = shadow[reg];
+	return true;
+}
+
+/*
+ * Description: stores the value a register is known to hold in the device without writing it, for bits
+ *              the device clears on its own
+ * Parameters:
+ * 		uint8_t the register
+ * 		uint8_t the value
+ * Returns:
+ *   		None
+ */
+
+void ds3231_shadow_refresh(uint8_t reg, uint8_t value) {
+
+	check_locked();
+
+	shadow[reg] = value;
+	valid_mask |= REGISTER_BIT(reg);
+}
+
+/*
+ * Description: stages a write of a range of registers in the copy, nothing is sent before
+ *              ds3231_shadow_commit
+ * Parameters:
+ * 		uint8_t first register
+ * 		const uint8_t * the new values
+ * 		uint8_t number of registers
+ * Returns:
+ *   		None
+ */
+
+void ds3231_shadow_write(uint8_t reg, const uint8_t *values, uint8_t count) {
+
+	uint32_t mask = register_mask(reg, count);
+	check_locked();
+
+	memcpy(&shadow[reg], values, count);
+	valid_mask |= mask;
+	dirty_mask |= mask;
+}
+
+/*
+ * Description: sends one run of registers from the copy in one write transaction. When it fails the device
+ *              may hold the old or the new values, so the run is dropped from the copy and read again.
+ * Parameters:
+ * 		uint8_t first register of the run
+ * 		uint8_t last register of the run
+ * Returns:
+ *   		i2c_status_t the result of the write
+ */
+
+static i2c_status_t write_run(uint8_t first, uint8_t last) {
+
+	uint8_t address = first;
+	i2c_iovec_t segments[2] = { { &address, 1 }, { &shadow[first], last - first + 1 } };
+	i2c_status_t status;
+
+	status = i2c_hal_transmitv(I2C_PRIORITY_HIGH, DS3231_ADDRESS, segments, 2);
+	shadow_stats.commits++;
+	if (status == I2C_STATUS_OK)
+		shadow_stats.bytes_written += last - first + 1;
+	else
+		valid_mask &= ~register_mask(first, last - first + 1);
+	dirty_mask &= ~register_mask(first, last - first + 1);
+	return status;
+}
+
+/*
+ * Description: writes the staged registers to the device in ascending register order, adjacent dirty
+ *              registers and runs separated by at most DS3231_SHADOW_MAX_BRIDGE valid non volatile
+ *              registers go out as one burst. A failed run is not retried, its registers are read from the
+ *              device the next time and the caller writes them again.
+ * Parameters:
+ * 		None
+ * Returns:
+ *   		i2c_status_t the first error, I2C_STATUS_OK when every run was written
+ */
+
+i2c_status_t ds3231_shadow_commit(void) {
+
+	uint32_t bridgeable = valid_mask & ~VOLATILE_REGISTERS;
+	i2c_status_t status, result = I2C_STATUS_OK;
+	uint8_t first, last, next, gap;
+	check_locked();
+
+	for (first = 0; first < DS3231_REGISTER_COUNT; first++) {
+		if (!(dirty_mask & REGISTER_BIT(first)))
+			continue;
+
+		last = first;
+		gap = 0;
+		for (next = first + 1; next < DS3231_REGISTER_COUNT; next++) {
+			if (dirty_mask & REGISTER_BIT(next)) {
+				last = next;
+				gap = 0;
+			} else if (!(bridgeable & REGISTER_BIT(next)) || ++gap > DS3231_SHADOW_MAX_BRIDGE) {
+				break;
+			}
+		}
+
+		status = write_run(first, last);
+		if (status != I2C_STATUS_OK && result == I2C_STATUS_OK)
+			result = status;
+		first = last;
+	}
+	return result;
+}
+
+/*
+ * Description: copies the hit and transaction counters of the copy
+ * Parameters:
+ * 		ds3231_shadow_stats_t * the structure to be filled
+ * Returns:
+ *   		None
+ */
+
+void ds3231_shadow_get_stats(ds3231_shadow_stats_t *stats) {
+	*stats = shadow_stats;
+}
@@ -0,0 +1,57 @@
+/*******************************************************************************
+ * Copyright (C) 2023 by PRANJAL GUPTA
+ *
+ * Redistribution, modification or use of this software in source or binary
+ * forms is permitted as long as the files maintain this copyright. Users are
+ * permitted to modify this and use it to learn about the field of embedded
+ * software. PRANJAL GUPTA and the University of Colorado are not liable for
+ * any misuse of this material.
+ * ****************************************************************************/
+
+/**
+ * @file    ds3231_shadow.h
+ * @brief   This file has function prototypes for the RAM copy of the DS3231 register file.
+ *
+ * @author  Pranjal Gupta
+ * @date    12/20/2023
+ *
+ */
+
+#ifndef DS3231_SHADOW_H_
+#define DS3231_SHADOW_H_
+
+#include "stdint.h"
+#include "stdbool.h"
+#include "i2c.h"
+
+/*
+ * Most valid registers between two dirty runs which are written back to join the runs into one burst, a
+ * register byte costs about the same bus time as the START, address and STOP of another transaction.
+ */
+#ifndef DS3231_SHADOW_MAX_BRIDGE
+#define DS3231_SHADOW_MAX_BRIDGE 2
+#endif
+
+typedef struct {
+	uint32_t cache_hits;       // reads served without a bus transaction
+	uint32_t bus_reads;
+	uint32_t commits;          // write transactions
+	uint32_t bytes_written;    // register bytes written, without the address byte
+	uint32_t unlocked_accesses; // uses of the copy outside ds3231_shadow_lock while a lock is set
+} ds3231_shadow_stats_t;
+
+/* takes or gives the lock of the copy, a blocking mutex on the board */
+typedef void (*ds3231_shadow_lock_t)(void);
+
+void ds3231_shadow_set_lock(ds3231_shadow_lock_t lock, ds3231_shadow_lock_t unlock);
+void ds3231_shadow_lock(void);
+void ds3231_shadow_unlock(void);
+void ds3231_shadow_invalidate(void);
+i2c_status_t ds3231_shadow_read(uint8_t reg, uint8_t *values, uint8_t count);
+bool ds3231_shadow_cached(uint8_t reg, uint8_t *value);
+void ds3231_shadow_refresh(uint8_t reg, uint8_t value);
+void ds3231_shadow_write(uint8_t reg, const uint8_t *values, uint8_t count);
+i2c_status_t ds3231_shadow_commit(void);
+void ds3231_shadow_get_stats(ds3231_shadow_stats_t *stats);
+
+#endif /* DS3231_SHADOW_H_ */
@@ -9,7 +9,7 @@
 #ifndef FONT_5X7_H_
 #define FONT_5X7_H_
 
-static unsigned char font_5x7[96][5] = {{0x00, 0x00, 0x00, 0x00, 0x00},  // space
+static const unsigned char font_5x7[96][5] = {{0x00, 0x00, 0x00, 0x00, 0x00},  // space
                                        {0x00, 0x00, 0x4F, 0x00, 0x00},  // !
                                        {0x00, 0x07, 0x00, 0x07, 0x00},  // "
                                        {0x14, 0x7F, 0x14, 0x7F, 0x14},  // #
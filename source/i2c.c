@@ -11,6 +11,14 @@
 /**
  * @file    i2c.c
  * @brief   This file contains the functions related to i2c drivers for communicating with various devices.
+ *          Every transfer is run by one state machine (start, address, register, repeated start, data, stop)
+ *          which is advanced either from the ISR of its bus or by polling the IICIF flag. A write is a list of
+ *          segments sent in one transaction, long segments are handed to the DMA channel of the bus, the stop
+ *          and completion callback are then issued from the ISRs only. Every wait is bounded, a transfer which
+ *          does not complete in time is aborted and the bus is recovered by clocking SCL as a GPIO.
+ *          I2C0 and I2C1 are instances of the same driver, each with its own transfer, pins and DMA channel,
+ *          so transfers on the two buses run at the same time. The bus of a transfer is the one its slave
+ *          was registered on.
  *
  * @author  Pranjal Gupta
  * @date    12/3/2023
@@ -21,89 +29,411 @@
 #include "MKL25Z4.h"
 #include "i2c.h"
 #include "stdbool.h"
+#include "stddef.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include "fsl_clock.h"
+#include "cycle_counter.h"
+#include "i2c_trace.h"
 
-static void i2c_start(uint8_t device_addr, uint8_t write_or_read);
-static uint8_t read_single_byte(bool is_reapeated_read, uint8_t ack_or_nack);
-static void i2c_stop(void);
-static void i2c_delay(void);
+typedef enum {
+	I2C_STATE_IDLE,
+	I2C_STATE_ADDRESS,          // address byte with write bit in flight
+	I2C_STATE_TX_DATA,          // data byte in flight
+	I2C_STATE_TX_DMA,           // rest of the payload fed to the data register by DMA
+	I2C_STATE_REGISTER,         // register address of a read in flight
+	I2C_STATE_RESTART,          // repeated start and address with read bit in flight
+	I2C_STATE_RX_DATA           // data byte being received
+} i2c_state_t;
+
+typedef struct {
+	volatile i2c_state_t state;
+	uint8_t device_addr;
+	uint8_t read_addr;
+	bool is_read;
+	const i2c_iovec_t *tx_segments;   // segments sent back to back after the address byte
+	uint8_t segment_count;
+	uint8_t segment_index;
+	i2c_iovec_t single_segment;       // used by the single buffer writes
+	uint8_t *rx_data;
+	int length;                       // number of bytes to read
+	int index;                        // position in the current segment or in the read buffer
+	volatile i2c_status_t status;
+	uint32_t start_cycles;
+	bool use_dma;
+	i2c_callback_t callback;
+	void *callback_context;
+} i2c_transfer_t;
+
+/* one i2c module with its pins, interrupt, dma channel and the transfer in progress on it */
+typedef struct {
+	i2c_bus_id_t id;
+	I2C_Type *base;
+	PORT_Type *port;
+	GPIO_Type *gpio;
+	uint32_t port_clock_mask;         // SIM_SCGC5 gate of the port of the pins
+	uint32_t clock_gate_mask;         // SIM_SCGC4 gate of the module
+	uint8_t scl_pin;
+	uint8_t sda_pin;
+	uint8_t alt_func;
+	IRQn_Type irq;
+	uint8_t dma_channel;
+	uint8_t dmamux_source;
+	IRQn_Type dma_irq;
+	i2c_transfer_t transfer;
+	uint8_t current_f_register;
+	uint32_t current_scl_hz;
+	uint32_t default_scl_hz;
+	i2c_latency_histogram_t latency_histogram;
+} i2c_bus_t;
+
+static void i2c_start(i2c_bus_t *bus, uint8_t device_addr, uint8_t write_or_read);
+static void i2c_stop(i2c_bus_t *bus);
+static bool i2c_wait_bus_idle(i2c_bus_t *bus);
+static bool i2c_service(i2c_bus_t *bus);
+static bool i2c_next_tx_byte(i2c_bus_t *bus);
+static void i2c_start_dma(i2c_bus_t *bus, const i2c_iovec_t *segment);
+static void i2c_complete_from_isr(i2c_bus_t *bus);
+static void i2c_notify_task(i2c_status_t status, void *context);
+static i2c_status_t i2c_begin_transfer(i2c_bus_t *bus);
+static uint8_t i2c_compute_divider(uint32_t max_scl_hz, uint32_t *scl_hz);
+static void i2c_apply_device_speed(i2c_bus_t *bus, uint8_t device_addr);
+static i2c_status_t i2c_run_transfer(i2c_bus_t *bus);
+static void i2c_abort(i2c_bus_t *bus);
+static TickType_t i2c_transfer_deadline(i2c_bus_t *bus);
+static void i2c_record_latency(i2c_bus_t *bus, uint32_t latency_us);
+static void i2c_recovery_delay(void);
+static void i2c_irq(i2c_bus_t *bus);
+static void i2c_dma_irq(i2c_bus_t *bus);
+static i2c_bus_t *i2c_bus_of(uint8_t device_addr);
 
 #define ICR_FACTOR 0x1E
-#define I2C0_SDA_PIN 9
-#define I2C0_SCL_PIN 8
-#define I2C0_ALT_FUNC_NUM 2
+#define I2C_IRQ_PRIORITY 2
+#define I2C_DMA_MIN_THRESHOLD 2
+#define I2C_MAX_DEVICES 4
+#define I2C_ICR_COUNT 64
+#define I2C_MULT_COUNT 3
+#define I2C_GPIO_ALT_FUNC_NUM 1
+#define I2C_RECOVERY_CLOCKS 9
+#define I2C_RECOVERY_DELAY_LOOPS 50            // roughly 5 us half period of the recovery clock
+#define I2C_BITS_PER_BYTE 9                     // eight data bits and the acknowledge
 #define READ 1
 #define WRITE 0
 #define NACK 1
 #define ACK 0
 
+#if CPU_PROFILE_ENABLE
+static void i2c_delay(void);
+static bool fixed_delay_enabled = false;
+#endif
+
+static i2c_bus_t buses[I2C_BUS_COUNT] = {
+	[I2C_BUS_0] = {
+		.id = I2C_BUS_0, .base = I2C0, .port = PORTC, .gpio = PTC, .port_clock_mask = SIM_SCGC5_PORTC_MASK,
+		.clock_gate_mask = SIM_SCGC4_I2C0_MASK, .scl_pin = 8, .sda_pin = 9, .alt_func = 2,
+		.irq = I2C0_IRQn, .dma_channel = 0, .dmamux_source = 22, .dma_irq = DMA0_IRQn
+	},
+	[I2C_BUS_1] = {
+		.id = I2C_BUS_1, .base = I2C1, .port = PORTE, .gpio = PTE, .port_clock_mask = SIM_SCGC5_PORTE_MASK,
+		.clock_gate_mask = SIM_SCGC4_I2C1_MASK, .scl_pin = 1, .sda_pin = 0, .alt_func = 6,
+		.irq = I2C1_IRQn, .dma_channel = 1, .dmamux_source = 23, .dma_irq = DMA1_IRQn
+	}
+};
+static i2c_transfer_mode_t transfer_mode = I2C_MODE_INTERRUPT;
+static uint16_t dma_threshold = I2C_DMA_THRESHOLD;
+static i2c_device_t devices[I2C_MAX_DEVICES];
+static uint8_t device_count = 0;
+
+/* SCL divider for every ICR value, KL25Z reference manual I2C divider and hold values table */
+static const uint16_t scl_divider[I2C_ICR_COUNT] = {
+	20, 22, 24, 26, 28, 30, 34, 40, 28, 32, 36, 40, 44, 48, 56, 68,
+	48, 56, 64, 72, 80, 88, 104, 128, 80, 96, 112, 128, 144, 160, 192, 240,
+	160, 192, 224, 256, 288, 320, 384, 480, 320, 384, 448, 512, 576, 640, 768, 960,
+	640, 768, 896, 1024, 1152, 1280, 1536, 1920, 1280, 1536, 1792, 2048, 2304, 2560, 3072, 3840
+};
+
 
 /*
- * Description: initialises the i2c0 and enables the clock
+ * Description: initialises an i2c module with its dma channel and enables the clock
  *
  * Parameters:
- *    		None
+ *    		i2c_bus_id_t the bus to be initialised
  *
  * Returns:
  *   		None
  */
 
-void i2c0_init(void) {
+void i2c_init(i2c_bus_id_t bus_id) {
+
+	i2c_bus_t *bus = &buses[bus_id];
+
+	SIM->SCGC4 |= bus->clock_gate_mask;           // ENABLING CLOCK FOR THE I2C MODULE
+	bus->base->C1 = 0;                         // clearing all the bits and resetting
+	bus->base->F = I2C_F_ICR(ICR_FACTOR);              // setting the baud rate       // 186KHZ FREQ,
+	bus->current_f_register = bus->base->F;       // used for the slaves which are not registered
+	bus->default_scl_hz = CLOCK_GetBusClkFreq() / scl_divider[ICR_FACTOR];
+	bus->current_scl_hz = bus->default_scl_hz;
+	bus->base->C1 |= I2C_C1_IICEN_MASK;                // enabling the i2c module
+
+	SIM->SCGC6 |= SIM_SCGC6_DMAMUX_MASK;          // clocks for the dma used by long writes
+	SIM->SCGC7 |= SIM_SCGC7_DMA_MASK;
+	DMAMUX0->CHCFG[bus->dma_channel] = 0;
+	DMA0->DMA[bus->dma_channel].DSR_BCR = DMA_DSR_BCR_DONE_MASK;
+	DMAMUX0->CHCFG[bus->dma_channel] = DMAMUX_CHCFG_ENBL_MASK
+			| DMAMUX_CHCFG_SOURCE(bus->dmamux_source);
+
+	bus->transfer.state = I2C_STATE_IDLE;
+	NVIC_SetPriority(bus->irq, I2C_IRQ_PRIORITY);
+	NVIC_ClearPendingIRQ(bus->irq);
+	NVIC_EnableIRQ(bus->irq);                     // IICIE in C1 gates the interrupt per transfer
+	NVIC_SetPriority(bus->dma_irq, I2C_IRQ_PRIORITY);
+	NVIC_ClearPendingIRQ(bus->dma_irq);
+	NVIC_EnableIRQ(bus->dma_irq);
+}
+
+
+/*
+ * Description: initialises the pins of an i2c module
+ *
+ * Parameters:
+ *    		i2c_bus_id_t the bus whose pins are set up
+ *
+ * Returns:
+ *   		None
+ */
+
+
+void i2c_pins_init(i2c_bus_id_t bus_id) {
+
+	i2c_bus_t *bus = &buses[bus_id];
 
-	SIM->SCGC4 |= SIM_SCGC4_I2C0_MASK;            // ENABLING CLOCK FOR I2C0
-	I2C0->C1 = 0;                         // clearing all the bits and resetting
-	I2C0->F = I2C_F_ICR(ICR_FACTOR);              // setting the baud rate       // 186KHZ FREQ,
-	I2C0->C1 |= I2C_C1_IICEN_MASK;                // enabling the i2c module
+	SIM->SCGC5 |= bus->port_clock_mask;              // enabling clock for the port
+	bus->port->PCR[bus->scl_pin] = PORT_PCR_MUX(bus->alt_func);                     // I2C_SCL
+	bus->port->PCR[bus->sda_pin] = PORT_PCR_MUX(bus->alt_func);
+
+}
+
+
+/*
+ * Description: selects how the transfers are completed, by the i2c interrupts or by polling
+ *
+ * Parameters:
+ *    		i2c_transfer_mode_t the mode to be used for the following transfers
+ *
+ * Returns:
+ *   		None
+ */
+
+void i2c_set_transfer_mode(i2c_transfer_mode_t mode) {
+	transfer_mode = mode;
 }
 
 
 /*
- * Description: initialises the i2c0 apins
+ * Description: returns the mode currently used for the transfers
  *
  * Parameters:
  *    		None
  *
  * Returns:
+ *   		i2c_transfer_mode_t the current mode
+ */
+
+i2c_transfer_mode_t i2c_get_transfer_mode(void) {
+	return transfer_mode;
+}
+
+
+/*
+ * Description: sets the payload size from which interrupt driven writes are moved by DMA
+ *
+ * Parameters:
+ *    		uint16_t number of bytes, writes with at least this many data bytes use DMA
+ *
+ * Returns:
  *   		None
  */
 
+void i2c_set_dma_threshold(uint16_t threshold) {
+	if (threshold < I2C_DMA_MIN_THRESHOLD)
+		threshold = I2C_DMA_MIN_THRESHOLD;     // one byte is written by the ISR to trigger the first request
+	dma_threshold = threshold;
+}
 
-void i2c0_pins_init() {
 
-	SIM->SCGC5 |= SIM_SCGC5_PORTC_MASK;              // enabling clock for PORTC
-	PORTC->PCR[I2C0_SCL_PIN] = PORT_PCR_MUX(I2C0_ALT_FUNC_NUM);                     // I2C_SCL
-	PORTC->PCR[I2C0_SDA_PIN] = PORT_PCR_MUX(I2C0_ALT_FUNC_NUM);
+/*
+ * Description: finds the MULT and ICR pair giving the fastest SCL which does not exceed the maximum
+ *              of the device with the current bus clock
+ *
+ * Parameters:
+ *    		uint32_t maximum SCL frequency of the device in Hz
+ *    		uint32_t * filled with the SCL frequency the pair gives
+ *
+ * Returns:
+ *   		uint8_t the value for the F register of the module
+ */
+
+static uint8_t i2c_compute_divider(uint32_t max_scl_hz, uint32_t *scl_hz) {
+
+	uint32_t bus_clock = CLOCK_GetBusClkFreq();
+	uint32_t best_hz = 0, hz;
+	uint8_t best_f = I2C_F_MULT(I2C_MULT_COUNT - 1) | I2C_F_ICR(I2C_ICR_COUNT - 1); // slowest setting
+
+	for (uint8_t mult = 0; mult < I2C_MULT_COUNT; mult++) {
+		for (uint8_t icr = 0; icr < I2C_ICR_COUNT; icr++) {
+			hz = bus_clock / ((uint32_t) scl_divider[icr] << mult);
+			if (hz <= max_scl_hz && hz > best_hz) {
+				best_hz = hz;
+				best_f = I2C_F_MULT(mult) | I2C_F_ICR(icr);
+			}
+		}
+	}
 
+	*scl_hz = best_hz;
+	return best_f;
 }
 
 
 /*
- * Description: Send the start condition during write and read operation
+ * Description: registers a slave with its maximum SCL frequency, the transfers to it then run with the
+ *              fastest divider it supports. Registering the same address again updates its speed.
+ *
+ * Parameters:
+ *    		i2c_bus_id_t bus the slave is wired to
+ *    		uint8_t device address of the slave
+ *    		uint32_t maximum SCL frequency of the slave in Hz
+ *
+ * Returns:
+ *   		None
+ */
+
+void i2c_register_device(i2c_bus_id_t bus_id, uint8_t device_addr, uint32_t max_scl_hz) {
+
+	i2c_device_t *device = NULL;
+
+	for (uint8_t i = 0; i < device_count; i++) {
+		if (devices[i].address == device_addr)
+			device = &devices[i];
+	}
+
+	if (device == NULL) {
+		if (device_count == I2C_MAX_DEVICES)
+			return;
+		device = &devices[device_count];
+	}
+
+	device->address = device_addr;
+	device->bus = bus_id;
+	device->max_scl_hz = max_scl_hz;
+	device->f_register = i2c_compute_divider(max_scl_hz, &device->scl_hz);
+
+	if (device == &devices[device_count])
+		device_count++;
+}
+
+
+/*
+ * Description: returns the descriptor of a registered slave
+ *
  * Parameters:
  *    		uint8_t device address of the slave
+ *
+ * Returns:
+ *   		const i2c_device_t * the descriptor, NULL if the address is not registered
+ */
+
+const i2c_device_t *i2c_get_device(uint8_t device_addr) {
+
+	for (uint8_t i = 0; i < device_count; i++) {
+		if (devices[i].address == device_addr)
+			return &devices[i];
+	}
+
+	return NULL;
+}
+
+
+/*
+ * Description: returns the bus a slave was registered on, the slaves which are not registered are
+ *              addressed on I2C_BUS_0
+ *
+ * Parameters:
+ *    		uint8_t device address of the slave
+ *
+ * Returns:
+ *   		i2c_bus_id_t the bus of the slave
+ */
+
+i2c_bus_id_t i2c_device_bus(uint8_t device_addr) {
+
+	const i2c_device_t *device = i2c_get_device(device_addr);
+
+	return (device != NULL) ? device->bus : I2C_BUS_0;
+}
+
+
+/*
+ * Description: returns the bus instance a slave is addressed on
+ *
+ * Parameters:
+ *    		uint8_t device address of the slave
+ *
+ * Returns:
+ *   		i2c_bus_t * the bus of the slave
+ */
+
+static i2c_bus_t *i2c_bus_of(uint8_t device_addr) {
+	return &buses[i2c_device_bus(device_addr)];
+}
+
+
+/*
+ * Description: reprograms the baud rate for the slave of the next transfer, the register is only
+ *              written when the slave differs in speed from the previous one. Called with the bus idle.
+ *
+ * Parameters:
+ *    		i2c_bus_t * the bus of the transfer
+ *    		uint8_t device address of the slave
+ *
+ * Returns:
+ *   		None
+ */
+
+static void i2c_apply_device_speed(i2c_bus_t *bus, uint8_t device_addr) {
+
+	const i2c_device_t *device = i2c_get_device(device_addr);
+	uint8_t f_register = (device != NULL) ? device->f_register : I2C_F_ICR(ICR_FACTOR);
+
+	bus->current_scl_hz = (device != NULL) ? device->scl_hz : bus->default_scl_hz;
+	if (f_register != bus->current_f_register) {
+		bus->base->F = f_register;
+		bus->current_f_register = f_register;
+	}
+}
+
+
+/*
+ * Description: Send the start condition and the address byte, the completion of the address byte
+ *              is handled by the state machine
+ * Parameters:
+ *    		i2c_bus_t * the bus of the transfer
+ *    		uint8_t device address of the slave
  *    		uint8_t flag which states that the start is for read or write
  *
  * Returns:
  *   		None
  */
 
-static void i2c_start(uint8_t device_addr, uint8_t write_or_read) {
+static void i2c_start(i2c_bus_t *bus, uint8_t device_addr, uint8_t write_or_read) {
 
-	device_addr = (device_addr << 1 | write_or_read);
-	if (write_or_read == READ)
-		I2C0->C1 &= ~I2C_C1_TX_MASK;
-	else
-		I2C0->C1 |= I2C_C1_TX_MASK;
-	I2C0->C1 |= I2C_C1_MST_MASK;
-	I2C0->C1 |= I2C_C1_TX_MASK;
-	I2C0->D = device_addr;
-	while (!(I2C0->S & I2C_S_IICIF_MASK))
-		;
-	I2C0->S |= I2C_S_IICIF_MASK;
+	bus->base->C1 |= I2C_C1_TX_MASK;
+	bus->base->C1 |= I2C_C1_MST_MASK;                   // generates the start condition
+	bus->base->D = (uint8_t)(device_addr << 1 | write_or_read);
 
 }
 
 /*
- * Description: Send the stop condition followed by a small delay to account for transaction complete
+ * Description: Send the stop condition
  * Parameters:
  * 		None
  * Returns:
@@ -111,134 +441,741 @@ static void i2c_start(uint8_t device_addr, uint8_t write_or_read) {
  */
 
 
-static void i2c_stop(void) {
+static void i2c_stop(i2c_bus_t *bus) {
 
-	I2C0->C1 &= ~(I2C_C1_MST_MASK);
-	I2C0->C1 &= ~(I2C_C1_TX_MASK);
+	bus->base->C1 &= ~(I2C_C1_MST_MASK);
+	bus->base->C1 &= ~(I2C_C1_TX_MASK | I2C_C1_TXAK_MASK);
 }
 
+
 /*
- * Description: Sends the data to the slave collectively according to the length
+ * Description: advances the transfer state machine by one byte, it is called from the ISR or from
+ *              the polling loop every time the IICIF flag is set
  * Parameters:
- * 		uint8_t device addr the device address of the slave
- * 		uint8_t *data the data which is to be sent
- * 		int length  the length of the data to be sent
+ * 		i2c_bus_t * the bus of the transfer
  * Returns:
- *   		None
+ *   		bool true when the transfer is complete and the stop has been sent
  */
 
-void i2c_data_transmit(uint8_t device_addr, uint8_t *data, int length) {
-	i2c_start(device_addr, WRITE);
+static bool i2c_service(i2c_bus_t *bus) {
+
+	bus->base->S |= I2C_S_IICIF_MASK;  // Clear the interrupt flag
+
+	if (bus->base->S & I2C_S_ARBL_MASK) {       // lost the bus, the module has dropped back to slave mode
+		bus->base->S |= I2C_S_ARBL_MASK;
+		bus->transfer.status = I2C_STATUS_ARBITRATION_LOST;
+		i2c_stop(bus);
+		bus->transfer.state = I2C_STATE_IDLE;
+		return true;
+	}
+
+	switch (bus->transfer.state) {
+
+	case I2C_STATE_ADDRESS:
+	case I2C_STATE_TX_DATA:
+	case I2C_STATE_REGISTER:
+	case I2C_STATE_RESTART:
+		if (bus->base->S & I2C_S_RXAK_MASK) {       // slave did not acknowledge the last byte
+			bus->transfer.status = I2C_STATUS_NACK;
+			break;
+		}
+
+		if (bus->transfer.state == I2C_STATE_REGISTER) {
+			bus->base->F = bus->current_f_register & ~I2C_F_MULT_MASK;  // errata e6070, no repeated start with MULT set
+			bus->base->C1 |= I2C_C1_RSTA_MASK;         // repeated start flag set
+			bus->base->F = bus->current_f_register;
+			bus->base->D = (uint8_t)(bus->transfer.device_addr << 1 | READ);
+			bus->transfer.state = I2C_STATE_RESTART;
+			return false;
+		}
+
+		if (bus->transfer.state == I2C_STATE_RESTART) {
+			bus->base->C1 &= ~I2C_C1_TX_MASK;
+			if (bus->transfer.length == 1)
+				bus->base->C1 |= I2C_C1_TXAK_MASK;    // nack the only byte
+			else
+				bus->base->C1 &= ~I2C_C1_TXAK_MASK;
+			bus->transfer.index = 0;
+			bus->transfer.state = I2C_STATE_RX_DATA;
+			(void) bus->base->D;                      // dummy read starts the reception of the first byte
+			return false;
+		}
 
-	for (int i = 0; i < length; i++) {
+		if (bus->transfer.is_read) {
+			bus->base->D = bus->transfer.read_addr;        // sending the register address
+			bus->transfer.state = I2C_STATE_REGISTER;
+			return false;
+		}
 
-		I2C0->D = data[i];
-		while (!(I2C0->S & I2C_S_IICIF_MASK)) {
+		if (i2c_next_tx_byte(bus))
+			return false;
+		break;
 
+	case I2C_STATE_TX_DMA:
+		if (!(bus->base->S & I2C_S_TCF_MASK))       // stale flag from a dma driven byte, last byte still in flight
+			return false;
+		if (bus->base->S & I2C_S_RXAK_MASK) {
+			bus->transfer.status = I2C_STATUS_NACK;
+			break;
 		}
+		if (i2c_next_tx_byte(bus))
+			return false;
+		break;
+
+	case I2C_STATE_RX_DATA:
+		if (bus->transfer.index == bus->transfer.length - 1) {
+			i2c_stop(bus);                          // stop before reading D so no further byte is clocked
+			bus->transfer.rx_data[bus->transfer.index++] = bus->base->D;
+			bus->transfer.state = I2C_STATE_IDLE;
+			return true;
+		}
+
+		if (bus->transfer.index == bus->transfer.length - 2)
+			bus->base->C1 |= I2C_C1_TXAK_MASK;        // nack the last byte
+
+		bus->transfer.rx_data[bus->transfer.index++] = bus->base->D;
+		return false;
+
+	default:
+		break;
+	}
+
+	i2c_stop(bus);
+	bus->transfer.state = I2C_STATE_IDLE;
+	return true;
+}
+
 
-		I2C0->S |= I2C_S_IICIF_MASK;  // Clear the interrupt flag
+/*
+ * Description: sends the next byte of the write, moving on to the next segment when the current one
+ *              is done. The rest of a segment of at least dma_threshold bytes is handed to the dma.
+ * Parameters:
+ * 		i2c_bus_t * the bus of the transfer
+ * Returns:
+ *   		bool true if a byte was written, false once all the segments are sent
+ */
 
+static bool i2c_next_tx_byte(i2c_bus_t *bus) {
+
+	const i2c_iovec_t *segment;
+
+	while (bus->transfer.segment_index < bus->transfer.segment_count
+			&& bus->transfer.index >= bus->transfer.tx_segments[bus->transfer.segment_index].length) {
+		bus->transfer.segment_index++;
+		bus->transfer.index = 0;
 	}
 
-	i2c_stop();
+	if (bus->transfer.segment_index == bus->transfer.segment_count)
+		return false;
+
+	segment = &bus->transfer.tx_segments[bus->transfer.segment_index];
 
-	i2c_delay();
+	if (bus->transfer.use_dma && segment->length - bus->transfer.index >= dma_threshold) {
+		i2c_start_dma(bus, segment);
+		return true;
+	}
+
+	bus->base->D = segment->data[bus->transfer.index++];
+	bus->transfer.state = I2C_STATE_TX_DATA;
+	return true;
 }
 
 
+/*
+ * Description: hands the rest of the segment to the dma. The first byte is written here, its completion
+ *              raises the first dma request and every following byte completion raises the next one.
+ *              The i2c interrupt stays off until the DMA ISR sees the channel done.
+ * Parameters:
+ * 		i2c_bus_t * the bus of the transfer
+ * 		const i2c_iovec_t * the segment being sent
+ * Returns:
+ *   		None
+ */
+
+static void i2c_start_dma(i2c_bus_t *bus, const i2c_iovec_t *segment) {
+
+	int remaining = segment->length - bus->transfer.index - 1;
+
+	DMA0->DMA[bus->dma_channel].DSR_BCR = DMA_DSR_BCR_DONE_MASK;
+	DMA0->DMA[bus->dma_channel].SAR = (uint32_t) &segment->data[bus->transfer.index + 1];
+	DMA0->DMA[bus->dma_channel].DAR = (uint32_t) &bus->base->D;
+	DMA0->DMA[bus->dma_channel].DSR_BCR = DMA_DSR_BCR_BCR(remaining);
+	DMA0->DMA[bus->dma_channel].DCR = DMA_DCR_EINT_MASK | DMA_DCR_ERQ_MASK
+			| DMA_DCR_CS_MASK | DMA_DCR_SINC_MASK | DMA_DCR_SSIZE(1)
+			| DMA_DCR_DSIZE(1) | DMA_DCR_D_REQ_MASK;   // byte wide, one byte per request
+
+	bus->base->C1 &= ~I2C_C1_IICIE_MASK;
+	bus->base->C1 |= I2C_C1_DMAEN_MASK;
+	bus->base->D = segment->data[bus->transfer.index];
+	bus->transfer.index = segment->length;
+	bus->transfer.state = I2C_STATE_TX_DMA;
+}
+
 
 /*
- * Description: produces a small delay to give time for transaction to complete
+ * Description: finishes the transfer from interrupt context and runs the completion callback
+ * Parameters:
+ * 		i2c_bus_t * the bus of the transfer
+ * Returns:
+ *   		None
+ */
+
+static void i2c_complete_from_isr(i2c_bus_t *bus) {
+
+	bus->base->C1 &= ~(I2C_C1_IICIE_MASK | I2C_C1_DMAEN_MASK);
+	if (bus->transfer.callback != NULL)
+		bus->transfer.callback(bus->transfer.status, bus->transfer.callback_context);
+}
+
+
+/*
+ * Description: completion callback of the blocking transfers, wakes the task waiting for the transfer
+ * Parameters:
+ * 		i2c_status_t result of the transfer, the waiting task reads it from the transfer structure
+ * 		void * the handle of the waiting task
+ * Returns:
+ *   		None
+ */
+
+static void i2c_notify_task(i2c_status_t status, void *context) {
+
+	BaseType_t higher_priority_task_woken = pdFALSE;
+
+	vTaskNotifyGiveFromISR((TaskHandle_t) context, &higher_priority_task_woken);
+	portYIELD_FROM_ISR(higher_priority_task_woken);
+}
+
+
+/*
+ * Description: interrupt of an i2c module, moves the bytes and completes the transfer once the stop is sent
+ * Parameters:
+ * 		i2c_bus_t * the bus which raised the interrupt
+ * Returns:
+ *   		None
+ */
+
+static void i2c_irq(i2c_bus_t *bus) {
+
+	if (i2c_service(bus))
+		i2c_complete_from_isr(bus);
+}
+
+
+/*
+ * Description: I2C0 interrupt handler
  * Parameters:
  * 		None
  * Returns:
  *   		None
  */
-static void i2c_delay(void){
-	for (int i = 0; i < 1000; i++)
-		;
 
+void I2C0_IRQHandler(void) {
+	i2c_irq(&buses[I2C_BUS_0]);
 }
 
 
 /*
- * Description: reads the data from the slave collectively according to the length asked
+ * Description: I2C1 interrupt handler
  * Parameters:
- * 		uint8_t device addr the device address of the slave
- * 		uint8_t read_addr  address of the register to be read from the slave
- * 		uint8_t *data the data buffer to store the read data
- * 		uint8_t length  the length of the data to be read
+ * 		None
  * Returns:
  *   		None
  */
 
-void i2c_read_bytes(uint8_t device_addr, uint8_t read_addr, uint8_t *rx_buffer,
-		uint8_t length) {
+void I2C1_IRQHandler(void) {
+	i2c_irq(&buses[I2C_BUS_1]);
+}
 
-	i2c_start(device_addr, WRITE);
 
-	while (!(I2C0->S & I2C_S_TCF_MASK)) {
+/*
+ * Description: interrupt of the dma channel of a bus, the dma has written the last byte of the payload to
+ *              the data register. The i2c interrupt is turned back on to catch the completion of that byte
+ *              and send the stop.
+ * Parameters:
+ * 		i2c_bus_t * the bus whose channel is done
+ * Returns:
+ *   		None
+ */
 
+static void i2c_dma_irq(i2c_bus_t *bus) {
+
+	uint32_t dma_status = DMA0->DMA[bus->dma_channel].DSR_BCR;
+
+	DMA0->DMA[bus->dma_channel].DSR_BCR = DMA_DSR_BCR_DONE_MASK;
+	bus->base->C1 &= ~I2C_C1_DMAEN_MASK;
+
+	if (dma_status & (DMA_DSR_BCR_CE_MASK | DMA_DSR_BCR_BES_MASK | DMA_DSR_BCR_BED_MASK)) {
+		bus->transfer.status = I2C_STATUS_DMA_ERROR;
+		i2c_stop(bus);
+		bus->transfer.state = I2C_STATE_IDLE;
+		i2c_complete_from_isr(bus);
+		return;
 	}
 
-	I2C0->D = read_addr;        // sending the register address
+	bus->base->C1 |= I2C_C1_IICIE_MASK;
+}
+
+
+/*
+ * Description: DMA channel 0 interrupt handler, channel of I2C0
+ * Parameters:
+ * 		None
+ * Returns:
+ *   		None
+ */
+
+void DMA0_IRQHandler(void) {
+	i2c_dma_irq(&buses[I2C_BUS_0]);
+}
+
+
+/*
+ * Description: DMA channel 1 interrupt handler, channel of I2C1
+ * Parameters:
+ * 		None
+ * Returns:
+ *   		None
+ */
+
+void DMA1_IRQHandler(void) {
+	i2c_dma_irq(&buses[I2C_BUS_1]);
+}
 
-	while (!(I2C0->S & I2C_S_IICIF_MASK)) {
 
+/*
+ * Description: resets the transfer state machine and the flags left from the previous transfer. A bus
+ *              which stays busy is recovered once before giving up.
+ * Parameters:
+ * 		i2c_bus_t * the bus of the transfer
+ * Returns:
+ *   		i2c_status_t I2C_STATUS_OK when the transfer can be started, I2C_STATUS_BUS_BUSY otherwise
+ */
+
+static i2c_status_t i2c_begin_transfer(i2c_bus_t *bus) {
+
+	if (!i2c_wait_bus_idle(bus)) {           // the stop of the previous transfer may still be on the bus
+		i2c_bus_recover(bus->id);
+		if (!i2c_wait_bus_idle(bus))
+			return I2C_STATUS_BUS_BUSY;
 	}
-	I2C0->S |= I2C_S_IICIF_MASK;  // Clear the interrupt flag
+	i2c_apply_device_speed(bus, bus->transfer.device_addr);
 
-	I2C0->C1 |= I2C_C1_RSTA_MASK;         // repeated start flag set
+	bus->transfer.index = 0;
+	bus->transfer.segment_index = 0;
+	bus->transfer.status = I2C_STATUS_OK;
+	bus->transfer.start_cycles = cycle_counter_now();
+	bus->transfer.state = I2C_STATE_ADDRESS;
+	bus->base->S |= I2C_S_IICIF_MASK;
+	bus->base->FLT |= I2C_FLT_STOPF_MASK;     // cleared here so it flags the stop of this transfer
+	return I2C_STATUS_OK;
+}
 
-	rx_buffer[0] = I2C0->D;
-	i2c_start(device_addr, READ);
 
-	while (!(I2C0->S & I2C_S_TCF_MASK))
-		;
+/*
+ * Description: waits until the stop has been detected on the bus and the bus is no more busy. This takes
+ *              about half a SCL period after the stop is requested, the wait gives up after
+ *              I2C_IDLE_TIMEOUT_POLLS reads of the status registers unless that is 0.
+ * Parameters:
+ * 		i2c_bus_t * the bus of the transfer
+ * Returns:
+ *   		bool true if the bus is idle, false if the wait timed out
+ */
 
-	i2c_delay();
+static bool i2c_wait_bus_idle(i2c_bus_t *bus) {
 
-	for (int i = 0; i < length; i++) {
-		rx_buffer[i] = read_single_byte(true, i == (length - 1));
+	uint32_t polls = 0;
 
+	while (!(bus->base->FLT & I2C_FLT_STOPF_MASK) && (bus->base->S & I2C_S_BUSY_MASK)) {
+		if (I2C_IDLE_TIMEOUT_POLLS != 0 && ++polls >= I2C_IDLE_TIMEOUT_POLLS)
+			return false;
 	}
 
-	i2c_stop();
+	return true;
+}
+
 
+/*
+ * Description: works out how long the transfer may take, twice the time of its bytes at the current SCL
+ *              frequency plus I2C_TIMEOUT_MARGIN_MS for clock stretching and the scheduling of the task
+ * Parameters:
+ * 		i2c_bus_t * the bus of the transfer
+ * Returns:
+ *   		TickType_t the deadline in ticks from the start of the transfer
+ */
+
+static TickType_t i2c_transfer_deadline(i2c_bus_t *bus) {
+
+	uint32_t bytes = 1, transfer_ms;            // address byte
+
+	if (bus->transfer.is_read)
+		bytes += 2 + bus->transfer.length;          // register and read address
+	for (uint8_t i = 0; i < bus->transfer.segment_count; i++)
+		bytes += bus->transfer.tx_segments[i].length;
+
+	transfer_ms = (bytes * I2C_BITS_PER_BYTE * 2000U) / bus->current_scl_hz;
+
+	return pdMS_TO_TICKS(transfer_ms + I2C_TIMEOUT_MARGIN_MS) + 1;
 }
+
+
 /*
- * Description: reads a single data from the slave
+ * Description: stops a transfer which has not completed in time. No interrupt of the transfer can come
+ *              after this, a completion given just before is dropped by the caller.
  * Parameters:
- * 		bool  specifies is it a repeated read or read after sending the stop
- * 		uint8_t tells is it the last read byte, if not then send ack otherwise send nack
- *
+ * 		i2c_bus_t * the bus of the transfer
  * Returns:
- *   		uint8_t the read byte
+ *   		None
  */
 
-static uint8_t read_single_byte(bool is_repeated_read, uint8_t ack_or_nack) {
-	uint8_t return_data;
-	I2C0->C1 &= ~I2C_C1_TX_MASK;
-	if (ack_or_nack)
-		I2C0->C1 |= I2C_C1_TXAK_MASK;
-	else
-		I2C0->C1 &= ~I2C_C1_TXAK_MASK;
+static void i2c_abort(i2c_bus_t *bus) {
+
+	bus->base->C1 &= ~(I2C_C1_IICIE_MASK | I2C_C1_DMAEN_MASK);
+	DMA0->DMA[bus->dma_channel].DCR = 0;
+	DMA0->DMA[bus->dma_channel].DSR_BCR = DMA_DSR_BCR_DONE_MASK;
+	NVIC_ClearPendingIRQ(bus->irq);
+	NVIC_ClearPendingIRQ(bus->dma_irq);
+	i2c_stop(bus);
+	bus->transfer.state = I2C_STATE_IDLE;
+	bus->transfer.status = I2C_STATUS_TIMEOUT;
+	bus->latency_histogram.timeouts++;
+}
 
-	if (is_repeated_read == true)
-		return_data = I2C0->D;
 
-	while (!(I2C0->S & I2C_S_IICIF_MASK))
+/*
+ * Description: runs the transfer described by the transfer structure to completion, either by blocking
+ *              on the task notification or by polling when the scheduler is not running yet. Both wait at
+ *              most until the deadline of the transfer, then the transfer is aborted and the bus recovered.
+ * Parameters:
+ * 		i2c_bus_t * the bus of the transfer
+ * Returns:
+ *   		i2c_status_t the result of the transfer
+ */
+
+static i2c_status_t i2c_run_transfer(i2c_bus_t *bus) {
+
+	bool scheduler_running = (xTaskGetSchedulerState() == taskSCHEDULER_RUNNING);
+	uint32_t polls;
+
+	if (i2c_begin_transfer(bus) != I2C_STATUS_OK)
+		return I2C_STATUS_BUS_BUSY;
+
+	if (transfer_mode == I2C_MODE_INTERRUPT && scheduler_running) {
+		bus->transfer.use_dma = !bus->transfer.is_read;
+		bus->transfer.callback = i2c_notify_task;
+		bus->transfer.callback_context = xTaskGetCurrentTaskHandle();
+		bus->base->C1 |= I2C_C1_IICIE_MASK;
+		i2c_start(bus, bus->transfer.device_addr, WRITE);
+		if (ulTaskNotifyTake(pdTRUE, i2c_transfer_deadline(bus)) == 0) {
+			i2c_abort(bus);
+			ulTaskNotifyTake(pdTRUE, 0);      // completion which raced with the deadline
+		}
+	} else {
+		bus->transfer.use_dma = false;
+		bus->transfer.callback = NULL;
+		i2c_start(bus, bus->transfer.device_addr, WRITE);
+		do {
+			polls = 0;
+			while (!(bus->base->S & I2C_S_IICIF_MASK) && ++polls < I2C_POLL_TIMEOUT_POLLS)
+				;
+			if (polls == I2C_POLL_TIMEOUT_POLLS) {
+				i2c_abort(bus);
+				break;
+			}
+		} while (!i2c_service(bus));
+	}
+
+	if (bus->transfer.status == I2C_STATUS_TIMEOUT
+			|| bus->transfer.status == I2C_STATUS_ARBITRATION_LOST
+			|| !i2c_wait_bus_idle(bus))
+		i2c_bus_recover(bus->id);
+
+	if (scheduler_running)
+		i2c_record_latency(bus, cycle_counter_to_us(cycle_counter_now() - bus->transfer.start_cycles));
+
+	return bus->transfer.status;
+}
+
+
+/*
+ * Description: frees a bus held low by a slave. The pins are taken from the module, SCL (PTC8 on I2C0) is
+ *              clocked nine times as a GPIO so a slave stuck in the middle of a byte can finish it, a STOP is
+ *              sent and the module is initialised again. The registered speed profiles are kept.
+ * Parameters:
+ * 		i2c_bus_id_t the bus to be recovered
+ * Returns:
+ *   		None
+ */
+
+void i2c_bus_recover(i2c_bus_id_t bus_id) {
+
+	i2c_bus_t *bus = &buses[bus_id];
+	uint32_t scl = 1U << bus->scl_pin, sda = 1U << bus->sda_pin;
+
+	bus->base->C1 = 0;
+	bus->gpio->PDDR &= ~sda;                              // SDA released, pulled up externally
+	bus->gpio->PSOR = scl;
+	bus->gpio->PDDR |= scl;
+	bus->port->PCR[bus->scl_pin] = PORT_PCR_MUX(I2C_GPIO_ALT_FUNC_NUM);
+	bus->port->PCR[bus->sda_pin] = PORT_PCR_MUX(I2C_GPIO_ALT_FUNC_NUM);
+
+	for (int i = 0; i < I2C_RECOVERY_CLOCKS; i++) {
+		bus->gpio->PCOR = scl;
+		i2c_recovery_delay();
+		bus->gpio->PSOR = scl;
+		i2c_recovery_delay();
+	}
+
+	bus->gpio->PCOR = scl;                                // STOP, SDA rises while SCL is high
+	bus->gpio->PCOR = sda;
+	bus->gpio->PDDR |= sda;
+	i2c_recovery_delay();
+	bus->gpio->PSOR = scl;
+	i2c_recovery_delay();
+	bus->gpio->PSOR = sda;
+	i2c_recovery_delay();
+	bus->gpio->PDDR &= ~(scl | sda);
+
+	i2c_pins_init(bus_id);
+	i2c_init(bus_id);
+	bus->latency_histogram.recoveries++;
+}
+
+
+/*
+ * Description: half period of the clock sent during the bus recovery
+ * Parameters:
+ * 		None
+ * Returns:
+ *   		None
+ */
+
+static void i2c_recovery_delay(void) {
+	for (volatile int i = 0; i < I2C_RECOVERY_DELAY_LOOPS; i++)
 		;
-	I2C0->S |= I2C_S_IICIF_MASK;
+}
 
-	if (ack_or_nack == NACK)
-		I2C0->C1 &= ~(I2C_C1_MST_MASK);
 
-	return_data = I2C0->D;
+/*
+ * Description: adds the duration of a transfer to the histogram, bucket n counts the transfers which took
+ *              2^n to 2^(n+1) - 1 micro seconds and the last bucket everything longer
+ * Parameters:
+ * 		i2c_bus_t * the bus of the transfer
+ * 		uint32_t duration of the transfer in micro seconds
+ * Returns:
+ *   		None
+ */
+
+static void i2c_record_latency(i2c_bus_t *bus, uint32_t latency_us) {
+
+	uint8_t bucket = 0;
+
+	while ((latency_us >> (bucket + 1)) != 0 && bucket < I2C_LATENCY_BUCKETS - 1)
+		bucket++;
+
+	bus->latency_histogram.bucket[bucket]++;
+	if (latency_us > bus->latency_histogram.max_us)
+		bus->latency_histogram.max_us = latency_us;
+}
+
+
+/*
+ * Description: copies the transfer latency histogram with the timeout and recovery counters
+ * Parameters:
+ * 		i2c_bus_id_t the bus whose transfers are looked at
+ * 		i2c_latency_histogram_t * the structure to be filled
+ * Returns:
+ *   		None
+ */
+
+void i2c_get_latency_histogram(i2c_bus_id_t bus_id, i2c_latency_histogram_t *histogram) {
+	*histogram = buses[bus_id].latency_histogram;
+}
+
+/*
+ * Description: Sends the data to the slave collectively according to the length
+ * Parameters:
+ * 		uint8_t device addr the device address of the slave
+ * 		uint8_t *data the data which is to be sent
+ * 		int length  the length of the data to be sent
+ * Returns:
+ *   		i2c_status_t the result of the transfer
+ */
+
+i2c_status_t i2c_data_transmit(uint8_t device_addr, uint8_t *data, int length) {
+
+	i2c_bus_t *bus = i2c_bus_of(device_addr);
+
+	bus->transfer.single_segment.data = data;
+	bus->transfer.single_segment.length = length;
+	return i2c_transmitv(device_addr, &bus->transfer.single_segment, 1);
+}
+
+
+/*
+ * Description: Sends several segments to the slave in one transaction, without copying them into one buffer
+ * Parameters:
+ * 		uint8_t device addr the device address of the slave
+ * 		const i2c_iovec_t * the segments to be sent one after the other
+ * 		uint8_t number of segments
+ * Returns:
+ *   		i2c_status_t the result of the transfer
+ */
+
+i2c_status_t i2c_transmitv(uint8_t device_addr, const i2c_iovec_t *segments, uint8_t count) {
+
+	i2c_bus_t *bus = i2c_bus_of(device_addr);
+	i2c_status_t status;
+#if I2C_TRACE_ENABLE
+	uint32_t start_cycles = cycle_counter_now();
+	uint16_t bytes = 0;
+
+	for (uint8_t i = 0; i < count; i++)
+		bytes += segments[i].length;
+#endif
+
+	bus->transfer.device_addr = device_addr;
+	bus->transfer.is_read = false;
+	bus->transfer.tx_segments = segments;
+	bus->transfer.segment_count = count;
+	bus->transfer.rx_data = NULL;
+
+	status = i2c_run_transfer(bus);
+
+#if I2C_TRACE_ENABLE
+	i2c_trace_record(device_addr, false, bytes, start_cycles, status);
+#endif
+
+#if CPU_PROFILE_ENABLE
+	if (fixed_delay_enabled)
+		i2c_delay();
+#endif
+	return status;
+}
+
+
+
+/*
+ * Description: starts a write and returns at once, the stop and the callback are issued from the
+ *              interrupt handlers when the last byte is sent. The data must stay valid until then and
+ *              no other transfer may be started before the callback has run.
+ * Parameters:
+ * 		uint8_t device addr the device address of the slave
+ * 		const uint8_t *data the data which is to be sent
+ * 		int length  the length of the data to be sent
+ * 		i2c_callback_t called from interrupt context once the transfer is complete
+ * 		void * passed to the callback
+ * Returns:
+ *   		i2c_status_t I2C_STATUS_OK if the transfer was started, the callback is not run otherwise
+ */
 
-	return return_data;
+i2c_status_t i2c_data_transmit_async(uint8_t device_addr, const uint8_t *data, int length,
+		i2c_callback_t callback, void *context) {
 
+	i2c_bus_t *bus = i2c_bus_of(device_addr);
+
+	bus->transfer.single_segment.data = data;
+	bus->transfer.single_segment.length = length;
+	return i2c_transmitv_async(device_addr, &bus->transfer.single_segment, 1, callback, context);
 }
 
 
+/*
+ * Description: scatter gather version of i2c_data_transmit_async, the segments and their data must stay
+ *              valid until the callback has run
+ * Parameters:
+ * 		uint8_t device addr the device address of the slave
+ * 		const i2c_iovec_t * the segments to be sent one after the other
+ * 		uint8_t number of segments
+ * 		i2c_callback_t called from interrupt context once the transfer is complete
+ * 		void * passed to the callback
+ * Returns:
+ *   		i2c_status_t I2C_STATUS_OK if the transfer was started, the callback is not run otherwise
+ */
+
+i2c_status_t i2c_transmitv_async(uint8_t device_addr, const i2c_iovec_t *segments, uint8_t count,
+		i2c_callback_t callback, void *context) {
+
+	i2c_bus_t *bus = i2c_bus_of(device_addr);
+
+	bus->transfer.device_addr = device_addr;
+	bus->transfer.is_read = false;
+	bus->transfer.tx_segments = segments;
+	bus->transfer.segment_count = count;
+	bus->transfer.rx_data = NULL;
+
+	if (i2c_begin_transfer(bus) != I2C_STATUS_OK)
+		return I2C_STATUS_BUS_BUSY;
+	bus->transfer.use_dma = true;
+	bus->transfer.callback = callback;
+	bus->transfer.callback_context = context;
+	bus->base->C1 |= I2C_C1_IICIE_MASK;
+	i2c_start(bus, bus->transfer.device_addr, WRITE);
+	return I2C_STATUS_OK;
+}
+
+
+#if CPU_PROFILE_ENABLE
+/*
+ * Description: adds back the fixed delay which was used after every write before the bus idle
+ *              detection, only used to benchmark the two against each other
+ * Parameters:
+ * 		bool true to delay after every write
+ * Returns:
+ *   		None
+ */
+void i2c_set_fixed_delay(bool enable) {
+	fixed_delay_enabled = enable;
+}
+
+
+/*
+ * Description: produces a small delay to give time for transaction to complete
+ * Parameters:
+ * 		None
+ * Returns:
+ *   		None
+ */
+static void i2c_delay(void){
+	for (volatile int i = 0; i < 1000; i++)
+		;
+
+}
+#endif
+
+
+/*
+ * Description: reads the data from the slave collectively according to the length asked
+ * Parameters:
+ * 		uint8_t device addr the device address of the slave
+ * 		uint8_t read_addr  address of the register to be read from the slave
+ * 		uint8_t *data the data buffer to store the read data
+ * 		uint8_t length  the length of the data to be read
+ * Returns:
+ *   		i2c_status_t the result of the transfer
+ */
+
+i2c_status_t i2c_read_bytes(uint8_t device_addr, uint8_t read_addr, uint8_t *rx_buffer,
+		uint8_t length) {
+
+	i2c_bus_t *bus = i2c_bus_of(device_addr);
+
+	if (length == 0)
+		return I2C_STATUS_OK;
+
+	bus->transfer.device_addr = device_addr;
+	bus->transfer.read_addr = read_addr;
+	bus->transfer.is_read = true;
+	bus->transfer.segment_count = 0;
+	bus->transfer.rx_data = rx_buffer;
+	bus->transfer.length = length;
+
+#if I2C_TRACE_ENABLE
+	uint32_t start_cycles = cycle_counter_now();
+	i2c_status_t status = i2c_run_transfer(bus);
+
+	i2c_trace_record(device_addr, true, length, start_cycles, status);
+	return status;
+#else
+	return i2c_run_transfer(bus);
+#endif
+}
@@ -21,9 +21,117 @@
 #define I2C_H_
 
 #include"stdint.h"
+#include "stdbool.h"
 
-void i2c_data_transmit(uint8_t device_addr, uint8_t *data, int length);
-void i2c_read_bytes(uint8_t device_addr, uint8_t read_addr, uint8_t *rx_buffer, uint8_t length);
-void i2c0_pins_init();
-void i2c0_init(void);
+/* i2c modules of the KL25Z, I2C0 on PTC8 (SCL) / PTC9 (SDA) and I2C1 on PTE1 (SCL) / PTE0 (SDA) */
+typedef enum {
+	I2C_BUS_0,
+	I2C_BUS_1,
+	I2C_BUS_COUNT
+} i2c_bus_id_t;
+
+/*
+ * In interrupt mode the bytes are moved by the ISR of the bus and the calling task blocks on its
+ * task notification until the stop is sent, so task notifications of a task doing i2c
+ * transfers are reserved for the i2c driver. Polled mode spins on the IICIF flag and is
+ * used automatically before the scheduler is started.
+ */
+typedef enum {
+	I2C_MODE_POLLED,
+	I2C_MODE_INTERRUPT
+} i2c_transfer_mode_t;
+
+/*
+ * Writes with at least this many data bytes are fed to the data register by the DMA channel of the
+ * bus (channel 0 for I2C0, 1 for I2C1) when interrupt mode is used, shorter ones are moved byte by
+ * byte by the ISR.
+ */
+#ifndef I2C_DMA_THRESHOLD
+#define I2C_DMA_THRESHOLD 16
+#endif
+
+/*
+ * Number of status register reads after which the wait for the stop to be detected on the bus
+ * gives up, 0 waits without a bound.
+ */
+#ifndef I2C_IDLE_TIMEOUT_POLLS
+#define I2C_IDLE_TIMEOUT_POLLS 2000
+#endif
+
+/*
+ * Number of status register reads after which a polled transfer waiting for the next byte gives up,
+ * aborts the transfer and recovers the bus.
+ */
+#ifndef I2C_POLL_TIMEOUT_POLLS
+#define I2C_POLL_TIMEOUT_POLLS 20000
+#endif
+
+/*
+ * Added to twice the time the bytes of a transfer take on the bus to get its deadline, covers the
+ * clock stretching of the slaves and the tick granularity.
+ */
+#ifndef I2C_TIMEOUT_MARGIN_MS
+#define I2C_TIMEOUT_MARGIN_MS 5
+#endif
+
+#define I2C_LATENCY_BUCKETS 16
+
+typedef enum {
+	I2C_STATUS_OK,
+	I2C_STATUS_NACK,                // address or data byte not acknowledged by the slave
+	I2C_STATUS_ARBITRATION_LOST,    // SDA did not follow the master, the bus is recovered
+	I2C_STATUS_TIMEOUT,             // deadline of the transfer passed, the bus is recovered
+	I2C_STATUS_DMA_ERROR,
+	I2C_STATUS_BUS_BUSY             // bus still busy after a recovery, the transfer was not started
+} i2c_status_t;
+
+typedef void (*i2c_callback_t)(i2c_status_t status, void *context);
+
+/* log2 histogram of the blocking transfer durations, bucket n counts 2^n to 2^(n+1) - 1 us */
+typedef struct {
+	uint32_t bucket[I2C_LATENCY_BUCKETS];
+	uint32_t max_us;
+	uint32_t timeouts;
+	uint32_t recoveries;
+} i2c_latency_histogram_t;
+
+/* one contiguous piece of a write, the pieces of a write are sent back to back in one transaction */
+typedef struct {
+	const uint8_t *data;
+	int length;
+} i2c_iovec_t;
+
+/*
+ * Speed profile of a slave, the MULT/ICR pair is computed from the bus clock when the slave is
+ * registered and the F register of its bus is reprogrammed between transfers when the addressed
+ * slave changes. The transfers to a slave run on the bus it was registered on.
+ */
+typedef struct {
+	uint8_t address;
+	i2c_bus_id_t bus;
+	uint32_t max_scl_hz;
+	uint32_t scl_hz;            // SCL frequency given by f_register
+	uint8_t f_register;         // MULT and ICR fields of the F register
+} i2c_device_t;
+
+i2c_status_t i2c_data_transmit(uint8_t device_addr, uint8_t *data, int length);
+i2c_status_t i2c_data_transmit_async(uint8_t device_addr, const uint8_t *data, int length,
+		i2c_callback_t callback, void *context);
+i2c_status_t i2c_transmitv(uint8_t device_addr, const i2c_iovec_t *segments, uint8_t count);
+i2c_status_t i2c_transmitv_async(uint8_t device_addr, const i2c_iovec_t *segments, uint8_t count,
+		i2c_callback_t callback, void *context);
+i2c_status_t i2c_read_bytes(uint8_t device_addr, uint8_t read_addr, uint8_t *rx_buffer, uint8_t length);
+void i2c_pins_init(i2c_bus_id_t bus_id);
+void i2c_init(i2c_bus_id_t bus_id);
+void i2c_set_transfer_mode(i2c_transfer_mode_t mode);
+i2c_transfer_mode_t i2c_get_transfer_mode(void);
+void i2c_set_dma_threshold(uint16_t threshold);
+void i2c_register_device(i2c_bus_id_t bus_id, uint8_t device_addr, uint32_t max_scl_hz);
+const i2c_device_t *i2c_get_device(uint8_t device_addr);
+i2c_bus_id_t i2c_device_bus(uint8_t device_addr);
+void i2c_bus_recover(i2c_bus_id_t bus_id);
+void i2c_get_latency_histogram(i2c_bus_id_t bus_id, i2c_latency_histogram_t *histogram);
+#if CPU_PROFILE_ENABLE
+void i2c_set_fixed_delay(bool enable);
+#endif
 #endif /* I2C_H_ */
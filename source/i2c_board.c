@@ -0,0 +1,44 @@
+/*******************************************************************************
+ * Copyright (C) 2023 by PRANJAL GUPTA
+ *
+ * Redistribution, modification or use of this software in source or binary
+ * forms is permitted as long as the files maintain this copyright. Users are
+ * permitted to modify this and use it to learn about the field of embedded
+ * software. PRANJAL GUPTA and the University of Colorado are not liable for
+ * any misuse of this material.
+ * ****************************************************************************/
+
+/**
+ * @file    i2c_board.c
+ * @brief   This file initialises the i2c buses used on the board and registers every slave on its bus
+ *          with its speed profile.
+ *
+ * @author  Pranjal Gupta
+ * @date    12/16/2023
+ *
+ */
+#include "i2c_board.h"
+#include "DS3231.h"
+#include "oled_driver.h"
+
+/*
+ * Description: initialises the buses the slaves are wired to and registers the slaves, it has to be
+ *              called before the first transfer
+ * Parameters:
+ * 		None
+ * Returns:
+ *   		None
+ */
+
+void i2c_board_init(void) {
+
+	i2c_init(DS3231_I2C_BUS);
+	i2c_pins_init(DS3231_I2C_BUS);
+	if (OLED_I2C_BUS != DS3231_I2C_BUS) {
+		i2c_init(OLED_I2C_BUS);
+		i2c_pins_init(OLED_I2C_BUS);
+	}
+
+	i2c_register_device(DS3231_I2C_BUS, DS3231_ADDRESS, DS3231_MAX_SCL_HZ);
+	i2c_register_device(OLED_I2C_BUS, OLED_ADDRESS, OLED_MAX_SCL_HZ);
+}
@@ -0,0 +1,39 @@
+/*******************************************************************************
+ * Copyright (C) 2023 by PRANJAL GUPTA
+ *
+ * Redistribution, modification or use of this software in source or binary
+ * forms is permitted as long as the files maintain this copyright. Users are
+ * permitted to modify this and use it to learn about the field of embedded
+ * software. PRANJAL GUPTA and the University of Colorado are not liable for
+ * any misuse of this material.
+ * ****************************************************************************/
+
+/**
+ * @file    i2c_board.h
+ * @brief   This file maps the i2c slaves of the board to the bus they are wired to.
+ *
+ * @author  Pranjal Gupta
+ * @date    12/16/2023
+ *
+ */
+
+#ifndef I2C_BOARD_H_
+#define I2C_BOARD_H_
+
+#include "i2c.h"
+
+/*
+ * The RTC stays on I2C0 (PTC8/PTC9) and the display is moved to I2C1 (PTE1/PTE0) so the frame
+ * pushes do not delay the RTC reads. Both can be set to the same bus to run everything on one.
+ */
+#ifndef DS3231_I2C_BUS
+#define DS3231_I2C_BUS I2C_BUS_0
+#endif
+
+#ifndef OLED_I2C_BUS
+#define OLED_I2C_BUS I2C_BUS_1
+#endif
+
+void i2c_board_init(void);
+
+#endif /* I2C_BOARD_H_ */
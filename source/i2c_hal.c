@@ -0,0 +1,87 @@
+/*******************************************************************************
+ * Copyright (C) 2023 by PRANJAL GUPTA
+ *
+ * Redistribution, modification or use of this software in source or binary
+ * forms is permitted as long as the files maintain this copyright. Users are
+ * permitted to modify this and use it to learn about the field of embedded
+ * software. PRANJAL GUPTA and the University of Colorado are not liable for
+ * any misuse of this material.
+ * ****************************************************************************/
+
+/**
+ * @file    i2c_hal.c
+ * @brief   This file forwards the transactions of the device drivers to the selected bus backend. It has
+ *          no dependency on the target and is also built for the host.
+ *
+ * @author  Pranjal Gupta
+ * @date    12/18/2023
+ *
+ */
+#include "i2c_hal.h"
+#include "stddef.h"
+
+static const i2c_hal_ops_t *hal_ops = NULL;
+
+/*
+ * Description: selects the backend which runs the transactions, it has to be called before the first
+ *              transaction of a driver
+ * Parameters:
+ * 		const i2c_hal_ops_t * the functions of the backend
+ * Returns:
+ *   		None
+ */
+
+void i2c_hal_set_ops(const i2c_hal_ops_t *ops) {
+	hal_ops = ops;
+}
+
+/*
+ * Description: writes one buffer to the slave
+ * Parameters:
+ * 		i2c_priority_t priority of the transaction
+ * 		uint8_t device addr the device address of the slave
+ * 		const uint8_t *data the data which is to be sent
+ * 		int length  the length of the data to be sent
+ * Returns:
+ *   		i2c_status_t the result of the transaction
+ */
+
+i2c_status_t i2c_hal_transmit(i2c_priority_t priority, uint8_t device_addr, const uint8_t *data, int length) {
+
+	i2c_iovec_t segment = { data, length };
+
+	return hal_ops->transmitv(priority, device_addr, &segment, 1);
+}
+
+/*
+ * Description: writes several segments to the slave in one transaction
+ * Parameters:
+ * 		i2c_priority_t priority of the transaction
+ * 		uint8_t device addr the device address of the slave
+ * 		const i2c_iovec_t * the segments to be sent one after the other
+ * 		uint8_t number of segments
+ * Returns:
+ *   		i2c_status_t the result of the transaction
+ */
+
+i2c_status_t i2c_hal_transmitv(i2c_priority_t priority, uint8_t device_addr,
+		const i2c_iovec_t *segments, uint8_t count) {
+	return hal_ops->transmitv(priority, device_addr, segments, count);
+}
+
+/*
+ * Description: reads the registers of the slave starting at read_addr
+ * Parameters:
+ * 		i2c_priority_t priority of the transaction
+ * 		uint8_t device addr the device address of the slave
+ * 		uint8_t read_addr  address of the register to be read from the slave
+ * 		uint8_t *rx_buffer the data buffer to store the read data
+ * 		uint8_t length  the length of the data to be read
+ * Returns:
+ *   		i2c_status_t the result of the transaction
+ */
+
+i2c_status_t i2c_hal_read(i2c_priority_t priority, uint8_t device_addr, uint8_t read_addr,
+		uint8_t *rx_buffer, uint8_t length) {
+	return hal_ops->read(priority, device_addr, read_addr, rx_buffer, length);
+}
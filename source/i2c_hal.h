@@ -0,0 +1,47 @@
+/*******************************************************************************
+ * Copyright (C) 2023 by PRANJAL GUPTA
+ *
+ * Redistribution, modification or use of this software in source or binary
+ * forms is permitted as long as the files maintain this copyright. Users are
+ * permitted to modify this and use it to learn about the field of embedded
+ * software. PRANJAL GUPTA and the University of Colorado are not liable for
+ * any misuse of this material.
+ * ****************************************************************************/
+
+/**
+ * @file    i2c_hal.h
+ * @brief   This file has the i2c bus interface used by the device drivers. The transactions go through a
+ *          table of functions so the same drivers run on the KL25Z bus owner tasks or on the host models.
+ *
+ * @author  Pranjal Gupta
+ * @date    12/18/2023
+ *
+ */
+
+#ifndef I2C_HAL_H_
+#define I2C_HAL_H_
+
+#include "stdint.h"
+#include "i2c.h"
+
+typedef enum {
+	I2C_PRIORITY_HIGH,          // short latency critical transactions, RTC register reads
+	I2C_PRIORITY_NORMAL,
+	I2C_PRIORITY_LOW,           // bulk transfers, display commands and page writes
+	I2C_PRIORITY_COUNT
+} i2c_priority_t;
+
+/* a bus backend, both functions block until the transaction is complete */
+typedef struct {
+	i2c_status_t (*transmitv)(i2c_priority_t priority, uint8_t device_addr,
+			const i2c_iovec_t *segments, uint8_t count);
+	i2c_status_t (*read)(i2c_priority_t priority, uint8_t device_addr, uint8_t read_addr,
+			uint8_t *rx_buffer, uint8_t length);
+} i2c_hal_ops_t;
+
+void i2c_hal_set_ops(const i2c_hal_ops_t *ops);
+i2c_status_t i2c_hal_transmit(i2c_priority_t priority, uint8_t device_addr, const uint8_t *data, int length);
+i2c_status_t i2c_hal_transmitv(i2c_priority_t priority, uint8_t device_addr, const i2c_iovec_t *segments, uint8_t count);
+i2c_status_t i2c_hal_read(i2c_priority_t priority, uint8_t device_addr, uint8_t read_addr, uint8_t *rx_buffer, uint8_t length);
+
+#endif /* I2C_HAL_H_ */
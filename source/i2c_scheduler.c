@@ -0,0 +1,299 @@
+/*******************************************************************************
+ * Copyright (C) 2023 by PRANJAL GUPTA
+ *
+ * Redistribution, modification or use of this software in source or binary
+ * forms is permitted as long as the files maintain this copyright. Users are
+ * permitted to modify this and use it to learn about the field of embedded
+ * software. PRANJAL GUPTA and the University of Colorado are not liable for
+ * any misuse of this material.
+ * ****************************************************************************/
+
+/**
+ * @file    i2c_scheduler.c
+ * @brief   This file contains the i2c bus owner task. Tasks submit transaction descriptors into one queue
+ *          per priority and the bus owner runs them one at a time, always taking the highest priority one
+ *          first, so a START is never issued in the middle of another task's transaction and a RTC read
+ *          waits at most for the transaction in flight. There is one bus owner per i2c bus, a request is
+ *          queued to the owner of the bus its slave was registered on, so the two buses run in parallel.
+ *
+ * @author  Pranjal Gupta
+ * @date    12/15/2023
+ *
+ */
+#include "i2c_scheduler.h"
+#include "i2c.h"
+#include "cycle_counter.h"
+#include "queue.h"
+#include "semphr.h"
+
+/* request queues and counters of the bus owner task of one bus */
+typedef struct {
+	QueueHandle_t request_queue[I2C_PRIORITY_COUNT];
+	SemaphoreHandle_t pending_requests;
+	TaskHandle_t handle;
+	i2c_priority_stats_t priority_stats[I2C_PRIORITY_COUNT];
+} i2c_bus_owner_t;
+
+static void i2c_scheduler_handler(void *parameters);
+static void i2c_scheduler_execute(i2c_bus_owner_t *owner, i2c_request_t *request);
+
+#define I2C_SCHEDULER_STACK_SIZE 150
+#define I2C_SCHEDULER_PRIORITY 3
+#define I2C_SCHEDULER_QUEUE_LENGTH 4
+
+static i2c_bus_owner_t bus_owners[I2C_BUS_COUNT];
+
+/* KL25Z backend of the driver bus interface, the transactions are run by the bus owner tasks */
+const i2c_hal_ops_t i2c_scheduler_hal_ops = {
+	.transmitv = i2c_scheduler_transmitv,
+	.read = i2c_scheduler_read
+};
+static const char *const bus_owner_names[I2C_BUS_COUNT] = { "I2C0_SCHEDULER", "I2C1_SCHEDULER" };
+
+/*
+ * Description: creates the request queues and the bus owner task of every bus, it has to be called before
+ *              the scheduler is started
+ * Parameters:
+ * 		None
+ * Returns:
+ *   		None
+ */
+
+void i2c_scheduler_init(void) {
+
+	BaseType_t status;
+	i2c_bus_owner_t *owner;
+
+	for (int bus = 0; bus < I2C_BUS_COUNT; bus++) {
+		owner = &bus_owners[bus];
+
+		for (int i = 0; i < I2C_PRIORITY_COUNT; i++) {
+			owner->request_queue[i] = xQueueCreate(I2C_SCHEDULER_QUEUE_LENGTH, sizeof(i2c_request_t *));
+			configASSERT(owner->request_queue[i] != NULL);
+		}
+
+		owner->pending_requests = xSemaphoreCreateCounting(
+				I2C_SCHEDULER_QUEUE_LENGTH * I2C_PRIORITY_COUNT, 0);
+		configASSERT(owner->pending_requests != NULL);
+
+		status = xTaskCreate(i2c_scheduler_handler, bus_owner_names[bus],
+		I2C_SCHEDULER_STACK_SIZE, owner, I2C_SCHEDULER_PRIORITY, &owner->handle);
+
+		configASSERT(status == pdPASS);
+	}
+}
+
+/*
+ * Description: queues a transaction for the owner of the bus of its slave and returns at once, the
+ *              descriptor and its buffer must stay valid until i2c_scheduler_wait returns
+ * Parameters:
+ * 		i2c_request_t * the transaction descriptor
+ * Returns:
+ *   		None
+ */
+
+void i2c_scheduler_submit(i2c_request_t *request) {
+
+	i2c_bus_owner_t *owner = &bus_owners[i2c_device_bus(request->device_addr)];
+	i2c_priority_stats_t *stats = &owner->priority_stats[request->priority];
+	uint32_t depth;
+
+	request->done = false;
+	request->requester = xTaskGetCurrentTaskHandle();
+	request->submit_cycles = cycle_counter_now();
+
+	xQueueSend(owner->request_queue[request->priority], &request, portMAX_DELAY);
+
+	taskENTER_CRITICAL();
+	depth = uxQueueMessagesWaiting(owner->request_queue[request->priority]);
+	if (depth > stats->max_queue_depth)
+		stats->max_queue_depth = depth;
+	taskEXIT_CRITICAL();
+
+	xSemaphoreGive(owner->pending_requests);
+}
+
+/*
+ * Description: blocks the calling task until the bus owner has completed the transaction
+ * Parameters:
+ * 		i2c_request_t * the descriptor given to i2c_scheduler_submit
+ * Returns:
+ *   		None
+ */
+
+void i2c_scheduler_wait(i2c_request_t *request) {
+
+	while (!request->done)
+		ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+}
+
+/*
+ * Description: writes the data to the slave through the bus owner and waits for it to complete
+ * Parameters:
+ * 		i2c_priority_t priority of the transaction
+ * 		uint8_t device addr the device address of the slave
+ * 		uint8_t *data the data which is to be sent
+ * 		int length  the length of the data to be sent
+ * Returns:
+ *   		i2c_status_t the result of the transaction
+ */
+
+i2c_status_t i2c_scheduler_transmit(i2c_priority_t priority, uint8_t device_addr, uint8_t *data, int length) {
+
+	i2c_iovec_t segment = { data, length };
+
+	return i2c_scheduler_transmitv(priority, device_addr, &segment, 1);
+}
+
+/*
+ * Description: writes several segments to the slave in one transaction through the bus owner and waits
+ *              for it to complete
+ * Parameters:
+ * 		i2c_priority_t priority of the transaction
+ * 		uint8_t device addr the device address of the slave
+ * 		const i2c_iovec_t * the segments to be sent one after the other
+ * 		uint8_t number of segments
+ * Returns:
+ *   		i2c_status_t the result of the transaction
+ */
+
+i2c_status_t i2c_scheduler_transmitv(i2c_priority_t priority, uint8_t device_addr,
+		const i2c_iovec_t *segments, uint8_t count) {
+
+	i2c_request_t request;
+
+	if (xTaskGetSchedulerState() != taskSCHEDULER_RUNNING)
+		return i2c_transmitv(device_addr, segments, count);
+
+	request.is_read = false;
+	request.device_addr = device_addr;
+	request.segments = segments;
+	request.segment_count = count;
+	request.priority = priority;
+
+	i2c_scheduler_submit(&request);
+	i2c_scheduler_wait(&request);
+	return request.status;
+}
+
+/*
+ * Description: reads the registers of the slave through the bus owner and waits for it to complete
+ * Parameters:
+ * 		i2c_priority_t priority of the transaction
+ * 		uint8_t device addr the device address of the slave
+ * 		uint8_t read_addr  address of the register to be read from the slave
+ * 		uint8_t *rx_buffer the data buffer to store the read data
+ * 		uint8_t length  the length of the data to be read
+ * Returns:
+ *   		i2c_status_t the result of the transaction
+ */
+
+i2c_status_t i2c_scheduler_read(i2c_priority_t priority, uint8_t device_addr, uint8_t read_addr,
+		uint8_t *rx_buffer, uint8_t length) {
+
+	i2c_request_t request;
+
+	if (xTaskGetSchedulerState() != taskSCHEDULER_RUNNING)
+		return i2c_read_bytes(device_addr, read_addr, rx_buffer, length);
+
+	request.is_read = true;
+	request.device_addr = device_addr;
+	request.read_addr = read_addr;
+	request.data = rx_buffer;
+	request.length = length;
+	request.priority = priority;
+
+	i2c_scheduler_submit(&request);
+	i2c_scheduler_wait(&request);
+	return request.status;
+}
+
+/*
+ * Description: copies the queue depth and wait time counters of one priority level of a bus
+ * Parameters:
+ * 		i2c_bus_id_t the bus
+ * 		i2c_priority_t the priority level
+ * 		i2c_priority_stats_t * the structure to be filled
+ * Returns:
+ *   		None
+ */
+
+void i2c_scheduler_get_stats(i2c_bus_id_t bus, i2c_priority_t priority, i2c_priority_stats_t *stats) {
+
+	taskENTER_CRITICAL();
+	*stats = bus_owners[bus].priority_stats[priority];
+	taskEXIT_CRITICAL();
+	stats->queue_depth = uxQueueMessagesWaiting(bus_owners[bus].request_queue[priority]);
+}
+
+/*
+ * Description: returns the handle of the bus owner task of a bus
+ * Parameters:
+ * 		i2c_bus_id_t the bus
+ * Returns:
+ *   		TaskHandle_t the bus owner task
+ */
+
+TaskHandle_t i2c_scheduler_task_handle(i2c_bus_id_t bus) {
+	return bus_owners[bus].handle;
+}
+
+/*
+ * Description: runs one transaction on the bus and updates the wait time counters of its priority
+ * Parameters:
+ * 		i2c_bus_owner_t * the owner of the bus
+ * 		i2c_request_t * the transaction descriptor
+ * Returns:
+ *   		None
+ */
+
+static void i2c_scheduler_execute(i2c_bus_owner_t *owner, i2c_request_t *request) {
+
+	i2c_priority_stats_t *stats = &owner->priority_stats[request->priority];
+	uint32_t wait_us = cycle_counter_to_us(cycle_counter_now() - request->submit_cycles);
+
+	taskENTER_CRITICAL();
+	stats->completed++;
+	stats->total_wait_us += wait_us;
+	if (wait_us > stats->max_wait_us)
+		stats->max_wait_us = wait_us;
+	taskEXIT_CRITICAL();
+
+	if (request->is_read)
+		request->status = i2c_read_bytes(request->device_addr, request->read_addr, request->data,
+				(uint8_t) request->length);
+	else
+		request->status = i2c_transmitv(request->device_addr, request->segments,
+				request->segment_count);
+}
+
+/*
+ * Description: bus owner task, waits for queued transactions and runs the highest priority one first.
+ *              The queues are looked at again after every transaction, so a high priority request
+ *              overtakes the queued bulk writes at the next transaction boundary.
+ * Parameters:
+ * 		void *parameters the i2c_bus_owner_t of the bus
+ * Returns:
+ *   		None
+ */
+
+static void i2c_scheduler_handler(void *parameters) {
+
+	i2c_bus_owner_t *owner = (i2c_bus_owner_t *) parameters;
+	i2c_request_t *request = NULL;
+
+	while (1) {
+
+		xSemaphoreTake(owner->pending_requests, portMAX_DELAY);
+
+		for (int i = 0; i < I2C_PRIORITY_COUNT; i++) {
+			if (xQueueReceive(owner->request_queue[i], &request, 0) == pdPASS)
+				break;
+		}
+
+		i2c_scheduler_execute(owner, request);
+
+		request->done = true;
+		xTaskNotifyGive(request->requester);
+	}
+}
@@ -0,0 +1,65 @@
+/*******************************************************************************
+ * Copyright (C) 2023 by PRANJAL GUPTA
+ *
+ * Redistribution, modification or use of this software in source or binary
+ * forms is permitted as long as the files maintain this copyright. Users are
+ * permitted to modify this and use it to learn about the field of embedded
+ * software. PRANJAL GUPTA and the University of Colorado are not liable for
+ * any misuse of this material.
+ * ****************************************************************************/
+
+/**
+ * @file    i2c_scheduler.h
+ * @brief   This file has function prototypes for the i2c bus owner task which runs the transactions
+ *          of all the tasks one at a time in priority order.
+ *
+ * @author  Pranjal Gupta
+ * @date    12/15/2023
+ *
+ */
+
+#ifndef I2C_SCHEDULER_H_
+#define I2C_SCHEDULER_H_
+
+#include "stdint.h"
+#include "stdbool.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include "i2c.h"
+#include "i2c_hal.h"
+
+typedef struct {
+	bool is_read;
+	uint8_t device_addr;
+	uint8_t read_addr;
+	uint8_t *data;                        // read buffer
+	int length;                           // number of bytes to read
+	const i2c_iovec_t *segments;          // segments of a write
+	uint8_t segment_count;
+	i2c_priority_t priority;
+	TaskHandle_t requester;
+	uint32_t submit_cycles;
+	i2c_status_t status;                  // result, valid once done is set
+	volatile bool done;
+} i2c_request_t;
+
+typedef struct {
+	uint32_t queue_depth;
+	uint32_t max_queue_depth;
+	uint32_t completed;
+	uint32_t total_wait_us;
+	uint32_t max_wait_us;
+} i2c_priority_stats_t;
+
+void i2c_scheduler_init(void);
+void i2c_scheduler_submit(i2c_request_t *request);
+void i2c_scheduler_wait(i2c_request_t *request);
+i2c_status_t i2c_scheduler_transmit(i2c_priority_t priority, uint8_t device_addr, uint8_t *data, int length);
+i2c_status_t i2c_scheduler_transmitv(i2c_priority_t priority, uint8_t device_addr, const i2c_iovec_t *segments, uint8_t count);
+i2c_status_t i2c_scheduler_read(i2c_priority_t priority, uint8_t device_addr, uint8_t read_addr, uint8_t *rx_buffer, uint8_t length);
+void i2c_scheduler_get_stats(i2c_bus_id_t bus, i2c_priority_t priority, i2c_priority_stats_t *stats);
+TaskHandle_t i2c_scheduler_task_handle(i2c_bus_id_t bus);
+
+extern const i2c_hal_ops_t i2c_scheduler_hal_ops;
+
+#endif /* I2C_SCHEDULER_H_ */
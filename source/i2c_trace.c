@@ -0,0 +1,187 @@
+/*******************************************************************************
+ * Copyright (C) 2023 by PRANJAL GUPTA
+ *
+ * Redistribution, modification or use of this software in source or binary
+ * forms is permitted as long as the files maintain this copyright. Users are
+ * permitted to modify this and use it to learn about the field of embedded
+ * software. PRANJAL GUPTA and the University of Colorado are not liable for
+ * any misuse of this material.
+ * ****************************************************************************/
+
+/**
+ * @file    i2c_trace.c
+ * @brief   This file contains the i2c transaction trace. Every write and read made through i2c_transmitv
+ *          and i2c_read_bytes is stored with its cycle counter timestamp, slave, byte count, duration and
+ *          result in a ring buffer, and added to the counters of its slave. The dump prints the entries
+ *          recorded since the previous dump and the counters as one line each for tools/i2c_trace_decode.py.
+ *
+ * @author  Pranjal Gupta
+ * @date    12/17/2023
+ *
+ */
+#include "i2c_trace.h"
+
+#if I2C_TRACE_ENABLE
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "cycle_counter.h"
+#include "fsl_debug_console.h"
+
+static i2c_trace_device_stats_t *i2c_trace_device(uint8_t device_addr);
+
+static i2c_trace_entry_t trace[I2C_TRACE_DEPTH];
+static uint32_t trace_head = 0;             // number of entries ever recorded
+static uint32_t trace_dumped = 0;           // value of trace_head at the last dump
+static i2c_trace_device_stats_t device_stats[I2C_TRACE_MAX_DEVICES];
+static uint8_t device_count = 0;
+
+/*
+ * Description: returns the counters of a slave, a new slot is taken the first time the slave is seen
+ * Parameters:
+ * 		uint8_t device address of the slave
+ * Returns:
+ *   		i2c_trace_device_stats_t * the counters, NULL if all the slots are in use
+ */
+
+static i2c_trace_device_stats_t *i2c_trace_device(uint8_t device_addr) {
+
+	for (uint8_t i = 0; i < device_count; i++) {
+		if (device_stats[i].address == device_addr)
+			return &device_stats[i];
+	}
+
+	if (device_count == I2C_TRACE_MAX_DEVICES)
+		return NULL;
+
+	device_stats[device_count].address = device_addr;
+	return &device_stats[device_count++];
+}
+
+/*
+ * Description: records a completed transaction. It is called by the i2c driver from the task which ran
+ *              the transaction, the buses run in parallel so the update is done with the interrupts masked.
+ * Parameters:
+ * 		uint8_t device address of the slave
+ * 		bool true for a read
+ * 		uint16_t number of payload bytes
+ * 		uint32_t cycle counter when the transaction was started
+ * 		i2c_status_t result of the transaction
+ * Returns:
+ *   		None
+ */
+
+void i2c_trace_record(uint8_t device_addr, bool is_read, uint16_t bytes, uint32_t start_cycles,
+		i2c_status_t status) {
+
+	uint32_t duration_us = cycle_counter_to_us(cycle_counter_now() - start_cycles);
+	i2c_trace_entry_t *entry;
+	i2c_trace_device_stats_t *stats;
+	uint32_t mask;
+
+	mask = portSET_INTERRUPT_MASK_FROM_ISR();
+
+	entry = &trace[trace_head % I2C_TRACE_DEPTH];
+	entry->timestamp = start_cycles;
+	entry->duration_us = duration_us;
+	entry->bytes = bytes;
+	entry->address = device_addr;
+	entry->is_read = is_read;
+	entry->status = status;
+	trace_head++;
+
+	stats = i2c_trace_device(device_addr);
+	if (stats != NULL) {
+		stats->transactions++;
+		stats->bytes += bytes;
+		stats->busy_us += duration_us;
+		if (duration_us > stats->max_us)
+			stats->max_us = duration_us;
+		if (status == I2C_STATUS_NACK)
+			stats->nacks++;
+		else if (status != I2C_STATUS_OK)
+			stats->errors++;
+	}
+
+	portCLEAR_INTERRUPT_MASK_FROM_ISR(mask);
+}
+
+/*
+ * Description: copies the counters of a slave
+ * Parameters:
+ * 		uint8_t device address of the slave
+ * 		i2c_trace_device_stats_t * the structure to be filled
+ * Returns:
+ *   		bool false if no transaction with the slave was recorded
+ */
+
+bool i2c_trace_get_device_stats(uint8_t device_addr, i2c_trace_device_stats_t *stats) {
+
+	bool found = false;
+	uint32_t mask;
+
+	mask = portSET_INTERRUPT_MASK_FROM_ISR();
+	for (uint8_t i = 0; i < device_count; i++) {
+		if (device_stats[i].address == device_addr) {
+			*stats = device_stats[i];
+			found = true;
+		}
+	}
+	portCLEAR_INTERRUPT_MASK_FROM_ISR(mask);
+
+	return found;
+}
+
+/*
+ * Description: prints the entries recorded since the previous dump and the counters of every slave on the
+ *              debug console. When more than I2C_TRACE_DEPTH entries were recorded meanwhile only the last
+ *              ones are printed and the number of the lost ones is given in the header line.
+ *              Format, one record per line:
+ *                I2CTRACE BEGIN <tick ms> <dropped entries>
+ *                I2CT <start cycles> <address> <R|W> <bytes> <duration us> <status>
+ *                I2CD <address> <transactions> <bytes> <nacks> <errors> <busy us> <max us> <average us>
+ *                I2CTRACE END
+ * Parameters:
+ * 		None
+ * Returns:
+ *   		None
+ */
+
+void i2c_trace_dump(void) {
+
+	i2c_trace_entry_t entry;
+	i2c_trace_device_stats_t stats;
+	uint32_t head, first, mask;
+
+	mask = portSET_INTERRUPT_MASK_FROM_ISR();
+	head = trace_head;
+	portCLEAR_INTERRUPT_MASK_FROM_ISR(mask);
+
+	first = trace_dumped;
+	if (head - first > I2C_TRACE_DEPTH)
+		first = head - I2C_TRACE_DEPTH;
+
+	PRINTF("I2CTRACE BEGIN %u %u\r\n", (unsigned) (xTaskGetTickCount() * portTICK_PERIOD_MS),
+			(unsigned) (first - trace_dumped));
+
+	for (uint32_t i = first; i != head; i++) {
+		mask = portSET_INTERRUPT_MASK_FROM_ISR();
+		entry = trace[i % I2C_TRACE_DEPTH];       // copied, the slot may be reused while printing
+		portCLEAR_INTERRUPT_MASK_FROM_ISR(mask);
+		PRINTF("I2CT %u %02x %c %u %u %u\r\n", (unsigned) entry.timestamp, entry.address,
+				entry.is_read ? 'R' : 'W', entry.bytes, (unsigned) entry.duration_us, entry.status);
+	}
+	trace_dumped = head;
+
+	for (uint8_t i = 0; i < device_count; i++) {
+		i2c_trace_get_device_stats(device_stats[i].address, &stats);
+		PRINTF("I2CD %02x %u %u %u %u %u %u %u\r\n", stats.address, (unsigned) stats.transactions,
+				(unsigned) stats.bytes, (unsigned) stats.nacks, (unsigned) stats.errors,
+				(unsigned) stats.busy_us, (unsigned) stats.max_us,
+				(unsigned) (stats.transactions ? stats.busy_us / stats.transactions : 0));
+	}
+
+	PRINTF("I2CTRACE END\r\n");
+}
+
+#endif /* I2C_TRACE_ENABLE */
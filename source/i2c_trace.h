@@ -0,0 +1,70 @@
+/*******************************************************************************
+ * Copyright (C) 2023 by PRANJAL GUPTA
+ *
+ * Redistribution, modification or use of this software in source or binary
+ * forms is permitted as long as the files maintain this copyright. Users are
+ * permitted to modify this and use it to learn about the field of embedded
+ * software. PRANJAL GUPTA and the University of Colorado are not liable for
+ * any misuse of this material.
+ * ****************************************************************************/
+
+/**
+ * @file    i2c_trace.h
+ * @brief   This file has the function prototypes of the i2c transaction trace, built in with I2C_TRACE_ENABLE=1.
+ *
+ * @author  Pranjal Gupta
+ * @date    12/17/2023
+ *
+ */
+
+#ifndef I2C_TRACE_H_
+#define I2C_TRACE_H_
+
+#include "stdint.h"
+#include "stdbool.h"
+#include "i2c.h"
+
+/*
+ * Build with I2C_TRACE_ENABLE=1 to record every blocking write and read in a RAM ring buffer and in
+ * per slave counters, dumped on the debug console every I2C_TRACE_DUMP_PERIOD_MS and decoded on the
+ * host with tools/i2c_trace_decode.py.
+ */
+#ifndef I2C_TRACE_ENABLE
+#define I2C_TRACE_ENABLE 0
+#endif
+
+#ifndef I2C_TRACE_DEPTH
+#define I2C_TRACE_DEPTH 32
+#endif
+
+#ifndef I2C_TRACE_DUMP_PERIOD_MS
+#define I2C_TRACE_DUMP_PERIOD_MS 10000
+#endif
+
+#define I2C_TRACE_MAX_DEVICES 4
+
+typedef struct {
+	uint32_t timestamp;         // cycle counter at the start of the transaction
+	uint32_t duration_us;
+	uint16_t bytes;             // payload bytes, without the address and register bytes
+	uint8_t address;
+	uint8_t is_read : 1;
+	uint8_t status : 7;         // i2c_status_t
+} i2c_trace_entry_t;
+
+typedef struct {
+	uint8_t address;
+	uint32_t transactions;
+	uint32_t bytes;
+	uint32_t nacks;
+	uint32_t errors;            // timeouts, lost arbitration and dma errors
+	uint32_t busy_us;           // sum of the transaction durations
+	uint32_t max_us;
+} i2c_trace_device_stats_t;
+
+void i2c_trace_record(uint8_t device_addr, bool is_read, uint16_t bytes, uint32_t start_cycles,
+		i2c_status_t status);
+bool i2c_trace_get_device_stats(uint8_t device_addr, i2c_trace_device_stats_t *stats);
+void i2c_trace_dump(void);
+
+#endif /* I2C_TRACE_H_ */
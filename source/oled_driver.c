@@ -12,13 +12,17 @@
  * @file    oled_driver.c
  * @brief   This file contains the functions for communication with oled display which is having ssd1306 display controller
  *			Modified accordingly by taking reference from https://github.com/sdp8483/MSP430G2_SSD1306_OLED/blob/master/MSP430G2_SSD1306/ssd1306.c
+ *          Drawing goes to a RAM copy of the 1024 byte GDDRAM. A byte which changes marks its column dirty
+ *          and oled_flush sends, per page, only the span from the first to the last dirty column through a
+ *          column and page window, so redrawing the same text costs nothing on the bus.
+ *          The frame buffer is not locked, tasks sharing the display hold a lock from drawing to flushing.
  *
  * @author  Pranjal Gupta
  * @date    12/10/2023
  *
  */
 #include "oled_driver.h"
-#include "i2c.h"
+#include "i2c_hal.h"
 #include "string.h"
 #include "stdint.h"
 #include "stdlib.h"
@@ -26,8 +30,8 @@
 
 static void set_column_start_end_addr();
 static void set_page_start_end_addr();
-static void send_command(uint8_t command, uint8_t *data, uint8_t length);
-static void oled_set_position(uint8_t x, uint8_t y);
+static void send_command(uint8_t command, const uint8_t *data, uint8_t length);
+static void draw_column(uint8_t page, uint8_t column, uint8_t value);
 
 #define MULTIPLEX_VALUE 0x3F
 #define COMPINS_FOR_128X64 0x12
@@ -42,7 +46,16 @@ static void oled_set_position(uint8_t x, uint8_t y);
 #define SSD1306_MAX_PAGE_ADDR 7
 #define DATA_IDENTIFIER_BYTE 0x40
 #define COMMAND_IDETIFIER_BYTE 0x00
-#define DATA_IDENTIFIER_END_BYTE 0x00
+#define OLED_PAGES (SSD1306_MAX_PAGE_ADDR + 1)
+#define WINDOW_COMMAND_LENGTH 6
+
+static const uint8_t command_byte = COMMAND_IDETIFIER_BYTE; // continuos bit set to 0 indicating the following byte is the data od the command
+static const uint8_t data_identifier = DATA_IDENTIFIER_BYTE;
+static const uint8_t blank_page[OLED_LCDWIDTH] = { 0 };     // sent straight from flash to clear a page
+
+static uint8_t framebuffer[OLED_PAGES][OLED_LCDWIDTH];
+static uint8_t dirty_start[OLED_PAGES];                     // first dirty column of a page
+static uint8_t dirty_end[OLED_PAGES];                       // one past the last dirty column, 0 when clean
 
 /*
  * Description: Intilaises the oled display by sending commands specifies in the datasheet
@@ -82,60 +95,54 @@ void oled_init(void) {
 }
 
 /*
- * Description: Sends the data to the slave collectively according to the length
+ * Description: Sends a command and its arguments to the display in one transaction, the control byte,
+ *              the command and the arguments are sent as separate segments so nothing is copied
  * Parameters:
- * 		uint8_t device addr the device address of the slave
- * 		uint8_t *data the data which is to be sent
- * 		int length  the length of the data to be sent
+ * 		uint8_t command the command byte
+ * 		const uint8_t *data the arguments of the command
+ * 		uint8_t length  the number of arguments
  * Returns:
  *   		None
  */
 
-static void send_command(uint8_t command, uint8_t *data, uint8_t length) {
-	uint8_t command_byte = COMMAND_IDETIFIER_BYTE; // continuos bit set to 0 indicating the following byte is the data od the command
-	uint8_t data_to_send[length + 2];
-	data_to_send[0] = command_byte;
-	data_to_send[1] = command;
-	if (length == 0) {
-		i2c_data_transmit(OLED_ADDRESS, data_to_send, sizeof(data_to_send));
-		return;
-	}
+static void send_command(uint8_t command, const uint8_t *data, uint8_t length) {
+	i2c_iovec_t segments[3] = {
+		{ &command_byte, 1 },
+		{ &command, 1 },
+		{ data, length }
+	};
 
-	memcpy(data_to_send + 2, data, length);
-	i2c_data_transmit(OLED_ADDRESS, data_to_send, sizeof(data_to_send));
+	i2c_hal_transmitv(I2C_PRIORITY_LOW, OLED_ADDRESS, segments, (length == 0) ? 2 : 3);
 }
 
 /*
- * Description: set the cursor at a specific column and page
+ * Description: writes one column of a page into the frame buffer and marks it dirty when it changed
  * Parameters:
- * 		uint8_t column value
- * 		uint8_t Page value
+ * 		uint8_t page 0 to 7
+ * 		uint8_t column 0 to 127
+ * 		uint8_t the 8 pixels of the column, bit 0 is the top row of the page
  * Returns:
  *   		None
  */
-static void oled_set_position(uint8_t x, uint8_t y) {
-
-	uint8_t data[2];
-	if (x > OLED_LCDWIDTH - 1)
-		x = 0;                 // as column range is 0-127
 
-	if (y > SSD1306_MAX_PAGE_ADDR)
-		y = 0;                // page range is 0-7
+static void draw_column(uint8_t page, uint8_t column, uint8_t value) {
 
-	data[0] = x;
-	data[1] = OLED_LCDWIDTH - 1;
-
-	send_command(OLED_COLUMNADDR, data, sizeof(data));
-
-	data[0] = y;
-	data[1] = SSD1306_MAX_PAGE_ADDR;
-
-	send_command(OLED_PAGEADDR, data, sizeof(data));
+	if (framebuffer[page][column] == value)
+		return;
 
+	framebuffer[page][column] = value;
+	if (dirty_end[page] == 0) {
+		dirty_start[page] = column;
+		dirty_end[page] = column + 1;
+	} else if (column < dirty_start[page]) {
+		dirty_start[page] = column;
+	} else if (column >= dirty_end[page]) {
+		dirty_end[page] = column + 1;
+	}
 }
 
 /*
- * Description: clears a specific page
+ * Description: clears a specific page in the frame buffer, it is sent by oled_flush
  * Parameters:
  * 		uint8_t page number to be cleared
  * Returns:
@@ -143,16 +150,16 @@ static void oled_set_position(uint8_t x, uint8_t y) {
  */
 
 void oled_clear_page(uint8_t page) {
-	uint8_t data[OLED_LCDWIDTH + 1];
-	oled_set_position(0, page);
-	data[0] = DATA_IDENTIFIER_BYTE;
-	memset(data + 1, 0, OLED_LCDWIDTH);
-	i2c_data_transmit(OLED_ADDRESS, data, sizeof(data));
 
+	if (page > SSD1306_MAX_PAGE_ADDR)
+		return;
+
+	for (uint8_t column = 0; column < OLED_LCDWIDTH; column++)
+		draw_column(page, column, 0);
 }
 
 /*
- * Description: Write a string or a char onto the display
+ * Description: Write a string or a char into the frame buffer, it is sent by oled_flush
  * Parameters:
  * 		char *  the string to be displayed
  * 		uint8_t the column value
@@ -165,31 +172,73 @@ void oled_printstring(char *string, uint8_t x, uint8_t y) {
 	if (string == NULL)
 		return;
 
-	oled_set_position(x, y);
+	if (x > OLED_LCDWIDTH - 1)
+		x = 0;                 // as column range is 0-127
 
-	uint8_t buffer_to_send[SIZE_OF_BYTE - 1];
+	if (y > SSD1306_MAX_PAGE_ADDR)
+		y = 0;                // page range is 0-7
 
 	while (*string != '\0') {
 		if ((x + PIXEL_SIZE_IN_BYTES) > (OLED_LCDWIDTH - 1)) { // since i am using font 5x7 and if x+5 bytes goes beyond the boundaries and then g to the next page
 			x = 0;
-			y++;
-			oled_set_position(x, y);
-		}
-		buffer_to_send[0] = DATA_IDENTIFIER_BYTE;     // identifier for data
-
-		for (int i = 0; i < PIXEL_SIZE_IN_BYTES; i++) {
-			buffer_to_send[i + 1] = font_5x7[*string - ' '][i];
+			y = (y == SSD1306_MAX_PAGE_ADDR) ? 0 : y + 1;
 		}
-
-		buffer_to_send[6] = DATA_IDENTIFIER_END_BYTE; // marking the end of the buffer
-		i2c_data_transmit(OLED_ADDRESS, buffer_to_send, sizeof(buffer_to_send));
+		for (uint8_t i = 0; i < PIXEL_SIZE_IN_BYTES; i++)
+			draw_column(y, x + i, font_5x7[*string - ' '][i]);
+		draw_column(y, x + PIXEL_SIZE_IN_BYTES, 0);            // blank column between the characters
 		string++;
 		x = x + PIXEL_SIZE_IN_BYTES + 1;
 	}
 }
 
 /*
- * Description: clear the complete display by writing 0 onto every pixel space
+ * Description: sends the dirty columns of the frame buffer to the display, one window command and one data
+ *              write per dirty page. Another flush between the two writes of a page would move the window,
+ *              so the caller holds the lock of the display.
+ * Parameters:
+ * 		None
+ * Returns:
+ *   		None
+ */
+
+void oled_flush(void) {
+
+	uint8_t window[WINDOW_COMMAND_LENGTH];
+	uint8_t start, end;
+	i2c_iovec_t commands[2] = {
+		{ &command_byte, 1 },
+		{ window, WINDOW_COMMAND_LENGTH }
+	};
+	i2c_iovec_t data[2] = {
+		{ &data_identifier, 1 },
+		{ NULL, 0 }
+	};
+
+	for (uint8_t page = 0; page < OLED_PAGES; page++) {
+		if (dirty_end[page] == 0)
+			continue;
+
+		start = dirty_start[page];
+		end = dirty_end[page];
+		dirty_end[page] = 0;
+
+		window[0] = OLED_COLUMNADDR;
+		window[1] = start;
+		window[2] = end - 1;
+		window[3] = OLED_PAGEADDR;
+		window[4] = page;
+		window[5] = page;
+		i2c_hal_transmitv(I2C_PRIORITY_LOW, OLED_ADDRESS, commands, 2);
+
+		data[1].data = &framebuffer[page][start];
+		data[1].length = end - start;
+		i2c_hal_transmitv(I2C_PRIORITY_LOW, OLED_ADDRESS, data, 2);
+	}
+}
+
+/*
+ * Description: clear the complete display by writing 0 onto every pixel space, the display is written at once
+ *              and the frame buffer is cleared with it
  * Parameters:
  * 		None
  * Returns:
@@ -198,12 +247,20 @@ void oled_printstring(char *string, uint8_t x, uint8_t y) {
 
 void oled_clearDisplay(void) {
 	uint8_t data = COMMAND_IDETIFIER_BYTE;
+	i2c_iovec_t segments[2] = {
+		{ &data_identifier, 1 },
+		{ blank_page, OLED_LCDWIDTH }
+	};
+
+	memset(framebuffer, 0, sizeof(framebuffer));
+	memset(dirty_end, 0, sizeof(dirty_end));
+
 	send_command(OLED_MEMORYMODE, &data, sizeof(data));
 	set_column_start_end_addr();
 	set_page_start_end_addr();
 
-	for (uint8_t i = 0; i < SSD1306_MAX_PAGE_ADDR + 1; i++) {
-		oled_clear_page(i);
+	for (uint8_t i = 0; i < OLED_PAGES; i++) {
+		i2c_hal_transmitv(I2C_PRIORITY_LOW, OLED_ADDRESS, segments, 2);
 	}
 
 }
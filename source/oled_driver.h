@@ -26,6 +26,7 @@
 void oled_init(void);
 
 #define OLED_ADDRESS            	  0x3C
+#define OLED_MAX_SCL_HZ              400000     // fast mode, 2.5 us minimum clock cycle
 
 #define OLED_LCDWIDTH                128
 #define OLED_LCDHEIGHT   			64
@@ -70,5 +71,6 @@ void oled_init(void);
 void oled_clearDisplay(void);
 void oled_clear_page(uint8_t y);
 void oled_printstring(char *string, uint8_t x, uint8_t y);
+void oled_flush(void);
 
 #endif /* OLED_DRIVER_H_ */
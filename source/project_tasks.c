@@ -20,26 +20,45 @@
 #include "task.h"
 #include "oled_driver.h"
 #include "DS3231.h"
+#include "ds3231_shadow.h"
 #include "i2c.h"
+#include "i2c_scheduler.h"
+#include "i2c_board.h"
 #include "string.h"
 #include "stdlib.h"
 #include "stdio.h"
 #include "semphr.h"
+#include "queue.h"
 #include "MKL25Z4.h"
+#include "benchmark.h"
+#include "i2c_trace.h"
+#include "rtc_sqw.h"
+#include "clock_service.h"
+#include "cycle_counter.h"
+#include "rtc_alarm.h"
+#include "rtc_calibration.h"
+#include "rtc_clkin.h"
+#include "tz.h"
 
 TaskHandle_t rtc_set_handle;
 TaskHandle_t rtc_read_handle;
 TaskHandle_t init_handle;
 TaskHandle_t monitor_failure_handle;
+QueueHandle_t rtc_status_queue;     // last status register read by the display task
 
 static void rtc_set_handler(void *parameters);
 static void rtc_read_handler_and_display(void *parameters);
 static void init_handler(void *parameters);
 static void print_time_and_date(ds3231_date_t *date, ds3231_time_t *time);
 static void monitor_failure_handler(void *parameters);
+static void print_temperature(int16_t centi_celsius);
+static void lock_rtc_shadow(void);
+static void unlock_rtc_shadow(void);
 
 BaseType_t status;
-uint8_t current_day = 0;
+static ds3231_date_t shown_date;    // date on the display, all 0 until the first one is drawn
+static SemaphoreHandle_t rtc_shadow_mutex;   // one DS3231 driver operation at a time, see ds3231_shadow.c
+static SemaphoreHandle_t oled_mutex;         // frame buffer and flush, drawn by the display and monitor tasks
 
 #define DEFAULT_STACK_SIZE 200
 #define DEFAULT_PRIORITY 1
@@ -47,10 +66,14 @@ uint8_t current_day = 0;
 #define DEFAULT_COLUMN_POSITION 30
 #define DEFAULT_BUFFER_SIZE 12
 #define ERROR_PAGE_INDEX 6
+#define TEMP_PAGE_INDEX 7
 #define DAY_PAGE_INDEX 4
 #define DATE_PAGE_INDEX 2
 #define TIME_PAGE_INDEX 0
-#define OSC_BIT_EXTRACTION_MASK 0x80
+#define OSC_BIT_EXTRACTION_MASK DS3231_STATUS_OSF
+#define RTC_SQW_TIMEOUT_MS 1100      // a missed edge only delays the refresh, the RTC is read anyway
+#define US_PER_MS 1000
+#define MS_PER_S 1000
 
 /*
  * Description: initialises all the task required for the application
@@ -62,6 +85,29 @@ uint8_t current_day = 0;
 
 void project_task_run(void) {
 
+	i2c_scheduler_init();
+	i2c_hal_set_ops(&i2c_scheduler_hal_ops);
+
+	rtc_status_queue = xQueueCreate(1, sizeof(uint8_t));
+	configASSERT(rtc_status_queue != NULL);
+
+	rtc_shadow_mutex = xSemaphoreCreateMutex();
+	configASSERT(rtc_shadow_mutex != NULL);
+	ds3231_shadow_set_lock(lock_rtc_shadow, unlock_rtc_shadow);
+
+	oled_mutex = xSemaphoreCreateMutex();
+	configASSERT(oled_mutex != NULL);
+
+	rtc_sqw_init();
+	rtc_alarm_init();
+	ds3231_set_clock(clock_service_seconds);
+#if RTC_CALIBRATION_ENABLE
+	rtc_calibration_init();
+#endif
+#if CLOCK_SOURCE_RTC_CLKIN
+	rtc_clkin_init();
+#endif
+
 	status = xTaskCreate(init_handler, "INIT_TASK", DEFAULT_STACK_SIZE, NULL,
 	DEFAULT_PRIORITY, &init_handle);
 
@@ -89,7 +135,38 @@ void project_task_run(void) {
 }
 
 /*
- * Description: task which takes care if there is any clock or power lost in the RTC by looking onto the OSC bit in the control register
+ * Description: takes the lock of the DS3231 register copy, the mutex gives the priority of a waiting task to
+ *              the holder. Before the scheduler runs there is a single thread and nothing is locked.
+ * Parameters:
+ * 		None
+ * Returns:
+ *   		None
+ */
+
+static void lock_rtc_shadow(void) {
+
+	if (xTaskGetSchedulerState() == taskSCHEDULER_RUNNING)
+		xSemaphoreTake(rtc_shadow_mutex, portMAX_DELAY);
+}
+
+/*
+ * Description: gives back the lock of the DS3231 register copy
+ * Parameters:
+ * 		None
+ * Returns:
+ *   		None
+ */
+
+static void unlock_rtc_shadow(void) {
+
+	if (xTaskGetSchedulerState() == taskSCHEDULER_RUNNING)
+		xSemaphoreGive(rtc_shadow_mutex);
+}
+
+/*
+ * Description: task which takes care if there is any clock or power lost in the RTC by looking onto the OSC bit in the control register.
+ *              The status register comes with the snapshot read by the display task, so this task waits on the
+ *              status queue instead of reading the RTC on its own.
  * Parameters:
  * 		void* parameters    a void pointer
  * Returns:
@@ -100,17 +177,20 @@ static void monitor_failure_handler(void *parameters) {
 	char buffer[DEFAULT_BUFFER_SIZE];
 
 	while (1) {
-		ds3231_error_status(&status);
+		xQueueReceive(rtc_status_queue, &status, portMAX_DELAY);
 		strcpy(buffer, "CLOCK LOST");
 		if (status & (OSC_BIT_EXTRACTION_MASK)) {
+			xSemaphoreTake(oled_mutex, portMAX_DELAY);
 			oled_clear_page(ERROR_PAGE_INDEX);
 			oled_printstring(buffer, DEFAULT_COLUMN_POSITION, ERROR_PAGE_INDEX);
+			oled_flush();
+			xSemaphoreGive(oled_mutex);
 		}
 	}
 }
 
 /*
- * Description: task which sets the date an time in the RTC
+ * Description: task which sets the date an time in the RTC in one write, which also clears the OSF flag
  * Parameters:
  * 		void* parameters
  * Returns:
@@ -122,7 +202,6 @@ static void rtc_set_handler(void *parameters) {
 	ds3231_time_t set_time;
 
 	set_date.date = 13;
-	set_date.dow = 3;
 	set_date.month = 12;
 	set_date.year = 2023;
 
@@ -132,8 +211,8 @@ static void rtc_set_handler(void *parameters) {
 
 	while (1) {
 
-		ds3231_set_date(&set_date);
-		ds3231_set_time(&set_time);
+		ds3231_set_datetime(&set_time, &set_date);
+		clock_service_invalidate();   // the next refresh reads the new time back
 		vTaskSuspend(NULL);           // suspending itself
 
 	}
@@ -141,7 +220,13 @@ static void rtc_set_handler(void *parameters) {
 }
 
 /*
- * Description: read the time and date from the rtc and prints it on the display
+ * Description: waits for the 1 Hz square wave edge of the rtc and prints the time and date of the second which
+ *              started at the edge, taken from the clock service and shown in the local time of the zone
+ *              selected with tz_select. Every CLOCK_RESYNC_PERIOD_S the time, date and status of the rtc are
+ *              read in one burst to sync the clock service and the status register is handed over to the
+ *              monitor task. If no edge comes within RTC_SQW_TIMEOUT_MS the display is refreshed anyway.
+ *              While an alarm is armed the pin gives no edges and the task sleeps until the next second of
+ *              the clock service instead.
  * Parameters:
  * 		void *parameters
  * Returns:
@@ -150,16 +235,59 @@ static void rtc_set_handler(void *parameters) {
 
 static void rtc_read_handler_and_display(void *parameters) {
 
+	ds3231_snapshot_t snapshot;
 	ds3231_date_t read_date;
 	ds3231_time_t read_time;
+	uint64_t edge_cycles;
+	uint32_t seconds, timeout_ms;
+	clock_timestamp_t now;
+	tz_local_t local;
+	bool at_edge, temperature_read;
+	int16_t temperature, shown_temperature = INT16_MIN;
+#if I2C_TRACE_ENABLE
+	TickType_t last_trace_dump = xTaskGetTickCount();
+#endif
 
 	while (1) {
 
-		ds3231_read_date(&read_date);
-		ds3231_read_time(&read_time);
+		timeout_ms = RTC_SQW_TIMEOUT_MS;
+		if (rtc_sqw_alarm_mode() && clock_service_now(&now))   // no second edges while an alarm is armed
+			timeout_ms = (US_PER_MS * MS_PER_S - now.microseconds) / US_PER_MS + 1;
+
+		at_edge = rtc_sqw_wait(timeout_ms);
+		edge_cycles = at_edge ? rtc_sqw_last_edge_cycles() : cycle_counter_now64();
+
+		if (clock_service_sync_due() && ds3231_read_snapshot(&snapshot) == I2C_STATUS_OK) {
+			clock_service_sync(&snapshot, edge_cycles, at_edge);
+			xQueueOverwrite(rtc_status_queue, &snapshot.status);
+		}
+
+		temperature_read = ds3231_read_temperature(&temperature) == I2C_STATUS_OK;   // on the bus once per 64 s
+
+		xSemaphoreTake(oled_mutex, portMAX_DELAY);   // the monitor task draws on the same frame buffer
+		if (clock_service_second_at_edge(edge_cycles, &seconds)) {
+			tz_to_local(seconds, &local);                 // the RTC keeps UTC
+			clock_service_to_datetime(local.seconds, &read_time, &read_date);
+			print_time_and_date(&read_date, &read_time);
+		}
+
+		if (temperature_read && temperature != shown_temperature) {
+			print_temperature(temperature);
+			shown_temperature = temperature;
+		}
 
-		print_time_and_date(&read_date, &read_time);
+		oled_flush();                                 // only the columns which changed go on the bus
+		xSemaphoreGive(oled_mutex);
 
+#if CPU_PROFILE_ENABLE
+		benchmark_display_frame(rtc_read_handle);
+#endif
+#if I2C_TRACE_ENABLE
+		if (xTaskGetTickCount() - last_trace_dump >= pdMS_TO_TICKS(I2C_TRACE_DUMP_PERIOD_MS)) {
+			i2c_trace_dump();
+			last_trace_dump = xTaskGetTickCount();
+		}
+#endif
 		}
 
 	}
@@ -175,17 +303,28 @@ static void rtc_read_handler_and_display(void *parameters) {
 static void init_handler(void *parameters) {
 
 	while (1) {
-		i2c0_init();
-		i2c0_pins_init();
+		i2c_board_init();
+		ds3231_set_square_wave(DS3231_SQW_1HZ);
+#if CLOCK_SOURCE_RTC_CLKIN
+		ds3231_set_32khz_output(true);
+#endif
+		xSemaphoreTake(oled_mutex, portMAX_DELAY);
 		oled_init();
 		oled_clearDisplay();
+		xSemaphoreGive(oled_mutex);
+#if CPU_PROFILE_ENABLE
+		benchmark_i2c_transaction_rate();
+		benchmark_bcd_codec();
+#endif
 		vTaskSuspend(NULL);   // suspending itself after done initialisation
 
 	}
 }
 
 /*
- * Description: prints the data on the display by calling oled drivers
+ * Description: prints the data on the display by calling oled drivers, the date and the day are only drawn
+ *              again when any field of the date changed. The time has a fixed width and is drawn over the
+ *              last one without clearing its page, so only the digits which changed are flushed.
  * Parameters:
  * 	ds3231_date_t *data  it contains the read date data from the RTC
  * 	ds3231_time_t *time   it contains the read time from the RTC
@@ -203,12 +342,11 @@ static void print_time_and_date(ds3231_date_t *date, ds3231_time_t *time) {
 	if (time == NULL)
 		return;
 
-	oled_clear_page(TIME_PAGE_INDEX);
-
 	sprintf(time_buffer, "%02d:%02d:%02d", time->hour, time->min, time->sec);
 	oled_printstring(time_buffer, DEFAULT_COLUMN_POSITION, TIME_PAGE_INDEX);
 
-	if (current_day != date->dow) {
+	if (date->date != shown_date.date || date->month != shown_date.month || date->year != shown_date.year
+			|| date->dow != shown_date.dow) {
 		sprintf(date_buffer, "%02d/%02d/%02d", date->date, date->month,
 				date->year);
 		strcpy(day, ds3231_get_day_of_week(date->dow));
@@ -216,8 +354,24 @@ static void print_time_and_date(ds3231_date_t *date, ds3231_time_t *time) {
 		oled_printstring(date_buffer, DEFAULT_COLUMN_POSITION, DATE_PAGE_INDEX);
 		oled_clear_page(DAY_PAGE_INDEX);
 		oled_printstring(day, DEFAULT_COLUMN_POSITION, DAY_PAGE_INDEX);
-		current_day = date->dow;
+		shown_date = *date;
 	}
 
 }
 
+/*
+ * Description: prints the die temperature of the rtc on the display
+ * Parameters:
+ * 	int16_t centi_celsius  the temperature in 0.01 degree C
+ * Returns:
+ *   		None
+ */
+static void print_temperature(int16_t centi_celsius) {
+
+	char buffer[DEFAULT_BUFFER_SIZE];
+	int magnitude = abs(centi_celsius);
+
+	sprintf(buffer, "%s%d.%02d C", centi_celsius < 0 ? "-" : "", magnitude / 100, magnitude % 100);
+	oled_clear_page(TEMP_PAGE_INDEX);
+	oled_printstring(buffer, DEFAULT_COLUMN_POSITION, TEMP_PAGE_INDEX);
+}
@@ -0,0 +1,276 @@
+/*******************************************************************************
+ * Copyright (C) 2023 by PRANJAL GUPTA
+ *
+ * Redistribution, modification or use of this software in source or binary
+ * forms is permitted as long as the files maintain this copyright. Users are
+ * permitted to modify this and use it to learn about the field of embedded
+ * software. PRANJAL GUPTA and the University of Colorado are not liable for
+ * any misuse of this material.
+ * ****************************************************************************/
+
+/**
+ * @file    rtc_alarm.c
+ * @brief   This file contains the alarm task. The armed alarms are kept in a list sorted by the time they fire
+ *          next and the first one is programmed into the DS3231 alarm 1, so nothing is polled: the alarm task
+ *          sleeps until the DS3231 pulls its INT/SQW pin low, calls the alarms which are due, puts the
+ *          periodic ones back in the list and programs the next one.
+ *          The DS3231 has one pin for the square wave and the alarm interrupt. While an alarm is armed the
+ *          pin is the alarm interrupt and the display is paced by the clock service, when the last alarm is
+ *          gone the 1 Hz square wave is selected again.
+ *
+ * @author  Pranjal Gupta
+ * @date    12/22/2023
+ *
+ */
+#include "rtc_alarm.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include "semphr.h"
+#include "DS3231.h"
+#include "rtc_sqw.h"
+#include "clock_service.h"
+
+static void rtc_alarm_handler(void *parameters);
+static void insert_sorted(rtc_alarm_t *alarm);
+static void remove_alarm(rtc_alarm_t *alarm);
+static void program_next(void);
+static uint32_t current_seconds(void);
+
+#define RTC_ALARM_STACK_SIZE 150
+#define RTC_ALARM_PRIORITY 2
+
+static rtc_alarm_t *alarm_list = NULL;
+static SemaphoreHandle_t list_mutex;
+static uint32_t programmed_at = 0;            // fire time held in the DS3231 alarm 1, 0 for none
+
+/*
+ * Description: creates the alarm task, it has to be called before the scheduler is started and after
+ *              rtc_sqw_init
+ * Parameters:
+ * 		None
+ * Returns:
+ *   		None
+ */
+
+void rtc_alarm_init(void) {
+
+	BaseType_t status;
+
+	list_mutex = xSemaphoreCreateMutex();
+	configASSERT(list_mutex != NULL);
+
+	status = xTaskCreate(rtc_alarm_handler, "RTC_ALARM", RTC_ALARM_STACK_SIZE, NULL, RTC_ALARM_PRIORITY, NULL);
+	configASSERT(status == pdPASS);
+}
+
+/*
+ * Description: arms an alarm, an alarm which is already armed is moved to the new time
+ * Parameters:
+ * 		rtc_alarm_t * the alarm
+ * 		uint32_t time it fires, seconds since 2000-01-01
+ * 		uint32_t seconds between two firings, 0 to fire once
+ * 		rtc_alarm_callback_t function called from the alarm task when it fires
+ * 		void * passed to the callback
+ * Returns:
+ *   		None
+ */
+
+void rtc_alarm_add(rtc_alarm_t *alarm, uint32_t fire_at, uint32_t period_s, rtc_alarm_callback_t callback,
+		void *context) {
+
+	xSemaphoreTake(list_mutex, portMAX_DELAY);
+
+	if (alarm->armed)
+		remove_alarm(alarm);
+
+	alarm->fire_at = fire_at;
+	alarm->period_s = period_s;
+	alarm->callback = callback;
+	alarm->context = context;
+	insert_sorted(alarm);
+
+	if (alarm_list == alarm)
+		program_next();
+
+	xSemaphoreGive(list_mutex);
+}
+
+/*
+ * Description: disarms an alarm, nothing is done when it is not armed
+ * Parameters:
+ * 		rtc_alarm_t * the alarm
+ * Returns:
+ *   		None
+ */
+
+void rtc_alarm_cancel(rtc_alarm_t *alarm) {
+
+	bool was_first;
+
+	xSemaphoreTake(list_mutex, portMAX_DELAY);
+
+	if (alarm->armed) {
+		was_first = (alarm_list == alarm);
+		remove_alarm(alarm);
+		if (was_first)
+			program_next();
+	}
+
+	xSemaphoreGive(list_mutex);
+}
+
+/*
+ * Description: puts an alarm in the list behind the alarms firing at the same time or before it
+ * Parameters:
+ * 		rtc_alarm_t * the alarm
+ * Returns:
+ *   		None
+ */
+
+static void insert_sorted(rtc_alarm_t *alarm) {
+
+	rtc_alarm_t **link = &alarm_list;
+
+	while (*link != NULL && (*link)->fire_at <= alarm->fire_at)
+		link = &(*link)->next;
+
+	alarm->next = *link;
+	*link = alarm;
+	alarm->armed = true;
+}
+
+/*
+ * Description: takes an armed alarm out of the list
+ * Parameters:
+ * 		rtc_alarm_t * the alarm
+ * Returns:
+ *   		None
+ */
+
+static void remove_alarm(rtc_alarm_t *alarm) {
+
+	rtc_alarm_t **link = &alarm_list;
+
+	while (*link != NULL && *link != alarm)
+		link = &(*link)->next;
+
+	if (*link != NULL)
+		*link = alarm->next;
+	alarm->next = NULL;
+	alarm->armed = false;
+}
+
+/*
+ * Description: programs the first alarm of the list into the DS3231 alarm 1 and selects the alarm interrupt
+ *              on the INT/SQW pin, or the square wave again when the list is empty. A1F is cleared before
+ *              the write, so a match of the new alarm always pulls the pin. An alarm already due can not be
+ *              matched by the DS3231 any more, the time is read again after the write and the alarm task is
+ *              woken at once when the alarm was reached meanwhile. It is called with the list mutex held.
+ * Parameters:
+ * 		None
+ * Returns:
+ *   		None
+ */
+
+static void program_next(void) {
+
+	ds3231_time_t time;
+	ds3231_date_t date;
+
+	if (alarm_list == NULL) {
+		if (rtc_sqw_alarm_mode()) {
+			ds3231_enable_alarm1_interrupt(false);
+			ds3231_set_square_wave(DS3231_SQW_1HZ);
+			rtc_sqw_set_alarm_mode(false);
+		}
+		programmed_at = 0;
+		return;
+	}
+
+	if (alarm_list->fire_at == programmed_at && rtc_sqw_alarm_mode())
+		return;
+
+	if (alarm_list->fire_at <= current_seconds()) {
+		rtc_sqw_post_alarm();
+		return;
+	}
+
+	clock_service_to_datetime(alarm_list->fire_at, &time, &date);
+	ds3231_clear_alarm1_flag();              // the flag may have been set by an old match
+	ds3231_set_alarm1(&time, date.date);
+	programmed_at = alarm_list->fire_at;
+
+	if (!rtc_sqw_alarm_mode()) {
+		rtc_sqw_set_alarm_mode(true);
+		ds3231_enable_alarm1_interrupt(true);
+	}
+
+	if (alarm_list->fire_at <= current_seconds())   // reached before the DS3231 could match it
+		rtc_sqw_post_alarm();
+}
+
+/*
+ * Description: the current time from the RTC, or from the clock service when the RTC can not be read
+ * Parameters:
+ * 		None
+ * Returns:
+ *   		uint32_t seconds since 2000-01-01
+ */
+
+static uint32_t current_seconds(void) {
+
+	ds3231_snapshot_t snapshot;
+	clock_timestamp_t now = { 0, 0 };
+
+	if (ds3231_read_snapshot(&snapshot) == I2C_STATUS_OK)
+		return clock_service_from_datetime(&snapshot.time, &snapshot.date);
+
+	clock_service_now(&now);
+	return now.seconds;
+}
+
+/*
+ * Description: alarm task, waits for the alarm interrupt of the DS3231 and calls the alarms which are due.
+ *              A1F is cleared before the time is read, so a match while the alarms are called pulls the pin
+ *              again. A match of the date of the month a month or more before the alarm is taken as early
+ *              and the same alarm is programmed again.
+ * Parameters:
+ * 		void *parameters
+ * Returns:
+ *   		None
+ */
+
+static void rtc_alarm_handler(void *parameters) {
+
+	rtc_alarm_t *alarm;
+	rtc_alarm_callback_t callback;
+	void *context;
+	uint32_t now;
+
+	while (1) {
+
+		rtc_sqw_wait_alarm();
+
+		xSemaphoreTake(list_mutex, portMAX_DELAY);
+		ds3231_clear_alarm1_flag();
+		now = current_seconds();
+
+		while ((alarm = alarm_list) != NULL && alarm->fire_at <= now) {
+			remove_alarm(alarm);
+			if (alarm->period_s != 0) {
+				alarm->fire_at += ((now - alarm->fire_at) / alarm->period_s + 1) * alarm->period_s;
+				insert_sorted(alarm);
+			}
+			callback = alarm->callback;
+			context = alarm->context;
+
+			xSemaphoreGive(list_mutex);
+			callback(context);
+			xSemaphoreTake(list_mutex, portMAX_DELAY);
+		}
+
+		programmed_at = 0;
+		program_next();
+		xSemaphoreGive(list_mutex);
+	}
+}
@@ -0,0 +1,43 @@
+/*******************************************************************************
+ * Copyright (C) 2023 by PRANJAL GUPTA
+ *
+ * Redistribution, modification or use of this software in source or binary
+ * forms is permitted as long as the files maintain this copyright. Users are
+ * permitted to modify this and use it to learn about the field of embedded
+ * software. PRANJAL GUPTA and the University of Colorado are not liable for
+ * any misuse of this material.
+ * ****************************************************************************/
+
+/**
+ * @file    rtc_alarm.h
+ * @brief   This file has function prototypes for the alarms run on the DS3231 alarm 1.
+ *
+ * @author  Pranjal Gupta
+ * @date    12/22/2023
+ *
+ */
+
+#ifndef RTC_ALARM_H_
+#define RTC_ALARM_H_
+
+#include "stdint.h"
+#include "stdbool.h"
+
+typedef void (*rtc_alarm_callback_t)(void *context);
+
+/* an alarm, the structure is owned by the caller and has to stay valid while the alarm is armed */
+typedef struct rtc_alarm {
+	uint32_t fire_at;                  // seconds since 2000-01-01
+	uint32_t period_s;                 // 0 for an alarm which fires once
+	rtc_alarm_callback_t callback;     // called from the alarm task
+	void *context;
+	bool armed;
+	struct rtc_alarm *next;
+} rtc_alarm_t;
+
+void rtc_alarm_init(void);
+void rtc_alarm_add(rtc_alarm_t *alarm, uint32_t fire_at, uint32_t period_s, rtc_alarm_callback_t callback,
+		void *context);
+void rtc_alarm_cancel(rtc_alarm_t *alarm);
+
+#endif /* RTC_ALARM_H_ */
@@ -0,0 +1,228 @@
+/*******************************************************************************
+ * Copyright (C) 2023 by PRANJAL GUPTA
+ *
+ * Redistribution, modification or use of this software in source or binary
+ * forms is permitted as long as the files maintain this copyright. Users are
+ * permitted to modify this and use it to learn about the field of embedded
+ * software. PRANJAL GUPTA and the University of Colorado are not liable for
+ * any misuse of this material.
+ * ****************************************************************************/
+
+/**
+ * @file    rtc_calibration.c
+ * @brief   This file contains the aging offset calibration mode. The receive interrupt of the debug console
+ *          collects the reference lines sent by the host and stamps each with the cycle counter at its
+ *          first character, the calibration task turns the stamp into the RTC time through the clock
+ *          service, feeds the pair to the aging trim fit and writes the aging offset of the DS3231 when
+ *          the fit window is full. The fit then starts again with the new offset, so the error converges
+ *          step by step while the host keeps sending.
+ *
+ * @author  Pranjal Gupta
+ * @date    12/24/2023
+ *
+ */
+#include "rtc_calibration.h"
+
+#if RTC_CALIBRATION_ENABLE
+#include "FreeRTOS.h"
+#include "task.h"
+#include "queue.h"
+#include "semphr.h"
+#include "MKL25Z4.h"
+#include "cycle_counter.h"
+#include "clock_service.h"
+#include "fsl_debug_console.h"
+
+/* one received line and the cycle count of its first character */
+typedef struct {
+	uint64_t cycles;
+	char text[RTC_CALIBRATION_LINE_LENGTH];
+} reference_line_t;
+
+static void rtc_calibration_handler(void *parameters);
+static bool parse_reference(const char *text, int64_t *reference_ms);
+
+#define RTC_CALIBRATION_STACK_SIZE 250
+#define RTC_CALIBRATION_PRIORITY 1
+#define RTC_CALIBRATION_QUEUE_LENGTH 2
+#define RTC_CALIBRATION_IRQ_PRIORITY 2
+#define UART0_ERROR_FLAGS (UART0_S1_OR_MASK | UART0_S1_NF_MASK | UART0_S1_FE_MASK | UART0_S1_PF_MASK)
+#define REFERENCE_PREFIX "REF "
+#define REFERENCE_PREFIX_LENGTH 4
+#define MS_PER_S 1000
+#define US_PER_MS 1000
+
+static QueueHandle_t reference_queue;
+static SemaphoreHandle_t fit_mutex;
+static aging_trim_fit_t fit;
+static reference_line_t rx_line;            // line being received, only touched by the interrupt
+static uint8_t rx_length = 0;
+static bool rx_overflow = false;
+
+/*
+ * Description: creates the calibration task and enables the receive interrupt of the debug console, it has
+ *              to be called before the scheduler is started and after the debug console is initialised
+ * Parameters:
+ * 		None
+ * Returns:
+ *   		None
+ */
+
+void rtc_calibration_init(void) {
+
+	BaseType_t status;
+
+	aging_trim_reset(&fit);
+
+	reference_queue = xQueueCreate(RTC_CALIBRATION_QUEUE_LENGTH, sizeof(reference_line_t));
+	configASSERT(reference_queue != NULL);
+	fit_mutex = xSemaphoreCreateMutex();
+	configASSERT(fit_mutex != NULL);
+
+	status = xTaskCreate(rtc_calibration_handler, "RTC_CALIBRATION", RTC_CALIBRATION_STACK_SIZE, NULL,
+			RTC_CALIBRATION_PRIORITY, NULL);
+	configASSERT(status == pdPASS);
+
+	UART0->C2 |= UART0_C2_RIE_MASK;
+	NVIC_SetPriority(UART0_IRQn, RTC_CALIBRATION_IRQ_PRIORITY);
+	NVIC_ClearPendingIRQ(UART0_IRQn);
+	NVIC_EnableIRQ(UART0_IRQn);
+}
+
+/*
+ * Description: copies the current state of the fit
+ * Parameters:
+ * 		aging_trim_fit_t * the copy
+ * Returns:
+ *   		None
+ */
+
+void rtc_calibration_get_fit(aging_trim_fit_t *copy) {
+
+	xSemaphoreTake(fit_mutex, portMAX_DELAY);
+	*copy = fit;
+	xSemaphoreGive(fit_mutex);
+}
+
+/*
+ * Description: reads the reference time out of a received line
+ * Parameters:
+ * 		const char * the line, "REF " followed by the unix time in ms
+ * 		int64_t * the reference time in ms
+ * Returns:
+ *   		bool false when the line is not a reference line
+ */
+
+static bool parse_reference(const char *text, int64_t *reference_ms) {
+
+	int64_t value = 0;
+
+	for (int i = 0; i < REFERENCE_PREFIX_LENGTH; i++) {
+		if (text[i] != REFERENCE_PREFIX[i])
+			return false;
+	}
+
+	text += REFERENCE_PREFIX_LENGTH;
+	if (*text == '\0')
+		return false;
+
+	for (; *text != '\0'; text++) {
+		if (*text < '0' || *text > '9')
+			return false;
+		value = value * 10 + (*text - '0');
+	}
+
+	*reference_ms = value;
+	return true;
+}
+
+/*
+ * Description: calibration task, takes the RTC time of every reference line and trims the aging offset
+ *              each time the fit window is full
+ * Parameters:
+ * 		void *parameters
+ * Returns:
+ *   		None
+ */
+
+static void rtc_calibration_handler(void *parameters) {
+
+	reference_line_t line;
+	clock_timestamp_t rtc;
+	int64_t reference_ms, rtc_ms;
+	int32_t error_ppb;
+	int8_t offset;
+	i2c_status_t status;
+	bool trimmed;
+
+	while (1) {
+
+		xQueueReceive(reference_queue, &line, portMAX_DELAY);
+
+		if (!parse_reference(line.text, &reference_ms) || !clock_service_time_at(line.cycles, &rtc))
+			continue;
+
+		rtc_ms = (int64_t) rtc.seconds * MS_PER_S + rtc.microseconds / US_PER_MS;
+
+		xSemaphoreTake(fit_mutex, portMAX_DELAY);
+		aging_trim_add_sample(&fit, reference_ms, rtc_ms);
+		trimmed = aging_trim_estimate(&fit, &error_ppb);
+		xSemaphoreGive(fit_mutex);
+
+		if (!trimmed) {
+			PRINTF("CAL %u %u %u\r\n", (unsigned) fit.samples, (unsigned) fit.last_x, (unsigned) fit.restarts);
+			continue;
+		}
+
+		status = aging_trim_apply(error_ppb, &offset);
+		PRINTF("TRIM %d %d %d\r\n", (int) error_ppb, offset, status);
+
+		if (status == I2C_STATUS_OK) {             // the error measured so far belongs to the old offset
+			xSemaphoreTake(fit_mutex, portMAX_DELAY);
+			aging_trim_reset(&fit);
+			xSemaphoreGive(fit_mutex);
+		}
+	}
+}
+
+/*
+ * Description: receive interrupt of the debug console, collects one line and queues it with the cycle
+ *              count of its first character. Lines longer than the buffer are dropped.
+ * Parameters:
+ * 		None
+ * Returns:
+ *   		None
+ */
+
+void UART0_IRQHandler(void) {
+
+	BaseType_t woken = pdFALSE;
+	uint8_t flags = UART0->S1;
+	char c;
+
+	if (flags & UART0_ERROR_FLAGS)
+		UART0->S1 = flags & UART0_ERROR_FLAGS;       // write 1 to clear
+	if (!(flags & UART0_S1_RDRF_MASK))
+		return;
+
+	c = (char) UART0->D;
+
+	if (c == '\r' || c == '\n') {
+		if (rx_length > 0 && !rx_overflow) {
+			rx_line.text[rx_length] = '\0';
+			xQueueSendFromISR(reference_queue, &rx_line, &woken);   // dropped when the task is behind
+		}
+		rx_length = 0;
+		rx_overflow = false;
+	} else if (rx_length < RTC_CALIBRATION_LINE_LENGTH - 1) {
+		if (rx_length == 0)
+			rx_line.cycles = cycle_counter_now64();
+		rx_line.text[rx_length++] = c;
+	} else {
+		rx_overflow = true;
+	}
+
+	portYIELD_FROM_ISR(woken);
+}
+
+#endif /* RTC_CALIBRATION_ENABLE */
@@ -0,0 +1,44 @@
+/*******************************************************************************
+ * Copyright (C) 2023 by PRANJAL GUPTA
+ *
+ * Redistribution, modification or use of this software in source or binary
+ * forms is permitted as long as the files maintain this copyright. Users are
+ * permitted to modify this and use it to learn about the field of embedded
+ * software. PRANJAL GUPTA and the University of Colorado are not liable for
+ * any misuse of this material.
+ * ****************************************************************************/
+
+/**
+ * @file    rtc_calibration.h
+ * @brief   This file has the function prototypes of the aging offset calibration mode, built in with
+ *          RTC_CALIBRATION_ENABLE=1.
+ *
+ * @author  Pranjal Gupta
+ * @date    12/24/2023
+ *
+ */
+
+#ifndef RTC_CALIBRATION_H_
+#define RTC_CALIBRATION_H_
+
+#include "stdint.h"
+#include "stdbool.h"
+#include "aging_trim.h"
+
+/*
+ * Build with RTC_CALIBRATION_ENABLE=1 to trim the aging offset of the DS3231 against a reference clock.
+ * tools/rtc_reference.py sends "REF <unix time in ms>" lines on the debug console, every line is stamped
+ * with the RTC time when its first character comes in and the frequency error is fitted over
+ * AGING_TRIM_WINDOW_S. Progress is printed as "CAL <samples> <window s> <restarts>" lines and every
+ * change of the aging offset as "TRIM <error ppb> <offset> <i2c status>".
+ */
+#ifndef RTC_CALIBRATION_ENABLE
+#define RTC_CALIBRATION_ENABLE 0
+#endif
+
+#define RTC_CALIBRATION_LINE_LENGTH 24
+
+void rtc_calibration_init(void);
+void rtc_calibration_get_fit(aging_trim_fit_t *copy);
+
+#endif /* RTC_CALIBRATION_H_ */
@@ -0,0 +1,100 @@
+/*******************************************************************************
+ * Copyright (C) 2023 by PRANJAL GUPTA
+ *
+ * Redistribution, modification or use of this software in source or binary
+ * forms is permitted as long as the files maintain this copyright. Users are
+ * permitted to modify this and use it to learn about the field of embedded
+ * software. PRANJAL GUPTA and the University of Colorado are not liable for
+ * any misuse of this material.
+ * ****************************************************************************/
+
+/**
+ * @file    rtc_clkin.c
+ * @brief   This file contains the KL25Z RTC clocked from the 32.768 kHz output of the DS3231 on RTC_CLKIN.
+ *          The prescaler (TPR) counts the 32 kHz cycles and the seconds register (TSR) counts up each
+ *          time bit 14 of the prescaler falls, every 32768 cycles, so the seconds are TSR and the fraction
+ *          is the low 15 bits of TPR. Both are free running in hardware, a read is four register accesses.
+ *
+ * @author  Pranjal Gupta
+ * @date    12/27/2023
+ *
+ */
+#include "rtc_clkin.h"
+#include "MKL25Z4.h"
+
+#define OSC32KSEL_RTC_CLKIN 2            // ERCLK32K taken from the RTC_CLKIN pin
+#define PRESCALER_FRACTION_MASK 0x7FFF   // 32768 cycles per second
+#define US_PER_S 1000000UL
+#define US_PER_PRESCALER_Q9 15625        // 10^6 / 32768 = 15625 / 512
+#define PRESCALER_Q 9
+
+/*
+ * Description: muxes PTC1 to RTC_CLKIN with a pull-up for the open drain 32K output of the DS3231, selects it
+ *              as the 32 kHz clock of the RTC and stops the time counter until it is loaded
+ * Parameters:
+ * 		None
+ * Returns:
+ *   		None
+ */
+
+void rtc_clkin_init(void) {
+
+	SIM->SCGC5 |= SIM_SCGC5_PORTC_MASK;
+	PORTC->PCR[RTC_CLKIN_PIN] = PORT_PCR_MUX(1) | PORT_PCR_PE_MASK | PORT_PCR_PS_MASK;
+
+	SIM->SOPT1 = (SIM->SOPT1 & ~SIM_SOPT1_OSC32KSEL_MASK) | SIM_SOPT1_OSC32KSEL(OSC32KSEL_RTC_CLKIN);
+	SIM->SCGC6 |= SIM_SCGC6_RTC_MASK;
+
+	RTC->SR &= ~RTC_SR_TCE_MASK;
+}
+
+/*
+ * Description: sets the RTC to a time and starts it, the time counter is stopped while the seconds and the
+ *              prescaler are written. Writing the seconds clears the invalid and overflow flags.
+ * Parameters:
+ * 		uint32_t seconds since 2000-01-01
+ * 		uint32_t micro seconds into that second
+ * Returns:
+ *   		None
+ */
+
+void rtc_clkin_load(uint32_t seconds, uint32_t microseconds) {
+
+	while (microseconds >= US_PER_S) {
+		microseconds -= US_PER_S;
+		seconds++;
+	}
+
+	RTC->SR &= ~RTC_SR_TCE_MASK;
+	RTC->TSR = seconds;
+	RTC->TPR = (microseconds << PRESCALER_Q) / US_PER_PRESCALER_Q9;
+	RTC->SR |= RTC_SR_TCE_MASK;
+}
+
+/*
+ * Description: reads the time from the RTC, the seconds and the prescaler are read again until both reads
+ *              agree so a carry between the two registers is never seen half done. Can be called from tasks
+ *              and ISRs.
+ * Parameters:
+ * 		uint32_t * seconds since 2000-01-01
+ * 		uint32_t * micro seconds into that second
+ * Returns:
+ *   		bool false when the RTC is not loaded or lost its time
+ */
+
+bool rtc_clkin_read(uint32_t *seconds, uint32_t *microseconds) {
+
+	uint32_t tsr, tpr;
+
+	if ((RTC->SR & (RTC_SR_TIF_MASK | RTC_SR_TOF_MASK)) || !(RTC->SR & RTC_SR_TCE_MASK))
+		return false;
+
+	do {
+		tsr = RTC->TSR;
+		tpr = RTC->TPR;
+	} while (tsr != RTC->TSR || tpr != RTC->TPR);
+
+	*seconds = tsr;
+	*microseconds = ((tpr & PRESCALER_FRACTION_MASK) * US_PER_PRESCALER_Q9) >> PRESCALER_Q;
+	return true;
+}
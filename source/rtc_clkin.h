@@ -0,0 +1,42 @@
+/*******************************************************************************
+ * Copyright (C) 2023 by PRANJAL GUPTA
+ *
+ * Redistribution, modification or use of this software in source or binary
+ * forms is permitted as long as the files maintain this copyright. Users are
+ * permitted to modify this and use it to learn about the field of embedded
+ * software. PRANJAL GUPTA and the University of Colorado are not liable for
+ * any misuse of this material.
+ * ****************************************************************************/
+
+/**
+ * @file    rtc_clkin.h
+ * @brief   This file has the function prototypes of the KL25Z RTC counting the 32.768 kHz output of the DS3231.
+ *
+ * @author  Pranjal Gupta
+ * @date    12/27/2023
+ *
+ */
+
+#ifndef RTC_CLKIN_H_
+#define RTC_CLKIN_H_
+
+#include "stdint.h"
+#include "stdbool.h"
+
+/*
+ * Build with CLOCK_SOURCE_RTC_CLKIN=1 when the 32K pin of the DS3231 is wired to PTC1 (RTC_CLKIN). The
+ * clock service then loads the KL25Z RTC from one DS3231 snapshot at a square wave edge and answers every
+ * time query from the RTC seconds and prescaler registers. Both count the same TCXO, so the RTC is never
+ * read again over i2c for the time.
+ */
+#ifndef CLOCK_SOURCE_RTC_CLKIN
+#define CLOCK_SOURCE_RTC_CLKIN 0
+#endif
+
+#define RTC_CLKIN_PIN 1                  // PTC1
+
+void rtc_clkin_init(void);
+void rtc_clkin_load(uint32_t seconds, uint32_t microseconds);
+bool rtc_clkin_read(uint32_t *seconds, uint32_t *microseconds);
+
+#endif /* RTC_CLKIN_H_ */
@@ -0,0 +1,181 @@
+/*******************************************************************************
+ * Copyright (C) 2023 by PRANJAL GUPTA
+ *
+ * Redistribution, modification or use of this software in source or binary
+ * forms is permitted as long as the files maintain this copyright. Users are
+ * permitted to modify this and use it to learn about the field of embedded
+ * software. PRANJAL GUPTA and the University of Colorado are not liable for
+ * any misuse of this material.
+ * ****************************************************************************/
+
+/**
+ * @file    rtc_sqw.c
+ * @brief   This file contains the PORTD pin interrupt of the DS3231 1 Hz square wave. The falling edge comes
+ *          with the update of the seconds register, the interrupt gives a binary semaphore which the display
+ *          task waits on, so the RTC is read once per second right after the second changed. A semaphore is
+ *          used as task notifications of the tasks doing i2c transfers are reserved for the i2c driver.
+ *          While an alarm is armed the DS3231 drives the pin as the alarm interrupt instead, the falling edge
+ *          then gives the alarm semaphore and there are no second edges.
+ *
+ * @author  Pranjal Gupta
+ * @date    12/19/2023
+ *
+ */
+#include "rtc_sqw.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include "semphr.h"
+#include "MKL25Z4.h"
+#include "cycle_counter.h"
+
+#define RTC_SQW_IRQ_PRIORITY 2
+#define PORT_IRQC_FALLING_EDGE 0x0A
+
+static SemaphoreHandle_t second_tick;
+static SemaphoreHandle_t alarm_event;
+static volatile bool alarm_mode = false;
+static volatile uint32_t edge_count = 0;
+static volatile uint64_t edge_cycles = 0;
+
+/*
+ * Description: configures the square wave pin as a GPIO input with pull-up and a falling edge interrupt,
+ *              it has to be called before the scheduler is started
+ * Parameters:
+ * 		None
+ * Returns:
+ *   		None
+ */
+
+void rtc_sqw_init(void) {
+
+	second_tick = xSemaphoreCreateBinary();
+	configASSERT(second_tick != NULL);
+	alarm_event = xSemaphoreCreateBinary();
+	configASSERT(alarm_event != NULL);
+
+	SIM->SCGC5 |= SIM_SCGC5_PORTD_MASK;
+	PTD->PDDR &= ~(1U << RTC_SQW_PIN);
+	PORTD->PCR[RTC_SQW_PIN] = PORT_PCR_MUX(1) | PORT_PCR_PE_MASK | PORT_PCR_PS_MASK  // open drain output of the RTC
+			| PORT_PCR_ISF_MASK | PORT_PCR_IRQC(PORT_IRQC_FALLING_EDGE);
+
+	NVIC_SetPriority(PORTD_IRQn, RTC_SQW_IRQ_PRIORITY);
+	NVIC_ClearPendingIRQ(PORTD_IRQn);
+	NVIC_EnableIRQ(PORTD_IRQn);
+}
+
+/*
+ * Description: blocks the calling task until the next falling edge of the square wave
+ * Parameters:
+ * 		uint32_t the longest wait in ms
+ * Returns:
+ *   		bool true when an edge came, false when the wait timed out
+ */
+
+bool rtc_sqw_wait(uint32_t timeout_ms) {
+	return xSemaphoreTake(second_tick, pdMS_TO_TICKS(timeout_ms)) == pdPASS;
+}
+
+/*
+ * Description: returns the number of square wave edges seen since start-up
+ * Parameters:
+ * 		None
+ * Returns:
+ *   		uint32_t the edge count
+ */
+
+uint32_t rtc_sqw_edge_count(void) {
+	return edge_count;
+}
+
+/*
+ * Description: returns the core cycle count taken in the interrupt of the last square wave edge, the time
+ *              the seconds register of the RTC changed
+ * Parameters:
+ * 		None
+ * Returns:
+ *   		uint64_t cycle count of cycle_counter_now64
+ */
+
+uint64_t rtc_sqw_last_edge_cycles(void) {
+
+	uint64_t cycles;
+
+	taskENTER_CRITICAL();                 // 64 bit value written by the interrupt
+	cycles = edge_cycles;
+	taskEXIT_CRITICAL();
+	return cycles;
+}
+
+/*
+ * Description: tells the interrupt what the DS3231 drives on the pin, to be called after the control
+ *              register of the DS3231 was changed
+ * Parameters:
+ * 		bool true for the alarm interrupt, false for the square wave
+ * Returns:
+ *   		None
+ */
+
+void rtc_sqw_set_alarm_mode(bool enable) {
+	alarm_mode = enable;
+}
+
+/*
+ * Description: tells whether the pin is the alarm interrupt, then rtc_sqw_wait only returns on its timeout
+ * Parameters:
+ * 		None
+ * Returns:
+ *   		bool true for the alarm interrupt
+ */
+
+bool rtc_sqw_alarm_mode(void) {
+	return alarm_mode;
+}
+
+/*
+ * Description: blocks the calling task until the DS3231 asserts its alarm interrupt
+ * Parameters:
+ * 		None
+ * Returns:
+ *   		None
+ */
+
+void rtc_sqw_wait_alarm(void) {
+	xSemaphoreTake(alarm_event, portMAX_DELAY);
+}
+
+/*
+ * Description: wakes the task waiting for the alarm interrupt from a task, for an alarm which is already due
+ * Parameters:
+ * 		None
+ * Returns:
+ *   		None
+ */
+
+void rtc_sqw_post_alarm(void) {
+	xSemaphoreGive(alarm_event);
+}
+
+/*
+ * Description: PORTD pin interrupt handler, wakes the task waiting for the next second or for the alarm
+ * Parameters:
+ * 		None
+ * Returns:
+ *   		None
+ */
+
+void PORTD_IRQHandler(void) {
+
+	BaseType_t higher_priority_task_woken = pdFALSE;
+
+	if (PORTD->ISFR & (1U << RTC_SQW_PIN)) {
+		PORTD->ISFR = 1U << RTC_SQW_PIN;                  // write one to clear
+		if (alarm_mode) {
+			xSemaphoreGiveFromISR(alarm_event, &higher_priority_task_woken);
+		} else {
+			edge_cycles = cycle_counter_now64();
+			edge_count++;
+			xSemaphoreGiveFromISR(second_tick, &higher_priority_task_woken);
+		}
+	}
+	portYIELD_FROM_ISR(higher_priority_task_woken);
+}
@@ -0,0 +1,41 @@
+/*******************************************************************************
+ * Copyright (C) 2023 by PRANJAL GUPTA
+ *
+ * Redistribution, modification or use of this software in source or binary
+ * forms is permitted as long as the files maintain this copyright. Users are
+ * permitted to modify this and use it to learn about the field of embedded
+ * software. PRANJAL GUPTA and the University of Colorado are not liable for
+ * any misuse of this material.
+ * ****************************************************************************/
+
+/**
+ * @file    rtc_sqw.h
+ * @brief   This file has function prototypes for the DS3231 INT/SQW pin input, the 1 Hz square wave or the
+ *          alarm interrupt.
+ *
+ * @author  Pranjal Gupta
+ * @date    12/19/2023
+ *
+ */
+
+#ifndef RTC_SQW_H_
+#define RTC_SQW_H_
+
+#include "stdint.h"
+#include "stdbool.h"
+
+/* the INT/SQW pin of the DS3231 is wired to PTD4 */
+#ifndef RTC_SQW_PIN
+#define RTC_SQW_PIN 4
+#endif
+
+void rtc_sqw_init(void);
+bool rtc_sqw_wait(uint32_t timeout_ms);
+uint32_t rtc_sqw_edge_count(void);
+uint64_t rtc_sqw_last_edge_cycles(void);
+void rtc_sqw_set_alarm_mode(bool enable);
+bool rtc_sqw_alarm_mode(void);
+void rtc_sqw_wait_alarm(void);
+void rtc_sqw_post_alarm(void);
+
+#endif /* RTC_SQW_H_ */
@@ -0,0 +1,144 @@
+/*******************************************************************************
+ * Copyright (C) 2023 by PRANJAL GUPTA
+ *
+ * Redistribution, modification or use of this software in source or binary
+ * forms is permitted as long as the files maintain this copyright. Users are
+ * permitted to modify this and use it to learn about the field of embedded
+ * software. PRANJAL GUPTA and the University of Colorado are not liable for
+ * any misuse of this material.
+ * ****************************************************************************/
+
+/**
+ * @file    tz.c
+ * @brief   This file contains the conversion of UTC seconds into the local time of the selected zone. The
+ *          period of the last lookup is kept, so while the time stays in it a conversion is two compares
+ *          against the flash table, a binary search over the period starts runs only when a transition
+ *          was crossed or the zone was changed. The zone is selected by name at run time.
+ *
+ * @author  Pranjal Gupta
+ * @date    12/28/2023
+ *
+ */
+#include "tz.h"
+#include "string.h"
+#include "stddef.h"
+
+static const tz_zone_t *find_zone(const char *name);
+static uint16_t find_period(const tz_zone_t *zone, uint32_t utc_seconds);
+
+/*
+ * Selected zone and the period of the last lookup. The period is checked against the zone it is used with,
+ * so a lookup racing with tz_select only does a binary search.
+ */
+static const tz_zone_t *volatile selected = NULL;
+static volatile uint16_t cached_period = 0;
+
+/*
+ * Description: selects the zone used by tz_to_local
+ * Parameters:
+ * 		const char * IANA name of a zone compiled into tz_zones.c, e.g. "America/Denver"
+ * Returns:
+ *   		bool false when the zone was not compiled in, the selection is not changed then
+ */
+
+bool tz_select(const char *name) {
+
+	const tz_zone_t *zone = find_zone(name);
+
+	if (zone == NULL)
+		return false;
+
+	cached_period = 0;
+	selected = zone;
+	return true;
+}
+
+/*
+ * Description: returns the selected zone, TZ_DEFAULT_ZONE until tz_select is called
+ * Parameters:
+ * 		None
+ * Returns:
+ *   		const tz_zone_t * the zone
+ */
+
+const tz_zone_t *tz_selected(void) {
+
+	if (selected == NULL)
+		selected = find_zone(TZ_DEFAULT_ZONE);
+	return selected;
+}
+
+/*
+ * Description: converts UTC seconds since 2000-01-01 into the local time of the selected zone
+ * Parameters:
+ * 		uint32_t UTC seconds since 2000-01-01
+ * 		tz_local_t * the local time, its offset and abbreviation
+ * Returns:
+ *   		None
+ */
+
+void tz_to_local(uint32_t utc_seconds, tz_local_t *local) {
+
+	const tz_zone_t *zone = tz_selected();
+	uint16_t period = cached_period;
+	const tz_type_t *type;
+
+	if (zone == NULL) {                  // TZ_DEFAULT_ZONE not compiled in
+		local->seconds = utc_seconds;
+		local->offset_minutes = 0;
+		local->abbreviation = "UTC";
+		return;
+	}
+
+	if (period >= zone->count || utc_seconds < zone->starts[period]
+			|| (period + 1 < zone->count && utc_seconds >= zone->starts[period + 1])) {
+		period = find_period(zone, utc_seconds);
+		cached_period = period;
+	}
+
+	type = &zone->types[zone->period_types[period]];
+	local->seconds = utc_seconds + (uint32_t) ((int32_t) type->offset_minutes * 60);
+	local->offset_minutes = type->offset_minutes;
+	local->abbreviation = type->abbreviation;
+}
+
+/*
+ * Description: looks a zone up by name
+ * Parameters:
+ * 		const char * IANA name
+ * Returns:
+ *   		const tz_zone_t * the zone, NULL if it was not compiled in
+ */
+
+static const tz_zone_t *find_zone(const char *name) {
+
+	for (uint8_t i = 0; i < tz_zone_count; i++) {
+		if (strcmp(tz_zones[i].name, name) == 0)
+			return &tz_zones[i];
+	}
+	return NULL;
+}
+
+/*
+ * Description: binary search for the last period starting at or before a time
+ * Parameters:
+ * 		const tz_zone_t * the zone
+ * 		uint32_t UTC seconds since 2000-01-01
+ * Returns:
+ *   		uint16_t index of the period
+ */
+
+static uint16_t find_period(const tz_zone_t *zone, uint32_t utc_seconds) {
+
+	uint16_t low = 0, high = zone->count;        // starts[low] <= utc_seconds < starts[high]
+
+	while (high - low > 1) {
+		uint16_t middle = (uint16_t) ((low + high) >> 1);
+
+		if (zone->starts[middle] <= utc_seconds)
+			low = middle;
+		else
+			high = middle;
+	}
+	return low;
+}
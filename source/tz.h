@@ -0,0 +1,66 @@
+/*******************************************************************************
+ * Copyright (C) 2023 by PRANJAL GUPTA
+ *
+ * Redistribution, modification or use of this software in source or binary
+ * forms is permitted as long as the files maintain this copyright. Users are
+ * permitted to modify this and use it to learn about the field of embedded
+ * software. PRANJAL GUPTA and the University of Colorado are not liable for
+ * any misuse of this material.
+ * ****************************************************************************/
+
+/**
+ * @file    tz.h
+ * @brief   This file has the function prototypes of the time zone lookup and the layout of the zone tables
+ *          generated into tz_zones.c by tools/tz_compile.py.
+ *
+ * @author  Pranjal Gupta
+ * @date    12/28/2023
+ *
+ */
+
+#ifndef TZ_H_
+#define TZ_H_
+
+#include "stdint.h"
+#include "stdbool.h"
+
+/* zone selected at start up, any name compiled into tz_zones.c */
+#ifndef TZ_DEFAULT_ZONE
+#define TZ_DEFAULT_ZONE "UTC"
+#endif
+
+#define TZ_ABBREVIATION_SIZE 8
+
+/* offset from UTC and abbreviation of a period, e.g. -420 "MST" */
+typedef struct {
+	int16_t offset_minutes;
+	char abbreviation[TZ_ABBREVIATION_SIZE];
+} tz_type_t;
+
+/*
+ * One compiled zone. Period i starts at starts[i] (UTC seconds since 2000-01-01, starts[0] is 0) and runs
+ * to starts[i + 1], the last period runs on forever. Its offset is types[period_types[i]].
+ */
+typedef struct {
+	const char *name;
+	const uint32_t *starts;
+	const uint8_t *period_types;
+	const tz_type_t *types;
+	uint16_t count;
+} tz_zone_t;
+
+/* local time of a UTC instant */
+typedef struct {
+	uint32_t seconds;                  // local seconds since 2000-01-01
+	int16_t offset_minutes;
+	const char *abbreviation;
+} tz_local_t;
+
+extern const tz_zone_t tz_zones[];
+extern const uint8_t tz_zone_count;
+
+bool tz_select(const char *name);
+const tz_zone_t *tz_selected(void);
+void tz_to_local(uint32_t utc_seconds, tz_local_t *local);
+
+#endif /* TZ_H_ */
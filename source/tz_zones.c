@@ -0,0 +1,375 @@
+/*******************************************************************************
+ * Copyright (C) 2023 by PRANJAL GUPTA
+ *
+ * Redistribution, modification or use of this software in source or binary
+ * forms is permitted as long as the files maintain this copyright. Users are
+ * permitted to modify this and use it to learn about the field of embedded
+ * software. PRANJAL GUPTA and the University of Colorado are not liable for
+ * any misuse of this material.
+ * ****************************************************************************/
+
+/**
+ * @file    tz_zones.c
+ * @brief   This file is generated by tools/tz_compile.py, do not edit it. It has the periods of the
+ *          compiled time zones from 2000-01-01 to the end of 2100.
+ *          Command: tools/tz_compile.py --until 2100
+ *                   UTC America/Denver America/New_York America/Los_Angeles Europe/London
+ *                   Europe/Berlin Asia/Kolkata Australia/Sydney
+ *
+ * @author  Pranjal Gupta
+ * @date    12/28/2023
+ *
+ */
+#include "tz.h"
+
+/* UTC, 1 periods */
+static const tz_type_t zone_utc_types[] = {
+	{ 0, "UTC" },
+};
+static const uint32_t zone_utc_starts[] = {
+	0U,
+};
+static const uint8_t zone_utc_period_types[] = {
+	0,
+};
+
+/* America/Denver, 203 periods */
+static const tz_type_t zone_america_denver_types[] = {
+	{ -420, "MST" },
+	{ -360, "MDT" },
+};
+static const uint32_t zone_america_denver_starts[] = {
+	0U, 7981200U, 26121600U, 39430800U, 57571200U, 71485200U,
+	89020800U, 102934800U, 120470400U, 134384400U, 152524800U, 165834000U,
+	183974400U, 197283600U, 215424000U, 226918800U, 247478400U, 258368400U,
+	278928000U, 289818000U, 310377600U, 321872400U, 342432000U, 353322000U,
+	373881600U, 384771600U, 405331200U, 416221200U, 436780800U, 447670800U,
+	468230400U, 479120400U, 499680000U, 511174800U, 531734400U, 542624400U,
+	563184000U, 574074000U, 594633600U, 605523600U, 626083200U, 636973200U,
+	657532800U, 669027600U, 689587200U, 700477200U, 721036800U, 731926800U,
+	752486400U, 763376400U, 783936000U, 794826000U, 815385600U, 826275600U,
+	846835200U, 858330000U, 878889600U, 889779600U, 910339200U, 921229200U,
+	941788800U, 952678800U, 973238400U, 984128400U, 1004688000U, 1016182800U,
+	1036742400U, 1047632400U, 1068192000U, 1079082000U, 1099641600U, 1110531600U,
+	1131091200U, 1141981200U, 1162540800U, 1173430800U, 1193990400U, 1205485200U,
+	1226044800U, 1236934800U, 1257494400U, 1268384400U, 1288944000U, 1299834000U,
+	1320393600U, 1331283600U, 1351843200U, 1362733200U, 1383292800U, 1394787600U,
+	1415347200U, 1426237200U, 1446796800U, 1457686800U, 1478246400U, 1489136400U,
+	1509696000U, 1520586000U, 1541145600U, 1552640400U, 1573200000U, 1584090000U,
+	1604649600U, 1615539600U, 1636099200U, 1646989200U, 1667548800U, 1678438800U,
+	1698998400U, 1709888400U, 1730448000U, 1741942800U, 1762502400U, 1773392400U,
+	1793952000U, 1804842000U, 1825401600U, 1836291600U, 1856851200U, 1867741200U,
+	1888300800U, 1899795600U, 1920355200U, 1931245200U, 1951804800U, 1962694800U,
+	1983254400U, 1994144400U, 2014704000U, 2025594000U, 2046153600U, 2057043600U,
+	2077603200U, 2089098000U, 2109657600U, 2120547600U, 2141107200U, 2151997200U,
+	2172556800U, 2183446800U, 2204006400U, 2214896400U, 2235456000U, 2246346000U,
+	2266905600U, 2278400400U, 2298960000U, 2309850000U, 2330409600U, 2341299600U,
+	2361859200U, 2372749200U, 2393308800U, 2404198800U, 2424758400U, 2436253200U,
+	2456812800U, 2467702800U, 2488262400U, 2499152400U, 2519712000U, 2530602000U,
+	2551161600U, 2562051600U, 2582611200U, 2593501200U, 2614060800U, 2625555600U,
+	2646115200U, 2657005200U, 2677564800U, 2688454800U, 2709014400U, 2719904400U,
+	2740464000U, 2751354000U, 2771913600U, 2783408400U, 2803968000U, 2814858000U,
+	2835417600U, 2846307600U, 2866867200U, 2877757200U, 2898316800U, 2909206800U,
+	2929766400U, 2940656400U, 2961216000U, 2972710800U, 2993270400U, 3004160400U,
+	3024720000U, 3035610000U, 3056169600U, 3067059600U, 3087619200U, 3098509200U,
+	3119068800U, 3129958800U, 3150518400U, 3162013200U, 3182572800U,
+};
+static const uint8_t zone_america_denver_period_types[] = {
+	0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1,
+	0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1,
+	0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1,
+	0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1,
+	0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1,
+	0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1,
+	0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1,
+	0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1,
+	0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0,
+};
+
+/* America/New_York, 203 periods */
+static const tz_type_t zone_america_new_york_types[] = {
+	{ -300, "EST" },
+	{ -240, "EDT" },
+};
+static const uint32_t zone_america_new_york_starts[] = {
+	0U, 7974000U, 26114400U, 39423600U, 57564000U, 71478000U,
+	89013600U, 102927600U, 120463200U, 134377200U, 152517600U, 165826800U,
+	183967200U, 197276400U, 215416800U, 226911600U, 247471200U, 258361200U,
+	278920800U, 289810800U, 310370400U, 321865200U, 342424800U, 353314800U,
+	373874400U, 384764400U, 405324000U, 416214000U, 436773600U, 447663600U,
+	468223200U, 479113200U, 499672800U, 511167600U, 531727200U, 542617200U,
+	563176800U, 574066800U, 594626400U, 605516400U, 626076000U, 636966000U,
+	657525600U, 669020400U, 689580000U, 700470000U, 721029600U, 731919600U,
+	752479200U, 763369200U, 783928800U, 794818800U, 815378400U, 826268400U,
+	846828000U, 858322800U, 878882400U, 889772400U, 910332000U, 921222000U,
+	941781600U, 952671600U, 973231200U, 984121200U, 1004680800U, 1016175600U,
+	1036735200U, 1047625200U, 1068184800U, 1079074800U, 1099634400U, 1110524400U,
+	1131084000U, 1141974000U, 1162533600U, 1173423600U, 1193983200U, 1205478000U,
+	1226037600U, 1236927600U, 1257487200U, 1268377200U, 1288936800U, 1299826800U,
+	1320386400U, 1331276400U, 1351836000U, 1362726000U, 1383285600U, 1394780400U,
+	1415340000U, 1426230000U, 1446789600U, 1457679600U, 1478239200U, 1489129200U,
+	1509688800U, 1520578800U, 1541138400U, 1552633200U, 1573192800U, 1584082800U,
+	1604642400U, 1615532400U, 1636092000U, 1646982000U, 1667541600U, 1678431600U,
+	1698991200U, 1709881200U, 1730440800U, 1741935600U, 1762495200U, 1773385200U,
+	1793944800U, 1804834800U, 1825394400U, 1836284400U, 1856844000U, 1867734000U,
+	1888293600U, 1899788400U, 1920348000U, 1931238000U, 1951797600U, 1962687600U,
+	1983247200U, 1994137200U, 2014696800U, 2025586800U, 2046146400U, 2057036400U,
+	2077596000U, 2089090800U, 2109650400U, 2120540400U, 2141100000U, 2151990000U,
+	2172549600U, 2183439600U, 2203999200U, 2214889200U, 2235448800U, 2246338800U,
+	2266898400U, 2278393200U, 2298952800U, 2309842800U, 2330402400U, 2341292400U,
+	2361852000U, 2372742000U, 2393301600U, 2404191600U, 2424751200U, 2436246000U,
+	2456805600U, 2467695600U, 2488255200U, 2499145200U, 2519704800U, 2530594800U,
+	2551154400U, 2562044400U, 2582604000U, 2593494000U, 2614053600U, 2625548400U,
+	2646108000U, 2656998000U, 2677557600U, 2688447600U, 2709007200U, 2719897200U,
+	2740456800U, 2751346800U, 2771906400U, 2783401200U, 2803960800U, 2814850800U,
+	2835410400U, 2846300400U, 2866860000U, 2877750000U, 2898309600U, 2909199600U,
+	2929759200U, 2940649200U, 2961208800U, 2972703600U, 2993263200U, 3004153200U,
+	3024712800U, 3035602800U, 3056162400U, 3067052400U, 3087612000U, 3098502000U,
+	3119061600U, 3129951600U, 3150511200U, 3162006000U, 3182565600U,
+};
+static const uint8_t zone_america_new_york_period_types[] = {
+	0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1,
+	0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1,
+	0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1,
+	0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1,
+	0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1,
+	0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1,
+	0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1,
+	0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1,
+	0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0,
+};
+
+/* America/Los_Angeles, 203 periods */
+static const tz_type_t zone_america_los_angeles_types[] = {
+	{ -480, "PST" },
+	{ -420, "PDT" },
+};
+static const uint32_t zone_america_los_angeles_starts[] = {
+	0U, 7984800U, 26125200U, 39434400U, 57574800U, 71488800U,
+	89024400U, 102938400U, 120474000U, 134388000U, 152528400U, 165837600U,
+	183978000U, 197287200U, 215427600U, 226922400U, 247482000U, 258372000U,
+	278931600U, 289821600U, 310381200U, 321876000U, 342435600U, 353325600U,
+	373885200U, 384775200U, 405334800U, 416224800U, 436784400U, 447674400U,
+	468234000U, 479124000U, 499683600U, 511178400U, 531738000U, 542628000U,
+	563187600U, 574077600U, 594637200U, 605527200U, 626086800U, 636976800U,
+	657536400U, 669031200U, 689590800U, 700480800U, 721040400U, 731930400U,
+	752490000U, 763380000U, 783939600U, 794829600U, 815389200U, 826279200U,
+	846838800U, 858333600U, 878893200U, 889783200U, 910342800U, 921232800U,
+	941792400U, 952682400U, 973242000U, 984132000U, 1004691600U, 1016186400U,
+	1036746000U, 1047636000U, 1068195600U, 1079085600U, 1099645200U, 1110535200U,
+	1131094800U, 1141984800U, 1162544400U, 1173434400U, 1193994000U, 1205488800U,
+	1226048400U, 1236938400U, 1257498000U, 1268388000U, 1288947600U, 1299837600U,
+	1320397200U, 1331287200U, 1351846800U, 1362736800U, 1383296400U, 1394791200U,
+	1415350800U, 1426240800U, 1446800400U, 1457690400U, 1478250000U, 1489140000U,
+	1509699600U, 1520589600U, 1541149200U, 1552644000U, 1573203600U, 1584093600U,
+	1604653200U, 1615543200U, 1636102800U, 1646992800U, 1667552400U, 1678442400U,
+	1699002000U, 1709892000U, 1730451600U, 1741946400U, 1762506000U, 1773396000U,
+	1793955600U, 1804845600U, 1825405200U, 1836295200U, 1856854800U, 1867744800U,
+	1888304400U, 1899799200U, 1920358800U, 1931248800U, 1951808400U, 1962698400U,
+	1983258000U, 1994148000U, 2014707600U, 2025597600U, 2046157200U, 2057047200U,
+	2077606800U, 2089101600U, 2109661200U, 2120551200U, 2141110800U, 2152000800U,
+	2172560400U, 2183450400U, 2204010000U, 2214900000U, 2235459600U, 2246349600U,
+	2266909200U, 2278404000U, 2298963600U, 2309853600U, 2330413200U, 2341303200U,
+	2361862800U, 2372752800U, 2393312400U, 2404202400U, 2424762000U, 2436256800U,
+	2456816400U, 2467706400U, 2488266000U, 2499156000U, 2519715600U, 2530605600U,
+	2551165200U, 2562055200U, 2582614800U, 2593504800U, 2614064400U, 2625559200U,
+	2646118800U, 2657008800U, 2677568400U, 2688458400U, 2709018000U, 2719908000U,
+	2740467600U, 2751357600U, 2771917200U, 2783412000U, 2803971600U, 2814861600U,
+	2835421200U, 2846311200U, 2866870800U, 2877760800U, 2898320400U, 2909210400U,
+	2929770000U, 2940660000U, 2961219600U, 2972714400U, 2993274000U, 3004164000U,
+	3024723600U, 3035613600U, 3056173200U, 3067063200U, 3087622800U, 3098512800U,
+	3119072400U, 3129962400U, 3150522000U, 3162016800U, 3182576400U,
+};
+static const uint8_t zone_america_los_angeles_period_types[] = {
+	0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1,
+	0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1,
+	0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1,
+	0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1,
+	0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1,
+	0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1,
+	0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1,
+	0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1,
+	0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0,
+};
+
+/* Europe/London, 203 periods */
+static const tz_type_t zone_europe_london_types[] = {
+	{ 0, "GMT" },
+	{ 60, "BST" },
+};
+static const uint32_t zone_europe_london_starts[] = {
+	0U, 7347600U, 26096400U, 38797200U, 57546000U, 70851600U,
+	88995600U, 102301200U, 120445200U, 133750800U, 152499600U, 165200400U,
+	183949200U, 196650000U, 215398800U, 228099600U, 246848400U, 260154000U,
+	278298000U, 291603600U, 309747600U, 323053200U, 341802000U, 354502800U,
+	373251600U, 385952400U, 404701200U, 418006800U, 436150800U, 449456400U,
+	467600400U, 480906000U, 499050000U, 512355600U, 531104400U, 543805200U,
+	562554000U, 575254800U, 594003600U, 607309200U, 625453200U, 638758800U,
+	656902800U, 670208400U, 688957200U, 701658000U, 720406800U, 733107600U,
+	751856400U, 765162000U, 783306000U, 796611600U, 814755600U, 828061200U,
+	846205200U, 859510800U, 878259600U, 890960400U, 909709200U, 922410000U,
+	941158800U, 954464400U, 972608400U, 985914000U, 1004058000U, 1017363600U,
+	1036112400U, 1048813200U, 1067562000U, 1080262800U, 1099011600U, 1111712400U,
+	1130461200U, 1143766800U, 1161910800U, 1175216400U, 1193360400U, 1206666000U,
+	1225414800U, 1238115600U, 1256864400U, 1269565200U, 1288314000U, 1301619600U,
+	1319763600U, 1333069200U, 1351213200U, 1364518800U, 1382662800U, 1395968400U,
+	1414717200U, 1427418000U, 1446166800U, 1458867600U, 1477616400U, 1490922000U,
+	1509066000U, 1522371600U, 1540515600U, 1553821200U, 1572570000U, 1585270800U,
+	1604019600U, 1616720400U, 1635469200U, 1648774800U, 1666918800U, 1680224400U,
+	1698368400U, 1711674000U, 1729818000U, 1743123600U, 1761872400U, 1774573200U,
+	1793322000U, 1806022800U, 1824771600U, 1838077200U, 1856221200U, 1869526800U,
+	1887670800U, 1900976400U, 1919725200U, 1932426000U, 1951174800U, 1963875600U,
+	1982624400U, 1995325200U, 2014074000U, 2027379600U, 2045523600U, 2058829200U,
+	2076973200U, 2090278800U, 2109027600U, 2121728400U, 2140477200U, 2153178000U,
+	2171926800U, 2185232400U, 2203376400U, 2216682000U, 2234826000U, 2248131600U,
+	2266275600U, 2279581200U, 2298330000U, 2311030800U, 2329779600U, 2342480400U,
+	2361229200U, 2374534800U, 2392678800U, 2405984400U, 2424128400U, 2437434000U,
+	2456182800U, 2468883600U, 2487632400U, 2500333200U, 2519082000U, 2532387600U,
+	2550531600U, 2563837200U, 2581981200U, 2595286800U, 2613430800U, 2626736400U,
+	2645485200U, 2658186000U, 2676934800U, 2689635600U, 2708384400U, 2721690000U,
+	2739834000U, 2753139600U, 2771283600U, 2784589200U, 2803338000U, 2816038800U,
+	2834787600U, 2847488400U, 2866237200U, 2878938000U, 2897686800U, 2910992400U,
+	2929136400U, 2942442000U, 2960586000U, 2973891600U, 2992640400U, 3005341200U,
+	3024090000U, 3036790800U, 3055539600U, 3068845200U, 3086989200U, 3100294800U,
+	3118438800U, 3131744400U, 3149888400U, 3163194000U, 3181942800U,
+};
+static const uint8_t zone_europe_london_period_types[] = {
+	0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1,
+	0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1,
+	0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1,
+	0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1,
+	0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1,
+	0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1,
+	0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1,
+	0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1,
+	0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0,
+};
+
+/* Europe/Berlin, 203 periods */
+static const tz_type_t zone_europe_berlin_types[] = {
+	{ 60, "CET" },
+	{ 120, "CEST" },
+};
+static const uint32_t zone_europe_berlin_starts[] = {
+	0U, 7347600U, 26096400U, 38797200U, 57546000U, 70851600U,
+	88995600U, 102301200U, 120445200U, 133750800U, 152499600U, 165200400U,
+	183949200U, 196650000U, 215398800U, 228099600U, 246848400U, 260154000U,
+	278298000U, 291603600U, 309747600U, 323053200U, 341802000U, 354502800U,
+	373251600U, 385952400U, 404701200U, 418006800U, 436150800U, 449456400U,
+	467600400U, 480906000U, 499050000U, 512355600U, 531104400U, 543805200U,
+	562554000U, 575254800U, 594003600U, 607309200U, 625453200U, 638758800U,
+	656902800U, 670208400U, 688957200U, 701658000U, 720406800U, 733107600U,
+	751856400U, 765162000U, 783306000U, 796611600U, 814755600U, 828061200U,
+	846205200U, 859510800U, 878259600U, 890960400U, 909709200U, 922410000U,
+	941158800U, 954464400U, 972608400U, 985914000U, 1004058000U, 1017363600U,
+	1036112400U, 1048813200U, 1067562000U, 1080262800U, 1099011600U, 1111712400U,
+	1130461200U, 1143766800U, 1161910800U, 1175216400U, 1193360400U, 1206666000U,
+	1225414800U, 1238115600U, 1256864400U, 1269565200U, 1288314000U, 1301619600U,
+	1319763600U, 1333069200U, 1351213200U, 1364518800U, 1382662800U, 1395968400U,
+	1414717200U, 1427418000U, 1446166800U, 1458867600U, 1477616400U, 1490922000U,
+	1509066000U, 1522371600U, 1540515600U, 1553821200U, 1572570000U, 1585270800U,
+	1604019600U, 1616720400U, 1635469200U, 1648774800U, 1666918800U, 1680224400U,
+	1698368400U, 1711674000U, 1729818000U, 1743123600U, 1761872400U, 1774573200U,
+	1793322000U, 1806022800U, 1824771600U, 1838077200U, 1856221200U, 1869526800U,
+	1887670800U, 1900976400U, 1919725200U, 1932426000U, 1951174800U, 1963875600U,
+	1982624400U, 1995325200U, 2014074000U, 2027379600U, 2045523600U, 2058829200U,
+	2076973200U, 2090278800U, 2109027600U, 2121728400U, 2140477200U, 2153178000U,
+	2171926800U, 2185232400U, 2203376400U, 2216682000U, 2234826000U, 2248131600U,
+	2266275600U, 2279581200U, 2298330000U, 2311030800U, 2329779600U, 2342480400U,
+	2361229200U, 2374534800U, 2392678800U, 2405984400U, 2424128400U, 2437434000U,
+	2456182800U, 2468883600U, 2487632400U, 2500333200U, 2519082000U, 2532387600U,
+	2550531600U, 2563837200U, 2581981200U, 2595286800U, 2613430800U, 2626736400U,
+	2645485200U, 2658186000U, 2676934800U, 2689635600U, 2708384400U, 2721690000U,
+	2739834000U, 2753139600U, 2771283600U, 2784589200U, 2803338000U, 2816038800U,
+	2834787600U, 2847488400U, 2866237200U, 2878938000U, 2897686800U, 2910992400U,
+	2929136400U, 2942442000U, 2960586000U, 2973891600U, 2992640400U, 3005341200U,
+	3024090000U, 3036790800U, 3055539600U, 3068845200U, 3086989200U, 3100294800U,
+	3118438800U, 3131744400U, 3149888400U, 3163194000U, 3181942800U,
+};
+static const uint8_t zone_europe_berlin_period_types[] = {
+	0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1,
+	0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1,
+	0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1,
+	0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1,
+	0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1,
+	0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1,
+	0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1,
+	0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1,
+	0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0,
+};
+
+/* Asia/Kolkata, 1 periods */
+static const tz_type_t zone_asia_kolkata_types[] = {
+	{ 330, "IST" },
+};
+static const uint32_t zone_asia_kolkata_starts[] = {
+	0U,
+};
+static const uint8_t zone_asia_kolkata_period_types[] = {
+	0,
+};
+
+/* Australia/Sydney, 203 periods */
+static const tz_type_t zone_australia_sydney_types[] = {
+	{ 660, "AEDT" },
+	{ 600, "AEST" },
+};
+static const uint32_t zone_australia_sydney_starts[] = {
+	0U, 7315200U, 20620800U, 38764800U, 57513600U, 70819200U,
+	88963200U, 102268800U, 120412800U, 133718400U, 152467200U, 165168000U,
+	183916800U, 197222400U, 215366400U, 228067200U, 246816000U, 260726400U,
+	276451200U, 292176000U, 307900800U, 323625600U, 339350400U, 355075200U,
+	370800000U, 386524800U, 402854400U, 418579200U, 434304000U, 450028800U,
+	465753600U, 481478400U, 497203200U, 512928000U, 528652800U, 544377600U,
+	560102400U, 575827200U, 592156800U, 607881600U, 623606400U, 639331200U,
+	655056000U, 670780800U, 686505600U, 702230400U, 717955200U, 733680000U,
+	749404800U, 765734400U, 781459200U, 797184000U, 812908800U, 828633600U,
+	844358400U, 860083200U, 875808000U, 891532800U, 907257600U, 922982400U,
+	939312000U, 955036800U, 970761600U, 986486400U, 1002211200U, 1017936000U,
+	1033660800U, 1049385600U, 1065110400U, 1080835200U, 1096560000U, 1112284800U,
+	1128614400U, 1144339200U, 1160064000U, 1175788800U, 1191513600U, 1207238400U,
+	1222963200U, 1238688000U, 1254412800U, 1270137600U, 1286467200U, 1302192000U,
+	1317916800U, 1333641600U, 1349366400U, 1365091200U, 1380816000U, 1396540800U,
+	1412265600U, 1427990400U, 1443715200U, 1459440000U, 1475769600U, 1491494400U,
+	1507219200U, 1522944000U, 1538668800U, 1554393600U, 1570118400U, 1585843200U,
+	1601568000U, 1617292800U, 1633017600U, 1649347200U, 1665072000U, 1680796800U,
+	1696521600U, 1712246400U, 1727971200U, 1743696000U, 1759420800U, 1775145600U,
+	1790870400U, 1806595200U, 1822924800U, 1838649600U, 1854374400U, 1870099200U,
+	1885824000U, 1901548800U, 1917273600U, 1932998400U, 1948723200U, 1964448000U,
+	1980172800U, 1995897600U, 2012227200U, 2027952000U, 2043676800U, 2059401600U,
+	2075126400U, 2090851200U, 2106576000U, 2122300800U, 2138025600U, 2153750400U,
+	2170080000U, 2185804800U, 2201529600U, 2217254400U, 2232979200U, 2248704000U,
+	2264428800U, 2280153600U, 2295878400U, 2311603200U, 2327328000U, 2343052800U,
+	2359382400U, 2375107200U, 2390832000U, 2406556800U, 2422281600U, 2438006400U,
+	2453731200U, 2469456000U, 2485180800U, 2500905600U, 2516630400U, 2532960000U,
+	2548684800U, 2564409600U, 2580134400U, 2595859200U, 2611584000U, 2627308800U,
+	2643033600U, 2658758400U, 2674483200U, 2690208000U, 2706537600U, 2722262400U,
+	2737987200U, 2753712000U, 2769436800U, 2785161600U, 2800886400U, 2816611200U,
+	2832336000U, 2848060800U, 2863785600U, 2879510400U, 2895840000U, 2911564800U,
+	2927289600U, 2943014400U, 2958739200U, 2974464000U, 2990188800U, 3005913600U,
+	3021638400U, 3037363200U, 3053692800U, 3069417600U, 3085142400U, 3100867200U,
+	3116592000U, 3132316800U, 3148041600U, 3163766400U, 3179491200U,
+};
+static const uint8_t zone_australia_sydney_period_types[] = {
+	0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1,
+	0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1,
+	0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1,
+	0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1,
+	0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1,
+	0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1,
+	0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1,
+	0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1,
+	0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0,
+};
+
+const tz_zone_t tz_zones[] = {
+	{ "UTC", zone_utc_starts, zone_utc_period_types, zone_utc_types, 1 },
+	{ "America/Denver", zone_america_denver_starts, zone_america_denver_period_types, zone_america_denver_types, 203 },
+	{ "America/New_York", zone_america_new_york_starts, zone_america_new_york_period_types, zone_america_new_york_types, 203 },
+	{ "America/Los_Angeles", zone_america_los_angeles_starts, zone_america_los_angeles_period_types, zone_america_los_angeles_types, 203 },
+	{ "Europe/London", zone_europe_london_starts, zone_europe_london_period_types, zone_europe_london_types, 203 },
+	{ "Europe/Berlin", zone_europe_berlin_starts, zone_europe_berlin_period_types, zone_europe_berlin_types, 203 },
+	{ "Asia/Kolkata", zone_asia_kolkata_starts, zone_asia_kolkata_period_types, zone_asia_kolkata_types, 1 },
+	{ "Australia/Sydney", zone_australia_sydney_starts, zone_australia_sydney_period_types, zone_australia_sydney_types, 203 },
+};
+const uint8_t tz_zone_count = sizeof(tz_zones) / sizeof(tz_zones[0]);
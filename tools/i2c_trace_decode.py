@@ -0,0 +1,90 @@
+#!/usr/bin/env python3
+# Copyright (C) 2023 by PRANJAL GUPTA
+#
+# Decodes the i2c trace dumps printed on the debug console by a build with
+# I2C_TRACE_ENABLE=1 (see source/i2c_trace.c). Reads a captured console log from
+# the file given or from stdin and prints, for every dump, the bus time used by
+# every slave since the previous dump and optionally the recorded transactions.
+#
+# usage: i2c_trace_decode.py [-v] [--cpu-hz HZ] [console.log]
+
+import argparse
+import sys
+
+STATUS = ["OK", "NACK", "ARBITRATION_LOST", "TIMEOUT", "DMA_ERROR", "BUS_BUSY"]
+DEVICES = {0x68: "DS3231", 0x3C: "SSD1306"}
+
+
+def device_name(address):
+    return DEVICES.get(address, "0x%02x" % address)
+
+
+def parse(lines):
+    """yields one dict per complete dump"""
+    dump = None
+    for line in lines:
+        fields = line.split()
+        if not fields:
+            continue
+        if fields[0] == "I2CTRACE" and fields[1] == "BEGIN":
+            dump = {"tick_ms": int(fields[2]), "dropped": int(fields[3]),
+                    "entries": [], "devices": {}}
+        elif dump is None:
+            continue
+        elif fields[0] == "I2CT":
+            dump["entries"].append({
+                "cycles": int(fields[1]), "address": int(fields[2], 16),
+                "read": fields[3] == "R", "bytes": int(fields[4]),
+                "us": int(fields[5]), "status": int(fields[6])})
+        elif fields[0] == "I2CD":
+            values = [int(v) for v in fields[2:]]
+            dump["devices"][int(fields[1], 16)] = dict(zip(
+                ["transactions", "bytes", "nacks", "errors", "busy_us", "max_us", "avg_us"],
+                values))
+        elif fields[0] == "I2CTRACE" and fields[1] == "END":
+            yield dump
+            dump = None
+
+
+def report(dumps, cpu_hz, verbose):
+    previous = None
+    for dump in dumps:
+        window_ms = dump["tick_ms"] - previous["tick_ms"] if previous else dump["tick_ms"]
+        print("dump at %.1f s, window %.1f s, %d entries lost"
+              % (dump["tick_ms"] / 1000.0, window_ms / 1000.0, dump["dropped"]))
+        print("  %-8s %8s %8s %6s %6s %8s %8s %7s"
+              % ("slave", "trans/s", "bytes/s", "nacks", "errors", "avg us", "max us", "bus %"))
+        for address, stats in sorted(dump["devices"].items()):
+            before = previous["devices"].get(address) if previous else None
+            delta = {k: stats[k] - (before[k] if before else 0) for k in stats}
+            seconds = window_ms / 1000.0 if window_ms else 1.0
+            print("  %-8s %8.1f %8.1f %6d %6d %8d %8d %6.2f%%"
+                  % (device_name(address), delta["transactions"] / seconds,
+                     delta["bytes"] / seconds, delta["nacks"], delta["errors"],
+                     stats["avg_us"], stats["max_us"],
+                     100.0 * delta["busy_us"] / (seconds * 1e6)))
+        if verbose and dump["entries"]:
+            first = dump["entries"][0]["cycles"]
+            for entry in dump["entries"]:
+                offset_us = ((entry["cycles"] - first) & 0xFFFFFFFF) * 1e6 / cpu_hz
+                status = STATUS[entry["status"]] if entry["status"] < len(STATUS) else str(entry["status"])
+                print("    +%10.0f us %-8s %s %4d bytes %6d us %s"
+                      % (offset_us, device_name(entry["address"]), "R" if entry["read"] else "W",
+                         entry["bytes"], entry["us"], status))
+        previous = dump
+
+
+def main():
+    parser = argparse.ArgumentParser(description="decode the i2c trace dumps of the debug console")
+    parser.add_argument("log", nargs="?", help="captured console output, stdin if not given")
+    parser.add_argument("-v", "--verbose", action="store_true", help="print the transactions too")
+    parser.add_argument("--cpu-hz", type=float, default=48e6, help="core clock of the timestamps")
+    args = parser.parse_args()
+
+    source = open(args.log, errors="replace") if args.log else sys.stdin
+    with source:
+        report(parse(source), args.cpu_hz, args.verbose)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,58 @@
+#!/usr/bin/env python3
+# Copyright (C) 2023 by PRANJAL GUPTA
+#
+# Reference clock of the aging offset calibration of a build with
+# RTC_CALIBRATION_ENABLE=1 (see source/rtc_calibration.c). Sends the host time as
+# "REF <unix time in ms>" on the debug console once per period and prints the
+# CAL and TRIM lines the board answers with. The host clock should be kept by
+# NTP; the board fits the RTC error over hours, so the jitter of the serial link
+# averages out.
+#
+# usage: rtc_reference.py [--period S] [--baud BAUD] PORT
+
+import argparse
+import time
+
+import serial
+
+STATUS = ["OK", "NACK", "ARBITRATION_LOST", "TIMEOUT", "DMA_ERROR", "BUS_BUSY"]
+
+
+def show(line):
+    fields = line.split()
+    if not fields:
+        return
+    if fields[0] == "CAL" and len(fields) == 4:
+        print("%s  %s samples over %.2f h, %s restarts"
+              % (time.strftime("%H:%M:%S"), fields[1], int(fields[2]) / 3600.0, fields[3]))
+    elif fields[0] == "TRIM" and len(fields) == 4:
+        status = int(fields[3])
+        print("%s  error %+.3f ppm, aging offset now %s (%s)"
+              % (time.strftime("%H:%M:%S"), int(fields[1]) / 1000.0, fields[2],
+                 STATUS[status] if status < len(STATUS) else fields[3]))
+
+
+def main():
+    parser = argparse.ArgumentParser(description="send reference time stamps to the rtc calibration")
+    parser.add_argument("port", help="serial port of the debug console, e.g. /dev/ttyACM0")
+    parser.add_argument("--baud", type=int, default=115200)
+    parser.add_argument("--period", type=float, default=60.0, help="seconds between two stamps")
+    args = parser.parse_args()
+
+    with serial.Serial(args.port, args.baud, timeout=0.1) as console:
+        pending = b""
+        next_send = time.time()
+        while True:
+            now = time.time()
+            if now >= next_send:
+                console.write(b"REF %d\r\n" % int(now * 1000))
+                console.flush()
+                next_send += args.period
+            pending += console.read(256)
+            while b"\n" in pending:
+                line, pending = pending.split(b"\n", 1)
+                show(line.decode(errors="replace"))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,126 @@
+#!/usr/bin/env python3
+# Copyright (C) 2023 by PRANJAL GUPTA
+#
+# Compiles IANA time zones into the const transition tables of source/tz_zones.c.
+# Every zone gets the UTC start of each of its periods from 2000-01-01 up to the
+# end of --until (seconds since 2000-01-01, the epoch of the DS3231 calendar) and,
+# per period, an index into a small table of the offsets and abbreviations the
+# zone uses. The firmware binary searches the starts (source/tz.c). The last
+# period of a zone runs on forever, so rerun with a later --until before then.
+#
+# usage: tz_compile.py [--until YEAR] [--output FILE] [ZONE ...]
+
+import argparse
+import datetime
+import textwrap
+import zoneinfo
+
+DEFAULT_ZONES = ["UTC", "America/Denver", "America/New_York", "America/Los_Angeles",
+                 "Europe/London", "Europe/Berlin", "Asia/Kolkata", "Australia/Sydney"]
+EPOCH = datetime.datetime(2000, 1, 1, tzinfo=datetime.timezone.utc)
+STEP = datetime.timedelta(hours=6)      # shorter than any period of the selected zones
+
+HEADER = """\
+/*******************************************************************************
+ * Copyright (C) 2023 by PRANJAL GUPTA
+ *
+ * Redistribution, modification or use of this software in source or binary
+ * forms is permitted as long as the files maintain this copyright. Users are
+ * permitted to modify this and use it to learn about the field of embedded
+ * software. PRANJAL GUPTA and the University of Colorado are not liable for
+ * any misuse of this material.
+ * ****************************************************************************/
+
+/**
+ * @file    tz_zones.c
+ * @brief   This file is generated by tools/tz_compile.py, do not edit it. It has the periods of the
+ *          compiled time zones from 2000-01-01 to the end of %d.
+ *          Command: tools/tz_compile.py --until %d
+ *                   %s
+ *
+ * @author  Pranjal Gupta
+ * @date    12/28/2023
+ *
+ */
+#include "tz.h"\
+"""
+
+
+def state(zone, instant):
+    local = instant.astimezone(zone)
+    return int(local.utcoffset().total_seconds()) // 60, local.tzname()
+
+
+def periods(name, until):
+    """UTC starts, offsets in minutes and abbreviations of the periods of a zone"""
+    zone = zoneinfo.ZoneInfo(name)
+    end = datetime.datetime(until + 1, 1, 1, tzinfo=datetime.timezone.utc)
+    result = [(0,) + state(zone, EPOCH)]
+    instant = EPOCH
+    while instant < end:
+        following = instant + STEP
+        if state(zone, following) != result[-1][1:]:
+            low, high = instant, following          # the change is in (low, high]
+            while high - low > datetime.timedelta(seconds=1):
+                middle = low + (high - low) / 2
+                if state(zone, middle) == result[-1][1:]:
+                    low = middle
+                else:
+                    high = middle
+            result.append((int((high - EPOCH).total_seconds()),) + state(zone, high))
+        instant = following
+    return result
+
+
+def identifier(name):
+    return "zone_" + "".join(c.lower() if c.isalnum() else "_" for c in name)
+
+
+def main():
+    parser = argparse.ArgumentParser(description="compile time zones into tz_zones.c")
+    parser.add_argument("zones", nargs="*", default=DEFAULT_ZONES, help="IANA zone names")
+    parser.add_argument("--until", type=int, default=2100, help="last year of the tables")
+    parser.add_argument("--output", default="source/tz_zones.c")
+    args = parser.parse_args()
+
+    zone_list = "\n *                   ".join(textwrap.wrap(" ".join(args.zones), 80))
+    lines = [HEADER % (args.until, args.until, zone_list)]
+    entries = []
+    for name in args.zones:
+        zone_periods = periods(name, args.until)
+        types = []
+        for period in zone_periods:
+            if period[1:] not in types:
+                types.append(period[1:])
+        if len(types) > 255 or len(name) >= 32:
+            raise SystemExit("%s does not fit the table format" % name)
+
+        base = identifier(name)
+        lines.append("")
+        lines.append("/* %s, %d periods */" % (name, len(zone_periods)))
+        lines.append("static const tz_type_t %s_types[] = {" % base)
+        lines.extend("\t{ %d, \"%s\" }," % (offset, abbreviation) for offset, abbreviation in types)
+        lines.append("};")
+        lines.append("static const uint32_t %s_starts[] = {" % base)
+        for i in range(0, len(zone_periods), 6):
+            lines.append("\t" + " ".join("%uU," % p[0] for p in zone_periods[i:i + 6]))
+        lines.append("};")
+        lines.append("static const uint8_t %s_period_types[] = {" % base)
+        for i in range(0, len(zone_periods), 24):
+            lines.append("\t" + " ".join("%d," % types.index(p[1:]) for p in zone_periods[i:i + 24]))
+        lines.append("};")
+        entries.append("\t{ \"%s\", %s_starts, %s_period_types, %s_types, %d },"
+                       % (name, base, base, base, len(zone_periods)))
+
+    lines.append("")
+    lines.append("const tz_zone_t tz_zones[] = {")
+    lines.extend(entries)
+    lines.append("};")
+    lines.append("const uint8_t tz_zone_count = sizeof(tz_zones) / sizeof(tz_zones[0]);")
+
+    with open(args.output, "w") as output:
+        output.write("\n".join(lines) + "\n")
+
+
+if __name__ == "__main__":
+    main()